@@ -0,0 +1,687 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <numbers>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "math3d.hpp"
+#include "affine.hpp"
+#include "bounds.hpp"
+#include "hidden_lines.hpp"
+#include "instancing.hpp"
+#include "mesh_cache.hpp"
+#include "object.hpp"
+#include "profiler.hpp"
+#include "raster.hpp"
+#include "rotation.hpp"
+#include "scene_graph.hpp"
+#include "task_scheduler.hpp"
+#include "transform_expr.hpp"
+
+using namespace math3d;
+
+namespace {
+
+std::vector<Vertex> RandomVertices(size_t n) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<Vertex> v(n);
+    for (auto& p : v) p = make_vertex(dist(rng), dist(rng), dist(rng));
+    return v;
+}
+
+Mat4 ModelView() {
+    Mat4 m { matMul(translate(0.0f, 0.0f, -3.0f), rotX(deg2rad(30.0f))) };
+    m = matMul(m, rotY(deg2rad(-40.0f)));
+    return matMul(m, scaleMat(1.0f, 1.0f, -1.0f));
+}
+
+// Closed UV sphere with roughly `targetVertices` vertices: quads between rings and
+// triangle fans at the poles, every edge shared by two faces. 8 gives 3x3.
+Object SyntheticSphere(size_t targetVertices) {
+    const int segments = std::max(3, static_cast<int>(std::lround(std::sqrt(static_cast<double>(targetVertices)))));
+    const int rings = std::max(2, static_cast<int>((std::max<size_t>(targetVertices, 3) - 2) / segments) + 1);
+
+    Object o;
+    o.original.reserve(static_cast<size_t>(segments) * (rings - 1) + 2);
+    o.original.push_back(make_vertex(0.0f, 0.5f, 0.0f));
+    for (int r = 1; r < rings; ++r) {
+        const float phi = std::numbers::pi_v<float> * r / rings;
+        for (int s = 0; s < segments; ++s) {
+            const float theta = 2.0f * std::numbers::pi_v<float> * s / segments;
+            o.original.push_back(make_vertex(0.5f * std::sin(phi) * std::cos(theta), 0.5f * std::cos(phi),
+                                             0.5f * std::sin(phi) * std::sin(theta)));
+        }
+    }
+    const int south = static_cast<int>(o.original.size());
+    o.original.push_back(make_vertex(0.0f, -0.5f, 0.0f));
+
+    const auto ring = [&](int r, int s) { return 1 + (r - 1) * segments + (s % segments); };
+    for (int s = 0; s < segments; ++s) {
+        o.edges.push_back({0, ring(1, s)});
+        o.planes.push_back({{0, ring(1, s + 1), ring(1, s)}, {}});
+    }
+    for (int r = 1; r < rings; ++r) {
+        for (int s = 0; s < segments; ++s) {
+            o.edges.push_back({ring(r, s), ring(r, s + 1)});
+            if (r + 1 < rings) {
+                o.edges.push_back({ring(r, s), ring(r + 1, s)});
+                o.planes.push_back({{ring(r, s), ring(r, s + 1), ring(r + 1, s + 1), ring(r + 1, s)}, {}});
+            }
+        }
+    }
+    for (int s = 0; s < segments; ++s) {
+        o.edges.push_back({ring(rings - 1, s), south});
+        o.planes.push_back({{south, ring(rings - 1, s), ring(rings - 1, s + 1)}, {}});
+    }
+
+    o.setView(ModelView());
+    o.setProjection(ortho(-1.0f, 1.0f, -1.0f, 1.0f, 0.1f, 100.0f));
+    return o;
+}
+
+// SyntheticSphere written as OBJ to the temp directory; the caller removes it.
+std::string SphereObjFile(size_t targetVertices) {
+    const Object o { SyntheticSphere(targetVertices) };
+    const std::string path {
+        (std::filesystem::temp_directory_path() / ("math3d_bench_" + std::to_string(targetVertices) + ".obj")).string() };
+    std::ofstream out(path, std::ios::binary);
+    for (const auto& v : o.original) out << "v " << v.x << ' ' << v.y << ' ' << v.z << '\n';
+    for (const auto& pl : o.planes) {
+        out << 'f';
+        for (int i : pl.verts) out << ' ' << i + 1;
+        out << '\n';
+    }
+    return path;
+}
+
+void MeshSizes(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(10)->Range(8, 10'000'000)->Unit(benchmark::kMicrosecond);
+}
+
+// ---- math3d micro benchmarks ----
+
+void BM_MatMul(benchmark::State& state) {
+    Mat4 a { ModelView() };
+    const Mat4 b { rotZ(0.01f) };
+    for (auto _ : state) {
+        a = matMul(a, b);
+        benchmark::DoNotOptimize(a);
+    }
+}
+
+void BM_MatMulLegacy(benchmark::State& state) {
+    std::vector<std::vector<float>> a { ModelView() };
+    const std::vector<std::vector<float>> b { rotZ(0.01f) };
+    for (auto _ : state) {
+        a = matMul(a, b);
+        benchmark::DoNotOptimize(a.data());
+    }
+}
+
+void BM_MulMatVec(benchmark::State& state) {
+    const Mat4 m { ModelView() };
+    Vertex v { make_vertex(0.1f, 0.2f, 0.3f) };
+    for (auto _ : state) {
+        v = mulMatVec(m, v);
+        benchmark::DoNotOptimize(v);
+    }
+}
+
+void BM_MulMatVecLegacy(benchmark::State& state) {
+    const std::vector<std::vector<float>> m { ModelView() };
+    Vertex v { make_vertex(0.1f, 0.2f, 0.3f) };
+    for (auto _ : state) {
+        v = mulMatVec(m, v);
+        benchmark::DoNotOptimize(v);
+    }
+}
+
+template <class Builder>
+void BM_Builder(benchmark::State& state, Builder build) {
+    float t = 0.0f;
+    for (auto _ : state) {
+        Mat4 m { build(t) };
+        benchmark::DoNotOptimize(m);
+        t += 0.001f;
+    }
+}
+
+// What Controller::rotateSliders does every frame.
+void BM_RotationComposition(benchmark::State& state) {
+    float deg = 0.0f;
+    for (auto _ : state) {
+        Mat4 m { rotX(deg2rad(deg)) };
+        m = matMul(m, rotY(deg2rad(deg * 0.5f)));
+        m = matMul(m, rotZ(deg2rad(deg * 0.25f)));
+        benchmark::DoNotOptimize(m);
+        deg += 0.1f;
+    }
+}
+
+// The model matrix main() builds every frame: T * Rx * Ry * Rz * S, as Mat4 and as
+// Affine3x4. Both include the builders.
+void BM_TrsComposition(benchmark::State& state) {
+    float t = 0.0f;
+    for (auto _ : state) {
+        Mat4 m { translate(t, 0.5f, -t) };
+        m = matMul(m, rotX(t));
+        m = matMul(m, rotY(0.5f * t));
+        m = matMul(m, rotZ(0.25f * t));
+        m = matMul(m, scaleMat(1.0f, 2.0f, 0.5f));
+        benchmark::DoNotOptimize(m);
+        t += 0.001f;
+    }
+}
+
+void BM_TrsCompositionAffine(benchmark::State& state) {
+    float t = 0.0f;
+    for (auto _ : state) {
+        Affine3x4 m { Affine3x4::translate(t, 0.5f, -t) };
+        m = matMul(m, Affine3x4::rotX(t));
+        m = matMul(m, Affine3x4::rotY(0.5f * t));
+        m = matMul(m, Affine3x4::rotZ(0.25f * t));
+        m = matMul(m, Affine3x4::scale(1.0f, 2.0f, 0.5f));
+        benchmark::DoNotOptimize(m);
+        t += 0.001f;
+    }
+}
+
+// The same chain as one transform expression, evaluated without intermediate matrices.
+void BM_TrsExpression(benchmark::State& state) {
+    float t = 0.0f;
+    for (auto _ : state) {
+        const Affine3x4 m { (Translation{t, 0.5f, -t} * RotationX(t) * RotationY(0.5f * t) * RotationZ(0.25f * t) *
+                             Scaling{1.0f, 2.0f, 0.5f}).affine() };
+        benchmark::DoNotOptimize(m);
+        t += 0.001f;
+    }
+}
+
+// Controller::rotateSliders as an expression.
+void BM_RotationExpression(benchmark::State& state) {
+    float deg = 0.0f;
+    for (auto _ : state) {
+        const Affine3x4 m { (RotationX(deg2rad(deg)) * RotationY(deg2rad(deg * 0.5f)) * RotationZ(deg2rad(deg * 0.25f))).affine() };
+        benchmark::DoNotOptimize(m);
+        deg += 0.1f;
+    }
+}
+
+// Controller::rotateSliders with the closed-form Euler builder.
+void BM_RotationEuler(benchmark::State& state) {
+    float deg = 0.0f;
+    for (auto _ : state) {
+        const Affine3x4 m { eulerXYZ(deg2rad(deg), deg2rad(deg * 0.5f), deg2rad(deg * 0.25f)) };
+        benchmark::DoNotOptimize(m);
+        deg += 0.1f;
+    }
+}
+
+// Rotation matrices for a batch of objects: the per-object matrix chain against the
+// batch Euler builder (sines and cosines four at a time).
+void BM_RotationBatch(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    std::vector<float> x(n), y(n), z(n);
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = 0.001f * i;
+        y[i] = -0.002f * i;
+        z[i] = 0.5f + 0.003f * i;
+    }
+    std::vector<Affine3x4> out(n);
+    for (auto _ : state) {
+        if (state.range(1)) {
+            eulerXYZ(x, y, z, out);
+        } else {
+            for (size_t i = 0; i < n; ++i)
+                out[i] = matMul(matMul(Affine3x4::rotX(x[i]), Affine3x4::rotY(y[i])), Affine3x4::rotZ(z[i]));
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(n));
+}
+
+void BM_SinCos(benchmark::State& state) {
+    const size_t n = 4096;
+    std::vector<float> a(n), s(n), c(n);
+    for (size_t i = 0; i < n; ++i) a[i] = -10.0f + 20.0f * i / n;
+    for (auto _ : state) {
+        if (state.range(0)) {
+            sinCos(a, s, c);
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                s[i] = static_cast<float>(std::sin(a[i]));
+                c[i] = static_cast<float>(std::cos(a[i]));
+            }
+        }
+        benchmark::DoNotOptimize(s.data());
+        benchmark::DoNotOptimize(c.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(n));
+}
+
+void BM_MatMulAffine(benchmark::State& state) {
+    Affine3x4 a { Affine3x4::fromMat4(ModelView()) };
+    const Affine3x4 b { Affine3x4::rotZ(0.01f) };
+    for (auto _ : state) {
+        a = matMul(a, b);
+        benchmark::DoNotOptimize(a);
+    }
+}
+
+// ---- batch transform kernels, AoS vs SoA ----
+
+// Both layouts run the same world + projected passes that Object::recompute does.
+void BM_TransformAoS(benchmark::State& state) {
+    const auto path { static_cast<SimdPath>(state.range(1)) };
+    if (!simdPathSupported(path)) { state.SkipWithError("simd path not supported"); return; }
+
+    const auto original { RandomVertices(state.range(0)) };
+    std::vector<Vertex> world(original.size()), projected(original.size());
+    const Mat4 vm { ModelView() };
+    const Mat4 proj { ortho(-1.0f, 1.0f, -1.0f, 1.0f, 0.1f, 100.0f) };
+
+    for (auto _ : state) {
+        transformVertices(vm, original, world, path);
+        transformVertices(proj, world, projected, path);
+        benchmark::DoNotOptimize(projected.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetLabel(simdPathName(path));
+}
+
+void BM_TransformSoA(benchmark::State& state) {
+    const auto path { static_cast<SimdPath>(state.range(1)) };
+    if (!simdPathSupported(path)) { state.SkipWithError("simd path not supported"); return; }
+
+    VertexSoA original, world, projected;
+    original.assign(RandomVertices(state.range(0)));
+    const Mat4 vm { ModelView() };
+    const Mat4 proj { ortho(-1.0f, 1.0f, -1.0f, 1.0f, 0.1f, 100.0f) };
+
+    for (auto _ : state) {
+        transformVertices(vm, original, world, path);
+        transformVertices(proj, world, projected, path);
+        benchmark::DoNotOptimize(projected.x.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetLabel(simdPathName(path));
+}
+
+void LayoutArgs(benchmark::internal::Benchmark* b) {
+    for (SimdPath p : {SimdPath::Scalar, SimdPath::SSE2, SimdPath::AVX2, SimdPath::NEON})
+        b->Args({1 << 20, static_cast<long>(p)});
+    b->Unit(benchmark::kMicrosecond);
+}
+
+// ---- Object pipeline macro benchmarks ----
+
+// One animated frame: new model matrix, projection pass, facing and visible edges.
+void BM_ObjectRecompute(benchmark::State& state) {
+    Object o { SyntheticSphere(state.range(0)) };
+    o.update();
+    float angle = 0.0f;
+    for (auto _ : state) {
+        angle += 0.01f;
+        o.setModel(rotY(angle));
+        o.update();
+        benchmark::DoNotOptimize(o.projected.data());
+    }
+    state.SetItemsProcessed(state.iterations() * o.original.size());
+    state.counters["vertices"] = static_cast<double>(o.original.size());
+    state.counters["faces"] = static_cast<double>(o.planes.size());
+}
+
+void BM_ObjectRecomputeWire(benchmark::State& state) {
+    Object o { SyntheticSphere(state.range(0)) };
+    o.useRoberts = false;
+    o.update();
+    float angle = 0.0f;
+    for (auto _ : state) {
+        angle += 0.01f;
+        o.setModel(rotY(angle));
+        o.update();
+        benchmark::DoNotOptimize(o.projected.data());
+    }
+    state.SetItemsProcessed(state.iterations() * o.original.size());
+    state.counters["vertices"] = static_cast<double>(o.original.size());
+}
+
+void BM_ObjectFacing(benchmark::State& state) {
+    Object o { SyntheticSphere(state.range(0)) };
+    o.update();
+    for (auto _ : state) {
+        o.updateFaceFacingEye();
+        benchmark::DoNotOptimize(o.visibleEdges.data());
+    }
+    state.SetItemsProcessed(state.iterations() * o.planes.size());
+    state.counters["faces"] = static_cast<double>(o.planes.size());
+}
+
+void BM_ObjectTopology(benchmark::State& state) {
+    Object o { SyntheticSphere(state.range(0)) };
+    for (auto _ : state) {
+        o.buildTopology();
+        benchmark::DoNotOptimize(o.topology.edgeCount());
+    }
+    state.SetItemsProcessed(state.iterations() * o.edges.size());
+    state.counters["edges"] = static_cast<double>(o.edges.size());
+}
+
+// Nothing changed: must not touch a single vertex regardless of mesh size.
+void BM_ObjectIdleUpdate(benchmark::State& state) {
+    Object o { SyntheticSphere(state.range(0)) };
+    o.update();
+    for (auto _ : state) {
+        o.setModel(Mat4::identity());
+        benchmark::DoNotOptimize(o.update());
+    }
+}
+
+// ---- scaling with the work-stealing pool: range(0) vertices, range(1) threads ----
+
+void BM_ObjectRecomputeThreads(benchmark::State& state) {
+    TaskScheduler pool(static_cast<unsigned>(state.range(1)));
+    Object o { SyntheticSphere(state.range(0)) };
+    o.scheduler = &pool;
+    o.update();
+    float angle = 0.0f;
+    for (auto _ : state) {
+        angle += 0.01f;
+        o.setModel(rotY(angle));
+        o.update();
+        benchmark::DoNotOptimize(o.projected.data());
+    }
+    state.SetItemsProcessed(state.iterations() * o.original.size());
+    state.counters["threads"] = static_cast<double>(pool.threadCount());
+}
+
+void BM_ObjectCenterThreads(benchmark::State& state) {
+    TaskScheduler pool(static_cast<unsigned>(state.range(1)));
+    Object o { SyntheticSphere(state.range(0)) };
+    o.scheduler = &pool;
+    o.requestWorld();
+    for (auto _ : state) {
+        o.computeCenter();
+        benchmark::DoNotOptimize(o.center);
+    }
+    state.SetItemsProcessed(state.iterations() * o.original.size());
+    state.counters["threads"] = static_cast<double>(pool.threadCount());
+}
+
+// 1, 2, 4, ... up to the hardware thread count, on the cube-sized mesh (must not
+// get slower than serial) and on a large one.
+void ThreadArgs(benchmark::internal::Benchmark* b) {
+    const long hw = std::max(1u, std::thread::hardware_concurrency());
+    for (long vertices : { 8L, 1'000'000L }) {
+        for (long t = 1; t < hw; t *= 2) b->Args({vertices, t});
+        b->Args({vertices, hw});
+    }
+    b->Unit(benchmark::kMicrosecond)->UseRealTime();
+}
+
+// ---- software rasterizer ----
+
+// Full-screen 1080p render of a Roberts sphere; items are triangles set up and binned.
+void BM_Rasterize(benchmark::State& state) {
+    TaskScheduler pool(static_cast<unsigned>(state.range(1)));
+    Object o { SyntheticSphere(state.range(0)) };
+    o.setView(ModelView());
+    o.setProjection(ortho(-1.0f, 1.0f, -1.0f, 1.0f, 0.1f, 100.0f));
+    o.update();
+    RasterOptions opt;
+    opt.width = 1920;
+    opt.height = 1080;
+    SoftwareRasterizer r(opt);
+    for (auto _ : state) {
+        r.clear();
+        r.draw(o, &pool);
+        benchmark::DoNotOptimize(r.color().data());
+    }
+    state.SetItemsProcessed(state.iterations() * r.stats().triangles);
+    state.counters["threads"] = static_cast<double>(pool.threadCount());
+}
+
+// ---- scene graph ----
+
+// 8-ary hierarchy of range(0) nodes; every frame range(1) per mille of them get a new
+// local transform. Items are world matrices recomputed.
+void BM_SceneGraphUpdate(benchmark::State& state) {
+    const auto n = static_cast<SceneGraph::NodeId>(state.range(0));
+    SceneGraph g;
+    g.addNode();
+    for (SceneGraph::NodeId i = 1; i < n; ++i) g.addNode((i - 1) / 8, matMul(translate(0.1f, 0, 0), rotY(0.01f * i)));
+    g.update();
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<SceneGraph::NodeId> pick(0, n - 1);
+    std::vector<SceneGraph::NodeId> changed(static_cast<size_t>(n) * state.range(1) / 1000);
+    float angle = 0.0f;
+    size_t recomputed = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (auto& c : changed) c = pick(rng);
+        state.ResumeTiming();
+        angle += 0.01f;
+        for (auto c : changed) g.setLocal(c, rotY(angle));
+        recomputed += g.update();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(recomputed));
+    state.counters["recomputed/frame"] = static_cast<double>(recomputed) / state.iterations();
+}
+
+// ---- instancing ----
+
+Object UnitCube() {
+    Object o;
+    for (int i = 0; i < 8; ++i)
+        o.original.push_back(make_vertex(((i + 1) & 2) ? 0.2f : -0.2f, (i & 2) ? 0.2f : -0.2f, i < 4 ? -0.2f : 0.2f));
+    o.edges = {{0,1},{1,2},{2,3},{3,0},{4,5},{5,6},{6,7},{7,4},{0,4},{1,5},{2,6},{3,7}};
+    o.planes = {{{0,1,2,3},{}}, {{4,7,6,5},{}}, {{0,4,5,1},{}}, {{2,6,7,3},{}}, {{0,3,7,4},{}}, {{1,5,6,2},{}}};
+    return o;
+}
+
+Mat4 GridModel(size_t i, size_t n, float angle) {
+    const size_t side = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(n))));
+    const float step = 2.4f / side;
+    return matMul(translate(-1.2f + step * (i % side), -1.2f + step * (i / side), 0.0f),
+                  matMul(rotY(angle + 0.001f * i), scaleMat(step, step, step)));
+}
+
+// A grid of cubes with a moving camera: every frame redoes all instances. Items are cubes.
+void BM_InstancedCubes(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Object mesh { UnitCube() };
+    InstancedObject batch(mesh);
+    for (size_t i = 0; i < n; ++i) batch.add(GridModel(i, n, 0.0f));
+    batch.setProjection(ortho(-1.0f, 1.0f, -1.0f, 1.0f, 0.1f, 100.0f));
+    float angle = 0.0f;
+    for (auto _ : state) {
+        angle += 0.01f;
+        batch.setView(matMul(translate(0.0f, 0.0f, -3.0f), rotX(angle)));
+        batch.update();
+        benchmark::DoNotOptimize(batch.visible().data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.counters["culled"] = static_cast<double>(batch.cullStats().culled);
+}
+
+// The same scene as one full Object per cube, for comparison.
+void BM_SeparateCubes(benchmark::State& state) {
+    const size_t n = state.range(0);
+    std::vector<Object> cubes(n, UnitCube());
+    for (size_t i = 0; i < n; ++i) {
+        cubes[i].setModel(GridModel(i, n, 0.0f));
+        cubes[i].setProjection(ortho(-1.0f, 1.0f, -1.0f, 1.0f, 0.1f, 100.0f));
+    }
+    float angle = 0.0f;
+    for (auto _ : state) {
+        angle += 0.01f;
+        for (auto& o : cubes) {
+            o.setView(matMul(translate(0.0f, 0.0f, -3.0f), rotX(angle)));
+            o.update();
+        }
+        benchmark::DoNotOptimize(cubes.back().facing.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// 64 spheres on a grid four times wider than the view volume, so most of them are
+// outside it; arg 1 enables frustum culling. Items are objects.
+void BM_FrustumCulling(benchmark::State& state) {
+    std::vector<Object> spheres(64, SyntheticSphere(10'000));
+    for (size_t i = 0; i < spheres.size(); ++i) {
+        spheres[i].frustumCulling = state.range(0) != 0;
+        spheres[i].setModel(translate(-3.5f + (i % 8), -3.5f + static_cast<float>(i / 8), 0.0f));
+        spheres[i].setProjection(ortho(-1.0f, 1.0f, -1.0f, 1.0f, 0.1f, 100.0f));
+    }
+    float angle = 0.0f;
+    CullStats cull;
+    for (auto _ : state) {
+        angle += 0.01f;
+        cull = {};
+        for (auto& o : spheres) {
+            o.setView(matMul(translate(0.0f, 0.0f, -5.0f), rotZ(angle)));
+            o.update();
+            cull.add(o.culled);
+        }
+        benchmark::DoNotOptimize(spheres.back().projected.data());
+    }
+    state.SetItemsProcessed(state.iterations() * spheres.size());
+    state.counters["culled"] = static_cast<double>(cull.culled);
+}
+
+// Cost of one ProfileScope; arg 1 enables the profiler.
+void BM_ProfileScope(benchmark::State& state) {
+    Profiler profiler;
+    profiler.setEnabled(state.range(0) != 0);
+    for (auto _ : state) {
+        ProfileScope scope("bench", profiler);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// ---- hidden-line removal ----
+
+// Random boxes of constant screen density, so every edge has about the same number
+// of occluders nearby; time per edge should stay flat as the scene grows.
+void BM_HiddenLines(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const float extent = 0.05f * std::sqrt(static_cast<float>(n));
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> pos(-extent, extent), depth(-1.0f, 1.0f);
+    std::vector<Object> boxes(n);
+    std::vector<const Object*> scene;
+    const Mat4 projection { ortho(-extent, extent, -extent, extent, -10.0f, 10.0f) };
+    for (auto& o : boxes) {
+        const float cx = pos(rng), cy = pos(rng), cz = depth(rng);
+        for (int i = 0; i < 8; ++i)
+            o.original.push_back(make_vertex(cx + ((i + 1) & 2 ? 0.05f : -0.05f), cy + (i & 2 ? 0.05f : -0.05f),
+                                             cz + (i < 4 ? -0.05f : 0.05f)));
+        o.edges = {{0,1},{1,2},{2,3},{3,0},{4,5},{5,6},{6,7},{7,4},{0,4},{1,5},{2,6},{3,7}};
+        o.planes = {{{0,1,2,3},{}}, {{4,7,6,5},{}}, {{0,4,5,1},{}}, {{2,6,7,3},{}}, {{0,3,7,4},{}}, {{1,5,6,2},{}}};
+        o.setView(matMul(rotX(deg2rad(30.0f)), rotY(deg2rad(-40.0f))));
+        o.setProjection(projection);
+        o.update();
+        scene.push_back(&o);
+    }
+    HiddenLineRemover hlr;
+    for (auto _ : state) benchmark::DoNotOptimize(hlr.compute(scene).data());
+    state.SetItemsProcessed(state.iterations() * hlr.stats().edges);
+    state.counters["candidates/edge"] = static_cast<double>(hlr.stats().candidates) / hlr.stats().edges;
+}
+
+// ---- mesh loading: what stands between launch and the first frame ----
+
+// Parse plus adjacency, i.e. everything a cold start has to derive.
+void BM_LoadObjCold(benchmark::State& state) {
+    const std::string path { SphereObjFile(state.range(0)) };
+    Object o;
+    for (auto _ : state) {
+        loadObj(path, o);
+        o.buildTopology();
+    }
+    state.SetItemsProcessed(state.iterations() * o.original.size());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(std::filesystem::file_size(path)));
+    std::remove(path.c_str());
+}
+
+void BM_LoadObjCached(benchmark::State& state) {
+    const std::string path { SphereObjFile(state.range(0)) };
+    Object o;
+    loadMeshCached(path, o);
+    for (auto _ : state) {
+        if (!loadMeshCached(path, o).fromCache) state.SkipWithError("cache miss");
+    }
+    state.SetItemsProcessed(state.iterations() * o.original.size());
+    std::remove(path.c_str());
+    std::remove((path + ".m3dc").c_str());
+}
+
+void LoadSizes(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(10)->Range(1'000, 1'000'000)->Unit(benchmark::kMillisecond);
+}
+
+}
+
+BENCHMARK(BM_MatMul);
+BENCHMARK(BM_MatMulLegacy);
+BENCHMARK(BM_MulMatVec);
+BENCHMARK(BM_MulMatVecLegacy);
+BENCHMARK_CAPTURE(BM_Builder, translate, [](float t) { return translate(t, -t, 2.0f * t); });
+BENCHMARK_CAPTURE(BM_Builder, scaleMat, [](float t) { return scaleMat(1.0f + t, 2.0f, 0.5f); });
+BENCHMARK_CAPTURE(BM_Builder, rotX, [](float t) { return rotX(t); });
+BENCHMARK_CAPTURE(BM_Builder, rotY, [](float t) { return rotY(t); });
+BENCHMARK_CAPTURE(BM_Builder, rotZ, [](float t) { return rotZ(t); });
+BENCHMARK_CAPTURE(BM_Builder, reflect, [](float t) { return reflect(t > 0.5f, true, false); });
+BENCHMARK_CAPTURE(BM_Builder, ortho, [](float t) { return ortho(-1.0f - t, 1.0f, -1.0f, 1.0f, 0.1f, 100.0f); });
+BENCHMARK(BM_RotationComposition);
+BENCHMARK(BM_TrsComposition);
+BENCHMARK(BM_TrsCompositionAffine);
+BENCHMARK(BM_TrsExpression);
+BENCHMARK(BM_RotationExpression);
+BENCHMARK(BM_RotationEuler);
+BENCHMARK(BM_RotationBatch)->Args({10'000, 0})->Args({10'000, 1})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SinCos)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_MatMulAffine);
+
+BENCHMARK(BM_TransformAoS)->Apply(LayoutArgs);
+BENCHMARK(BM_TransformSoA)->Apply(LayoutArgs);
+
+BENCHMARK(BM_ObjectRecompute)->Apply(MeshSizes);
+BENCHMARK(BM_ObjectRecomputeWire)->Apply(MeshSizes);
+BENCHMARK(BM_ObjectFacing)->Apply(MeshSizes);
+BENCHMARK(BM_ObjectTopology)->Apply(MeshSizes);
+BENCHMARK(BM_ObjectIdleUpdate)->Apply(MeshSizes);
+
+BENCHMARK(BM_ObjectRecomputeThreads)->Apply(ThreadArgs);
+BENCHMARK(BM_ObjectCenterThreads)->Apply(ThreadArgs);
+
+BENCHMARK(BM_Rasterize)->Apply(ThreadArgs);
+
+// 1% and all of 100k nodes changed per frame.
+BENCHMARK(BM_SceneGraphUpdate)->Args({100'000, 10})->Args({100'000, 1000})->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(BM_InstancedCubes)->Arg(1'000)->Arg(100'000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SeparateCubes)->Arg(1'000)->Arg(100'000)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(BM_FrustumCulling)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_ProfileScope)->Arg(0)->Arg(1);
+
+BENCHMARK(BM_HiddenLines)->RangeMultiplier(10)->Range(100, 100'000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_LoadObjCold)->Apply(LoadSizes);
+BENCHMARK(BM_LoadObjCached)->Apply(LoadSizes);
+
+BENCHMARK_MAIN();
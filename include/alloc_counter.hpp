@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace math3d {
+
+// Counts of global operator new calls, on all threads. They are fed by a hook that
+// replaces operator new/delete (src/alloc_hook.cpp). The hook is linked into the unit
+// tests and into Debug builds of the app; anywhere else the counts stay at zero and
+// heapCountingEnabled() is false.
+struct HeapStats {
+    std::uint64_t allocations{}, bytes{};
+};
+
+bool heapCountingEnabled();
+HeapStats heapStats();  // since the process started
+
+// Heap allocations made while the scope is alive.
+class HeapAllocationScope {
+public:
+    HeapAllocationScope() : start(heapStats()) {}
+    std::uint64_t allocations() const { return heapStats().allocations - start.allocations; }
+    std::uint64_t bytes() const { return heapStats().bytes - start.bytes; }
+
+private:
+    HeapStats start;
+};
+
+namespace detail {
+
+void enableHeapCounting();
+void countHeapAllocation(std::size_t bytes);
+
+}
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+#include "math3d.hpp"
+
+namespace math3d {
+
+struct Aabb {
+    Vertex min{}, max{};
+};
+
+struct BoundingSphere {
+    Vertex center{};
+    float radius{};
+};
+
+// Object-space bounding volumes of a vertex set: the box, and a sphere around the
+// box center through the farthest vertex (not minimal, but never smaller than the
+// mesh). `empty` is set when there are no vertices; nothing is culled then.
+struct Bounds {
+    Aabb box;
+    BoundingSphere sphere;
+    bool empty{true};
+
+    static Bounds of(std::span<const Vertex> vertices);
+};
+
+// The six clip planes of a projection (Gribb-Hartmann), expressed in whatever space
+// `m` maps from: pass projection * view * model and the planes are in object space,
+// so object-space bounds are tested without transforming them. Points with
+// a*x + b*y + c*z + d >= 0 for every plane are inside; planes are normalized so the
+// sphere test compares distances in that space.
+class Frustum {
+public:
+    explicit Frustum(const Mat4& m);
+
+    // Conservative: true only when the volume is entirely outside one plane.
+    bool outside(const BoundingSphere& s) const;
+    bool outside(const Aabb& box) const;
+    // Sphere first (cheap), then the box, which is tighter for elongated meshes.
+    bool outside(const Bounds& b) const { return !b.empty && (outside(b.sphere) || outside(b.box)); }
+
+private:
+    float planes[6][4];
+};
+
+// Per-frame culling counters. Every Object or instance considered counts as tested,
+// and as either culled or drawn.
+struct CullStats {
+    size_t tested{}, culled{}, drawn{};
+
+    void add(bool wasCulled) {
+        ++tested;
+        ++(wasCulled ? culled : drawn);
+    }
+    CullStats& operator+=(const CullStats& o) {
+        tested += o.tested;
+        culled += o.culled;
+        drawn += o.drawn;
+        return *this;
+    }
+};
+
+}
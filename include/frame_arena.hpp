@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+namespace math3d {
+
+// Bump allocator for data that only lives until the end of the frame: allocation
+// moves a pointer, deallocation does nothing, and reset() drops everything at once.
+// As a std::pmr::memory_resource it backs pmr containers and strings directly:
+//     std::pmr::vector<Vertex> scratch(&arena);
+//
+// An allocation that does not fit takes a new block from `upstream`. reset() then
+// replaces the blocks with a single one big enough for the whole frame, so once the
+// frame's shape settles, steady-state frames make no upstream (heap) calls at all.
+// Not thread-safe; use one arena per thread.
+class FrameArena : public std::pmr::memory_resource {
+public:
+    explicit FrameArena(size_t capacity = size_t{1} << 20,
+                        std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+    ~FrameArena() override;
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Invalidates everything allocated since the previous reset().
+    void reset();
+
+    size_t used() const { return usedBytes; }          // requested since the last reset()
+    size_t capacity() const;                           // of the current blocks
+    size_t highWater() const { return peakBytes; }     // largest frame so far, with padding
+    std::uint64_t upstreamAllocations() const { return upstreamCalls; }
+
+private:
+    struct Block {
+        Block* next;
+        size_t size, used;  // in bytes, header included
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    void addBlock(size_t size);
+    void freeBlocks();
+
+    std::pmr::memory_resource* upstream;
+    Block* head{};
+    size_t blockSize;
+    size_t usedBytes{}, peakBytes{};
+    std::uint64_t upstreamCalls{};
+};
+
+}
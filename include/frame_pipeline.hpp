@@ -0,0 +1,152 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "object.hpp"
+
+namespace math3d {
+
+// Lock-free single-producer/single-consumer handoff of the latest value. The
+// producer fills back() and publish()es it; the consumer calls update() to take the
+// newest published slot as front(). Neither side ever waits, and a value that is
+// published twice before the consumer looks is simply replaced.
+template <typename T>
+class TripleBuffer {
+public:
+    T& back() { return slots[backIndex]; }
+    void publish() { backIndex = middle.exchange(backIndex | kFresh, std::memory_order_acq_rel) & kIndexMask; }
+
+    // True when a newer value than the current front() was taken.
+    bool update() {
+        if (!(middle.load(std::memory_order_relaxed) & kFresh)) return false;
+        frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+    const T& front() const { return slots[frontIndex]; }
+
+private:
+    static constexpr unsigned kFresh = 4, kIndexMask = 3;
+
+    std::array<T, 3> slots{};
+    unsigned backIndex{0}, frontIndex{1};
+    std::atomic<unsigned> middle{2};
+};
+
+using FrameClock = std::chrono::steady_clock;
+
+// What the render thread needs from one Object::update(), apart from the static mesh
+// (original, edges, planes), which stays in the Object. Member names follow Object so
+// draw code can take either.
+struct FrameSnapshot {
+    std::vector<Vertex> projected;
+    std::vector<std::uint64_t> facing;
+    std::vector<float> faceDots;
+    std::vector<int> visibleEdges;
+    Mat4 projViewModel{Mat4::identity()};
+    unsigned long long meshVersion{}, facingVersion{};
+    bool useRoberts{true}, cpuProjection{true};
+    bool culled{false};  // nothing to draw; the buffers above are not refreshed
+
+    unsigned long long frame{};
+    FrameClock::time_point submitted, completed;
+
+    // Copies into the existing buffers, so steady-state frames do not allocate.
+    void capture(const Object& o);
+
+    Vertex projectedAt(size_t i) const { return projected[i]; }
+    bool isFacing(size_t f) const { return (facing[f >> 6] >> (f & 63)) & 1; }
+};
+
+// Per-frame settings the UI hands to the worker.
+struct FrameInputs {
+    Mat4 model{Mat4::identity()}, view{Mat4::identity()}, projection{Mat4::identity()};
+    bool useRoberts{true}, cpuProjection{true};
+    VertexLayout layout{VertexLayout::AoS};
+
+    unsigned long long frame{};
+    FrameClock::time_point submitted;
+};
+
+// Rolling input-to-display latency and display rate over the last `window` frames.
+// "Displayed" means the frame's draw calls have been issued, just before the UI and
+// the buffer swap; sequential and pipelined frames are both measured there, so their
+// latencies compare like for like.
+class FrameMetrics {
+public:
+    explicit FrameMetrics(size_t window = 120) : latencies(std::max<size_t>(window, 1)), displays(latencies.size()) {}
+
+    // One displayed frame whose inputs were taken at `submitted`.
+    void record(FrameClock::time_point submitted, FrameClock::time_point displayed);
+
+    double meanLatencyMs() const;
+    double maxLatencyMs() const;
+    double framesPerSecond() const;
+    unsigned long long frames() const { return count; }
+
+private:
+    size_t filled() const { return static_cast<size_t>(std::min<unsigned long long>(count, latencies.size())); }
+
+    // Ring buffers indexed by count % window, so recording never allocates.
+    std::vector<double> latencies;
+    std::vector<FrameClock::time_point> displays;
+    unsigned long long count{};
+};
+
+// Optional pipelined mode: a worker thread runs Object::update() for frame N+1 while
+// the render thread draws frame N. Inputs go to the worker and snapshots come back
+// through TripleBuffers, so neither thread blocks on the other. This buys throughput
+// at the cost of one frame of latency, which FrameMetrics makes visible.
+//
+// While a pipeline exists the worker owns the Object's per-frame state; the render
+// thread may only read the static mesh (original, edges, planes).
+class FramePipeline {
+public:
+    explicit FramePipeline(Object& o);
+    ~FramePipeline();
+    FramePipeline(const FramePipeline&) = delete;
+    FramePipeline& operator=(const FramePipeline&) = delete;
+
+    // Render thread. Never blocks; inputs the worker has not picked up yet are replaced.
+    void submit(FrameInputs in);
+
+    // Render thread. The newest finished frame, or the previous one when no new frame
+    // is ready; null until the first frame is done.
+    const FrameSnapshot* acquire();
+
+    // Render thread, once the frame acquire() returned has been drawn. Records its
+    // latency if it was a new frame; a frame shown again is not counted twice.
+    void frameDrawn();
+
+    // Blocks until the worker has finished the last submitted frame.
+    void flush();
+
+    const FrameMetrics& metrics() const { return frameMetrics; }
+    unsigned long long framesSubmitted() const { return submitted; }
+    unsigned long long framesProduced() const { return producedCount.load(std::memory_order_relaxed); }
+    // Submitted frames that were never displayed: their inputs or their snapshot were
+    // replaced by newer ones before the worker or the render thread got to them.
+    unsigned long long framesDropped() const { return dropped; }
+
+private:
+    void workerMain();
+
+    Object& object;
+    TripleBuffer<FrameInputs> inputs;
+    TripleBuffer<FrameSnapshot> frames;
+    std::atomic<unsigned long long> inputSequence{0};
+    std::atomic<unsigned long long> completedFrame{0}, producedCount{0};
+    std::atomic<bool> stopping{false};
+    unsigned long long submitted{}, lastDisplayed{}, dropped{};
+    bool haveFrame{false}, newFrame{false};
+    FrameMetrics frameMetrics;
+    std::thread worker;
+};
+
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "object.hpp"
+
+namespace math3d {
+
+class TaskScheduler;
+
+// A visible piece of an edge, in NDC (x right, y up, z into the screen).
+struct VisibleSegment {
+    float x0, y0, z0, x1, y1, z1;
+    std::uint32_t body;  // index into the span passed to compute()
+    std::uint32_t edge;  // index into that body's edges
+};
+
+// Roberts hidden-line removal over several convex bodies. Every candidate edge is
+// clipped against the face planes of every other closed body in front of it, and
+// the pieces no body covers are kept.
+//
+// Candidate edges are a Roberts body's visibleEdges (its own back faces are already
+// culled) and every edge of a wireframe body. Only Roberts bodies with faces occlude.
+// Each is assumed convex, as computeFaceNormals does. Work happens after projection,
+// where the line of sight is +z for perspective and orthographic views alike, so
+// bodies need cpuProjection and an up-to-date update(). Vertices with w <= 0 are
+// not clipped against the near plane: such edges are dropped and such bodies do not
+// occlude.
+//
+// Occluders are binned into a uniform screen grid by their NDC bounds. An edge is
+// only clipped against bodies that share a cell with it, overlap its bounds and
+// reach in front of its far end. Scenes of many small bodies therefore cost close to
+// linear time rather than edges x bodies.
+class HiddenLineRemover {
+public:
+    struct Stats {
+        size_t bodies{};      // bodies with at least one occluding face
+        size_t edges{};       // candidate edges
+        size_t candidates{};  // edge/body pairs left after the bounds tests
+        size_t occluded{};    // pairs whose clip hid part of the edge
+        size_t segments{};
+    };
+
+    // Segments come out grouped by body, then edge, in order; results do not depend
+    // on the thread count.
+    const std::vector<VisibleSegment>& compute(std::span<const Object* const> bodies, TaskScheduler* scheduler = nullptr);
+
+    const std::vector<VisibleSegment>& segments() const { return result; }
+    const Stats& stats() const { return lastStats; }
+
+private:
+    // Face planes of one occluder, unit normals pointing out: a*x + b*y + c*z + d <= 0 inside.
+    struct Occluder {
+        size_t firstPlane, planeCount;
+        float minX, minY, minZ, maxX, maxY, maxZ;
+    };
+    struct Edge {
+        float x0, y0, z0, x1, y1, z1;
+        std::uint32_t body, edge;
+    };
+    // Output and scratch of one fixed range of edges.
+    struct Chunk {
+        std::vector<VisibleSegment> segments;
+        std::vector<std::uint32_t> candidates;  // occluders near the current edge
+        std::vector<std::pair<float, float>> hidden;  // parameter ranges of the current edge
+        std::vector<float> poly, clipped;       // (t, s) polygon being clipped
+        size_t candidatePairs{}, occludedPairs{};
+    };
+
+    void addBody(const Object& o, std::uint32_t body);
+    void buildGrid();
+    void processEdges(Chunk& c, size_t begin, size_t end) const;
+    bool hiddenInterval(const Edge& e, const Occluder& oc, Chunk& c, float& t0, float& t1) const;
+
+    std::vector<float> planes;  // 4 floats per plane
+    std::vector<Occluder> occluders;
+    std::vector<std::uint32_t> occluderBody;
+    std::vector<Vertex> ndc;    // scratch: one body's vertices after the divide by w
+    std::vector<Edge> edges;
+    // Uniform grid over the occluders' screen bounds, CSR bins of occluder indices.
+    int gridX{}, gridY{};
+    float gridMinX{}, gridMinY{}, cellW{}, cellH{};
+    std::vector<std::uint32_t> cellStart, cellIndex;
+    std::vector<Chunk> chunks;
+    std::vector<VisibleSegment> result;
+    Stats lastStats;
+};
+
+// SVG of the segments in a width x height viewport, mapped from NDC like glViewport.
+// Coordinates are written with enough precision for print-size output. Throws
+// std::runtime_error on I/O errors.
+void writeSvg(const std::string& path, std::span<const VisibleSegment> segments, int width, int height,
+              float strokeWidth = 1.0f);
+
+}
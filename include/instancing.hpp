@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "bounds.hpp"
+#include "math3d.hpp"
+#include "object.hpp"
+
+namespace math3d {
+
+class TaskScheduler;
+
+// Many copies of one mesh. The mesh Object (original, edges, planes, topology and
+// face normals) is shared and only read; each instance adds one model matrix. All
+// instances share one view and projection. Apart from the per-instance matrices,
+// a facing word per 64 faces and a visibility index, memory does not grow with the
+// instance count.
+//
+// update() handles every instance in one batch:
+//  - projViewModel = projection * view * model, for instanced GPU submission;
+//  - facing with the same test as Object::updateFaceFacingEye. The eye direction is
+//    taken back to object space once per instance, which leaves one dot product per
+//    face against the shared normals;
+//  - culling of instances whose mesh bounds are entirely outside the view volume,
+//    tested per instance in object space against projViewModel.
+class InstancedObject {
+public:
+    // `mesh` must outlive this object. Its normals and topology are built here if they are missing.
+    explicit InstancedObject(Object& mesh);
+
+    const Object& mesh() const { return *shared; }
+
+    size_t size() const { return models.size(); }
+    size_t add(const Mat4& model);
+    void resize(size_t n, const Mat4& model = Mat4::identity());
+    void setModel(size_t instance, const Mat4& model);
+    const Mat4& model(size_t instance) const { return models[instance]; }
+
+    void setView(const Mat4& v) { if (!(v == view)) { view = v; cameraDirty = true; } }
+    void setProjection(const Mat4& p) { if (!(p == projection)) { projection = p; cameraDirty = true; } }
+
+    // Brings the per-instance results up to date. Returns false without touching any
+    // instance when nothing changed. Instances are split into parallel chunks on
+    // `scheduler`; the results do not depend on the thread count.
+    bool update(TaskScheduler* scheduler = nullptr);
+
+    // Per instance, valid after update().
+    const Mat4& projViewModel(size_t instance) const { return pvm[instance]; }
+    std::span<const Mat4> projViewModels() const { return pvm; }
+    size_t facingWords() const { return words; }
+    std::span<const std::uint64_t> facing(size_t instance) const { return {facingBits.data() + instance * words, words}; }
+    bool isFacing(size_t instance, size_t face) const {
+        return (facingBits[instance * words + (face >> 6)] >> (face & 63)) & 1;
+    }
+    // Instances that survived culling, in increasing order.
+    std::span<const std::uint32_t> visible() const { return visibleIds; }
+    // Edges of `instance` bordering one of its facing faces.
+    void visibleEdges(size_t instance, std::vector<int>& out) const;
+
+    // Bounds of the shared mesh, object space.
+    const Bounds& bounds() const { return meshBounds; }
+    // Culling counts of the last update that did any work.
+    const CullStats& cullStats() const { return cull; }
+
+    struct Stats {
+        unsigned long long updates{};
+        unsigned long long skipped{};
+        unsigned long long instancesUpdated{};
+    } stats;
+
+private:
+    void prepareMesh();
+
+    Object* shared;
+    std::vector<Mat4> models, pvm;
+    std::vector<std::uint64_t> facingBits;
+    std::vector<std::uint32_t> visibleIds;
+    std::vector<std::uint8_t> inside;  // scratch: per-instance cull result
+    size_t words{};
+    Bounds meshBounds;
+    CullStats cull;
+    unsigned long long preparedMesh{~0ull};
+    Mat4 view{Mat4::identity()}, projection{Mat4::identity()};
+    bool cameraDirty{true}, modelsDirty{true};
+};
+
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace math3d {
+
+// Read-only memory mapping of a file. One view is mapped at a time, either the
+// whole file or a window of it. Throws std::runtime_error on I/O errors.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::uint64_t size() const { return fileSize; }
+
+    // Maps [offset, offset + length), clamped to the end of the file, replacing the
+    // previous view. The returned bytes stay valid until the next map()/unmap().
+    std::span<const char> map(std::uint64_t offset, size_t length);
+    void unmap();
+
+    // Mapping offsets are aligned down to this (page size / allocation granularity).
+    static size_t granularity();
+
+private:
+#if defined(_WIN32)
+    void* file{};
+    void* mapping{};
+#else
+    int fd{-1};
+#endif
+    std::uint64_t fileSize{};
+    void* view{};
+    size_t viewLength{};
+};
+
+// Forward-only cursor over a file that keeps a single window mapped and slides it
+// as the cursor moves, so files larger than memory stream through a bounded view.
+class SequentialReader {
+public:
+    SequentialReader(const std::string& path, size_t windowBytes);
+
+    std::uint64_t size() const { return file.size(); }
+    std::uint64_t position() const { return pos; }
+    bool eof() const { return pos >= file.size(); }
+
+    // Pointer to `n` contiguous bytes at the cursor, or nullptr if fewer remain.
+    const char* ensure(size_t n);
+    void advance(size_t n) { pos += n; }
+
+    // Next line without its line terminator; false at end of file.
+    bool nextLine(std::string_view& line);
+
+private:
+    void slide(size_t minBytes);
+
+    MappedFile file;
+    size_t window;
+    std::uint64_t pos{};
+    std::uint64_t viewStart{};
+    std::span<const char> view;
+};
+
+}
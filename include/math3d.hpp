@@ -1,5 +1,9 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <span>
 #include <vector>
 
 namespace math3d {
@@ -11,19 +15,94 @@ struct Vertex {
     float w{1.0f};
 };
 
+// Structure-of-arrays vertex storage: every component lives in its own contiguous
+// lane. The w lane is optional; when it is empty every vertex has w == 1.
+struct VertexSoA {
+    std::vector<float> x, y, z, w;
+
+    size_t size() const { return x.size(); }
+    bool hasW() const { return !w.empty(); }
+    Vertex at(size_t i) const { return {x[i], y[i], z[i], hasW() ? w[i] : 1.0f}; }
+
+    void resize(size_t n, bool withW);
+    void assign(std::span<const Vertex> v);  // keeps w only if some vertex has w != 1
+};
+
+// Fixed-size 4x4 matrix, stored row-major: element (row, col) lives at
+// m[row * 4 + col], so rows are contiguous exactly like the {{row0}, {row1}, ...}
+// literals of the legacy vector-of-vectors API. Vertices are column vectors (M * v).
+struct alignas(16) Mat4 {
+    float m[16]{};
+
+    float& operator()(int row, int col) { return m[row * 4 + col]; }
+    float operator()(int row, int col) const { return m[row * 4 + col]; }
+
+    static constexpr Mat4 identity() {
+        return Mat4{{1, 0, 0, 0,
+                     0, 1, 0, 0,
+                     0, 0, 1, 0,
+                     0, 0, 0, 1}};
+    }
+
+    // Compatibility with the vector-of-vectors API; throws on non 4x4 input.
+    static Mat4 fromRows(const std::vector<std::vector<float>>& rows);
+    operator std::vector<std::vector<float>>() const;
+};
+
+bool operator==(const Mat4& A, const Mat4& B);
+bool isAffine(const Mat4& m);  // bottom row is exactly {0, 0, 0, 1}
+// Inverse-transpose of the upper 3x3 block with zero translation: maps object-space
+// normals correctly under non-uniform scale and reflections. A singular block
+// yields its cofactor matrix instead.
+Mat4 normalMatrix(const Mat4& m);
+
 Vertex make_vertex(float x, float y, float z);
+Vertex mulMatVec(const Mat4& m, const Vertex& v);
+Mat4 matMul(const Mat4& A, const Mat4& B);
+
+Mat4 translate(float dx, float dy, float dz);
+Mat4 scaleMat(float sx, float sy, float sz);
+Mat4 rotX(float a);
+Mat4 rotY(float a);
+Mat4 rotZ(float a);
+Mat4 reflect(bool rx, bool ry, bool rz);
+Mat4 ortho(float left, float right, float bottom, float top, float n, float f);
+
+// Legacy arbitrary-size API, kept for existing callers and tests.
 Vertex mulMatVec(const std::vector<std::vector<float>>& m, const Vertex& v);
 std::vector<std::vector<float>> matMul(const std::vector<std::vector<float>>& A, const std::vector<std::vector<float>>& B);
 
-std::vector<std::vector<float>> translate(float dx, float dy, float dz);
-std::vector<std::vector<float>> scaleMat(float sx, float sy, float sz);
-std::vector<std::vector<float>> rotX(float a);
-std::vector<std::vector<float>> rotY(float a);
-std::vector<std::vector<float>> rotZ(float a);
-std::vector<std::vector<float>> reflect(bool rx, bool ry, bool rz);
-std::vector<std::vector<float>> ortho(float left, float right, float bottom, float top, float n, float f);
+// Batch transform kernels: out[i] = m * in[i]. `in` and `out` must have the same
+// length and may alias exactly (in-place transform). Every path evaluates each
+// component as ((m0*x + m1*y) + m2*z) + m3*w in that order, with no fused
+// multiply-add, so all paths produce bit-identical results (tolerance: 0 ULP).
+enum class SimdPath { Scalar, SSE2, AVX2, NEON };
+
+bool simdPathSupported(SimdPath path);
+SimdPath bestSimdPath();
+const char* simdPathName(SimdPath path);
+
+void transformVertices(const Mat4& m, std::span<const Vertex> in, std::span<Vertex> out);
+void transformVertices(const Mat4& m, std::span<const Vertex> in, std::span<Vertex> out, SimdPath path);
+
+// SoA variants: `out` is resized to `in` and gets a w lane only when w can differ
+// from 1 (input has one, or m is not affine). `out` may be the same object as `in`.
+void transformVertices(const Mat4& m, const VertexSoA& in, VertexSoA& out);
+void transformVertices(const Mat4& m, const VertexSoA& in, VertexSoA& out, SimdPath path);
+
+// Range form for splitting one SoA transform across threads: only [begin, end) of
+// `out` is written. `out` must already be sized like the whole-stream variant sizes
+// it, i.e. in.size() entries and a w lane when in has one or m is not affine.
+void transformVertices(const Mat4& m, const VertexSoA& in, VertexSoA& out, size_t begin, size_t end);
+
+// dots[i] = dot(normals[i], toEye), and bit i of `mask` (64 faces per word) is set
+// when that dot is positive. `dots` needs normals.size() entries, `mask` (n + 63) / 64.
+void facingTest(const VertexSoA& normals, Vertex toEye, std::span<float> dots, std::span<std::uint64_t> mask);
+// Faces [begin, end) only; begin must be a multiple of 64 so ranges own whole mask words.
+void facingTest(const VertexSoA& normals, Vertex toEye, std::span<float> dots, std::span<std::uint64_t> mask,
+                size_t begin, size_t end);
 
 float dot(Vertex v1, Vertex v2);
-float deg2rad(float d);
+constexpr float deg2rad(float d) { return d * std::numbers::pi_v<float> / 180.0f; }
 
 }
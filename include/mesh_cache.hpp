@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+#include "mapped_file.hpp"
+#include "mesh_io.hpp"
+#include "object.hpp"
+
+namespace math3d {
+
+// Identifies the source a cache was built from; a mismatch means the cache is stale.
+struct MeshSourceStamp {
+    std::uint64_t size{};
+    std::int64_t mtime{};  // file clock ticks, as reported by std::filesystem
+
+    static MeshSourceStamp of(const std::string& path);
+    bool operator==(const MeshSourceStamp&) const = default;
+};
+
+// On-disk layout (native endianness, checked on open):
+//   header | section table | sections, each 64-byte aligned and contiguous.
+// Sections hold the vertex stream, the edge list, faces and triangles as CSR
+// index arrays, and every Topology array, so nothing is re-derived on load.
+inline constexpr std::uint32_t kMeshCacheVersion = 1;
+
+// Writes `o` (vertices, edges, planes and adjacency) to `path`. Adjacency is built
+// here if the object has not built it yet. Throws std::runtime_error on I/O errors.
+void writeMeshCache(const std::string& path, const Object& o, const MeshSourceStamp& source);
+
+// A memory-mapped cache file. The accessors point straight into the mapping and
+// stay valid for the lifetime of the MeshCache.
+class MeshCache {
+public:
+    // Throws std::runtime_error if the file is missing, truncated, from another
+    // version or written with a different byte order.
+    explicit MeshCache(const std::string& path);
+
+    const MeshSourceStamp& source() const { return stamp; }
+
+    std::span<const Vertex> vertices() const;
+    std::span<const std::int32_t> edges() const;  // (a, b) pairs
+    std::span<const std::int32_t> faceOffsets() const;
+    std::span<const std::int32_t> faceIndices() const;
+    std::span<const std::int32_t> triOffsets() const;  // per face, into triIndices
+    std::span<const std::int32_t> triIndices() const;
+    Topology::Arrays topology() const;
+
+    // Replaces the mesh of `o` with the cached one, adjacency included, and clears
+    // o.convex as loadMesh() does. The contiguous streams are bulk copies; only Plane
+    // needs a per-face vector.
+    void applyTo(Object& o) const;
+
+private:
+    template <typename T>
+    std::span<const T> section(std::uint32_t kind) const;
+
+    MappedFile file;
+    std::span<const char> bytes;
+    MeshSourceStamp stamp;
+};
+
+// loadMesh() backed by a cache file (`<path>.m3dc` unless options say otherwise).
+// The cache is used when its stamp matches the source and rebuilt otherwise;
+// MeshLoadStats::fromCache tells which happened.
+MeshLoadStats loadMeshCached(const std::string& path, Object& o, const MeshLoadOptions& options = {});
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "object.hpp"
+
+namespace math3d {
+
+struct MeshLoadOptions {
+    // Bytes of the file mapped at a time. The parser slides this window through the
+    // file, so memory use stays bounded no matter how large the file is.
+    size_t windowBytes{64u << 20};
+    // Cache file used by loadMeshCached(); empty means the source path plus ".m3dc".
+    std::string cachePath;
+};
+
+struct MeshLoadStats {
+    double seconds{};
+    std::uint64_t bytes{};
+    size_t vertices{}, faces{}, edges{};
+    bool fromCache{false};
+
+    double megabytesPerSecond() const { return seconds > 0 ? bytes / (1024.0 * 1024.0) / seconds : 0.0; }
+    double verticesPerSecond() const { return seconds > 0 ? vertices / seconds : 0.0; }
+};
+
+// Replaces o.original, o.edges and o.planes with the mesh in `path`. Faces with more
+// than three corners get a fan triangulation in Plane::tris (triangles are already
+// their own verts); edges are the unique undirected sides of all faces. Clears
+// o.convex, so face normals follow the file's counter-clockwise winding.
+// Throws std::runtime_error on I/O or format errors.
+MeshLoadStats loadObj(const std::string& path, Object& o, const MeshLoadOptions& options = {});
+// ASCII and binary (little/big endian) PLY with a vertex and a face element.
+MeshLoadStats loadPly(const std::string& path, Object& o, const MeshLoadOptions& options = {});
+// Picks the parser from the file extension (.obj or .ply, case-insensitive).
+MeshLoadStats loadMesh(const std::string& path, Object& o, const MeshLoadOptions& options = {});
+
+}
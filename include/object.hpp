@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "bounds.hpp"
+#include "math3d.hpp"
+#include "task_scheduler.hpp"
+#include "topology.hpp"
+
+namespace math3d {
+
+struct Plane {
+    std::vector<int> verts;
+    std::vector<std::vector<int>> tris;  
+};
+
+enum class VertexLayout { AoS, SoA };
+
+// A mesh with its model/view/projection matrices and everything derived from them.
+// Contains no rendering code, so it can be driven headless (tests, benchmarks).
+class Object {
+public:
+    Vertex viewDirection{ 0, 0, -1 };
+    std::vector<Vertex> original, world, projected;
+    VertexLayout layout{VertexLayout::AoS};
+    VertexSoA originalSoA, worldSoA, projectedSoA;
+    std::vector<std::pair<int,int>> edges;
+    std::vector<Plane> planes;
+    Topology topology;
+    VertexSoA faceNormals, viewNormals;  // outward unit normals, object and view space
+    std::vector<float> faceDots;
+    std::vector<std::uint64_t> facing;   // bit f set when face f faces the eye
+    std::vector<int> visibleEdges;       // edges bordering a facing face
+    
+    Mat4 model{Mat4::identity()}, view{Mat4::identity()}, projection{Mat4::identity()};
+    Mat4 viewModel{Mat4::identity()}, projViewModel{Mat4::identity()};
+    Vertex center;
+    bool useRoberts{true};
+    // A convex body may be wound either way: its normals are turned away from the
+    // centroid. The mesh loaders clear this, since a concave mesh would get inverted
+    // normals in its hollows; their faces must be counter-clockwise seen from outside.
+    bool convex{true};
+    // Object-space box and sphere, rebuilt whenever `original` changes.
+    Bounds bounds;
+    // When set, update() tests the bounds against the view volume of projViewModel
+    // first and, if they are entirely outside, sets `culled` and skips all per-vertex
+    // and per-face work; projected and facing data are stale until it is back in view.
+    bool frustumCulling{true};
+    bool culled{false};
+    // Whether `projected` is produced on the CPU; off when a GPU backend projects with projViewModel.
+    bool cpuProjection{true};
+    // Splits the per-vertex and per-face passes into parallel chunks on this pool;
+    // null runs them on the calling thread. Results do not depend on the thread count.
+    TaskScheduler* scheduler{nullptr};
+    // Bumped whenever the mesh or its facing changes, so GPU copies know when to re-upload.
+    unsigned long long meshVersion{}, facingVersion{};
+
+    // Counters for update(): an idle frame only bumps `updates` and `skipped`.
+    struct UpdateStats {
+        unsigned long long updates{};
+        unsigned long long skipped{};
+        unsigned long long worldPasses{};
+        unsigned long long projectedPasses{};
+        unsigned long long transformedVertices{};
+        unsigned long long culled{};  // updates that found the object outside the view volume
+    } stats;
+
+    // Inputs changed since the last update(); everything starts dirty.
+    bool modelDirty{true}, viewDirty{true}, projectionDirty{true}, geometryDirty{true};
+    // Derived data that is only produced when a consumer needs it.
+    bool worldValid{false}, projectedValid{false}, facingValid{false}, normalsValid{false}, topologyDirty{true};
+
+    // Setters only record changes; derived data is rebuilt on the next update().
+    void setModel(const Mat4& m) { if (!(m == model)) { model = m; modelDirty = true; } }
+    void setView(const Mat4& v) { if (!(v == view)) { view = v; viewDirty = true; } }
+    void setProjection(const Mat4& p) { if (!(p == projection)) { projection = p; projectionDirty = true; } }
+
+    // Call after editing original directly.
+    void invalidate() { geometryDirty = true; ++meshVersion; }
+    // Call after editing edges/planes directly; adjacency is rebuilt on the next update().
+    void invalidateTopology() { topologyDirty = true; ++meshVersion; }
+
+    bool isDirty() const {
+        return modelDirty || viewDirty || projectionDirty || geometryDirty ||
+               (!culled && cpuProjection && !projectedValid) ||
+               (!culled && useRoberts && (!facingValid || topologyDirty));
+    }
+
+    // Brings the matrices, the projected stream (if cpuProjection) and, for Roberts,
+    // facing and adjacency up to date.
+    // Returns false without touching any vertex when no input changed since the previous call.
+    bool update();
+
+    // For consumers that read world-space vertices outside of update().
+    void requestWorld();
+
+    // Projected comes from one fused P*V*M pass over `original` unless some consumer
+    // already produced world space. Facing only needs the face normals, not world.
+    void recompute();
+    void computeWorld();
+
+    // SoA keeps each vertex component in its own lane; `original` stays the source of truth.
+    void setLayout(VertexLayout l);
+
+    Vertex worldAt(size_t i) const { return layout == VertexLayout::SoA ? worldSoA.at(i) : world[i]; }
+    Vertex projectedAt(size_t i) const { return layout == VertexLayout::SoA ? projectedSoA.at(i) : projected[i]; }
+    bool isFacing(size_t f) const { return (facing[f >> 6] >> (f & 63)) & 1; }
+
+    // Outward unit normals in object space via Newell's method, oriented away from
+    // the mesh centroid when `convex` is set and by the winding otherwise. Depends
+    // only on original, planes and convex.
+    void computeFaceNormals();
+
+    // Normals go to view space with the inverse-transpose of the view-model matrix,
+    // which stays correct under non-uniform scale and reflections; a face is visible
+    // when its normal points against the view direction.
+    void updateFaceFacingEye();
+
+    // Centroid of the world-space vertices; produces the world stream if needed.
+    // Sums fixed-size blocks, then the block sums in order, so the result is the
+    // same bits for any thread count.
+    void computeCenter();
+
+    void buildTopology();
+
+private:
+    void forRange(size_t n, size_t minGrain, RangeBody body) const;
+    void transformStream(const Mat4& m, std::span<const Vertex> in, std::vector<Vertex>& out) const;
+    void transformStream(const Mat4& m, const VertexSoA& in, VertexSoA& out) const;
+};
+
+// The app's default scene: a cube of side 0.4 centered on the origin, and the three
+// coordinate axes as a wireframe without faces.
+Object builtinCube();
+Object builtinAxes();
+
+// Centers a loaded mesh on the origin and scales it to the size of builtinCube().
+void fitToBuiltinCube(Object& o);
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "math3d.hpp"
+#include "task_scheduler.hpp"
+
+namespace math3d {
+
+// Point files: Xyz is text, one "x y z" point per line (further columns are dropped,
+// empty lines and '#' comments skipped); Binary is packed native-endian float32
+// x, y, z triples with no header.
+enum class PointFormat { Xyz, Binary };
+
+// .xyz, .txt, .asc or .pts is Xyz; .bin or .f32 is Binary (case-insensitive).
+// Throws std::runtime_error for anything else.
+PointFormat pointFormatFor(const std::string& path);
+
+struct PointStreamOptions {
+    size_t chunkPoints{1u << 20};   // points handed between stages at a time
+    size_t chunksInFlight{4};       // chunk buffers cycling through the pipeline
+    size_t windowBytes{64u << 20};  // input bytes mapped at a time
+    // Transforms each chunk in parallel on this pool; null uses the calling thread alone.
+    TaskScheduler* scheduler{};
+};
+
+struct PointStreamStats {
+    std::uint64_t points{}, bytesRead{}, bytesWritten{};
+    double seconds{};
+    // Time each stage spent working rather than waiting on its neighbours. With the
+    // stages overlapped, `seconds` approaches the largest of the three.
+    double readSeconds{}, transformSeconds{}, writeSeconds{};
+
+    double pointsPerSecond() const { return seconds > 0 ? points / seconds : 0.0; }
+};
+
+// Streams the points of `inPath` through `m` into `outPath`. A reader thread parses
+// chunks out of a sliding memory-mapped window, the calling thread transforms them on
+// the SIMD kernels, and a writer thread formats and writes them, so the three overlap
+// and memory stays bounded by the chunk buffers for any file size. Output order
+// matches input order. `m` must be affine (ortho is; perspective is not), since
+// points carry no w. Throws std::runtime_error on I/O or format errors.
+PointStreamStats transformPointFile(const std::string& inPath, PointFormat inFormat, const std::string& outPath,
+                                    PointFormat outFormat, const Mat4& m, const PointStreamOptions& options = {});
+
+}
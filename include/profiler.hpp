@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace math3d {
+
+// One timed scope. `name` is a string literal, or otherwise outlives the profiler.
+struct ProfileEvent {
+    const char* name{};
+    std::uint64_t beginNs{}, endNs{};  // since the profiler was created
+    std::uint64_t frame{};             // Profiler::frame() when the scope ended
+    std::uint32_t thread{};            // small per-thread id, in order of first use
+    std::uint32_t depth{};             // scopes open on the same thread around this one
+
+    double ms() const { return (endNs - beginNs) * 1e-6; }
+};
+
+// Scoped timers feeding a fixed ring of the most recent events. Any thread records
+// without locks: an index is claimed with one fetch_add and published with a sequence
+// number, so readers copy only completed slots and never hold writers up. When the
+// ring is full the oldest events are overwritten; a writer only waits when the
+// ring has wrapped onto a slot whose previous event is still being written.
+//
+// Disabled (the default), a ProfileScope costs one relaxed load and a branch.
+class Profiler {
+public:
+    // `capacity` is rounded up to a power of two.
+    explicit Profiler(size_t capacity = size_t{1} << 16);
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    bool enabled() const { return on.load(std::memory_order_relaxed); }
+    void setEnabled(bool enable) { on.store(enable, std::memory_order_relaxed); }
+
+    // Starts a new frame; events that end afterwards carry the new number.
+    void beginFrame() { frameIndex.fetch_add(1, std::memory_order_relaxed); }
+    std::uint64_t frame() const { return frameIndex.load(std::memory_order_relaxed); }
+
+    size_t capacity() const { return mask + 1; }
+    std::uint64_t now() const;
+    void record(const char* name, std::uint64_t beginNs, std::uint64_t endNs, std::uint32_t depth);
+
+    // Events still in the ring, oldest first. Slots being written meanwhile are left
+    // out. Reuses the capacity of `out`.
+    void snapshot(std::vector<ProfileEvent>& out) const;
+
+    // Process-wide instance the library's own scopes report to.
+    static Profiler& global();
+
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> sequence{0};  // 2 * index + 2 once slot `index` is complete
+        std::atomic<const char*> name{nullptr};
+        std::atomic<std::uint64_t> begin{0}, end{0}, frame{0};
+        std::atomic<std::uint32_t> thread{0}, depth{0};
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+    std::atomic<std::uint64_t> head{0};
+    std::atomic<std::uint64_t> frameIndex{0};
+    std::atomic<bool> on{false};
+    std::chrono::steady_clock::time_point epoch;
+};
+
+// Times the enclosing block on `profiler` when it is enabled at construction.
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name, Profiler& profiler = Profiler::global())
+        : target(profiler.enabled() ? &profiler : nullptr) {
+        if (target) start(name);
+    }
+    ~ProfileScope() {
+        if (target) stop();
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    void start(const char* name);
+    void stop();
+
+    Profiler* target;
+    const char* label{};
+    std::uint64_t begin{};
+    std::uint32_t depth{};
+};
+
+// Rolling per-stage statistics over a range of frames: for every scope name, the
+// time it took per frame (summed over its occurrences in that frame), in ms.
+// Buffers are kept between builds, so a steady-state overlay does not allocate.
+class ProfileReport {
+public:
+    struct Stage {
+        const char* name{};
+        size_t frames{};  // frames in which the stage ran
+        double p50{}, p95{}, p99{}, max{};
+    };
+
+    // Frames [firstFrame, endFrame) of `events`; stages are listed in order of first appearance.
+    void build(std::span<const ProfileEvent> events, std::uint64_t firstFrame, std::uint64_t endFrame);
+    std::span<const Stage> stages() const { return {list.data(), count}; }
+
+private:
+    std::vector<Stage> list;
+    size_t count{};
+    std::vector<double> perFrame;     // stage-major, one entry per frame
+    std::vector<std::uint8_t> ran;
+    std::vector<double> scratch;
+};
+
+// Chrome trace event format ("X" complete events, microseconds), readable by
+// chrome://tracing and Perfetto.
+void writeChromeTrace(const std::string& path, std::span<const ProfileEvent> events);
+
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "object.hpp"
+
+namespace math3d {
+
+class TaskScheduler;
+
+struct Rgb {
+    float r{}, g{}, b{};
+};
+
+struct RasterOptions {
+    int width{800}, height{800};
+    // Square screen tiles; each tile is rasterized by one thread.
+    int tileSize{64};
+    // Same colors as the GL path.
+    Rgb clearColor{0.1f, 0.1f, 0.1f};
+    Rgb faceColor{0.3f, 0.6f, 0.9f};
+    Rgb lineColor{1.0f, 1.0f, 1.0f};
+};
+
+// Headless replacement for the GL Roberts path. Projected (NDC) vertices are mapped
+// to the viewport like glViewport does. Facing faces are filled with a less-than
+// depth test against a [0, 1] depth buffer. Visible edges are then drawn on top
+// without a depth test, as drawRoberts does. Wireframe objects only get their edges.
+//
+// Faces and edges are set up and binned to tiles in fixed-size chunks, in parallel.
+// Each tile is then rasterized independently, walking the chunks in submission
+// order and testing 4 pixels at a time against the edge functions. Every pixel is
+// evaluated directly rather than incrementally, so the image does not depend on
+// the tile size or the thread count.
+class SoftwareRasterizer {
+public:
+    explicit SoftwareRasterizer(const RasterOptions& options = {});
+
+    // Clears color and depth. Bins and buffers are kept, so steady-state frames do not allocate.
+    void clear();
+
+    // Draws `o` over what is already in the buffers. Needs the CPU-projected stream
+    // (cpuProjection) and, for Roberts objects, the facing data of an update().
+    // A culled Object draws nothing.
+    void draw(const Object& o, TaskScheduler* scheduler = nullptr);
+
+    int width() const { return opts.width; }
+    int height() const { return opts.height; }
+    // Row-major, top row first, RGBA8 with bytes in R, G, B, A order.
+    const std::vector<std::uint32_t>& color() const { return colorBuffer; }
+    const std::vector<float>& depth() const { return depthBuffer; }
+    std::uint32_t pixel(int x, int y) const { return colorBuffer[static_cast<size_t>(y) * opts.width + x]; }
+
+    struct Stats {
+        size_t triangles{};   // triangles that survived setup (on screen, non-degenerate)
+        size_t binEntries{};  // triangle/tile pairs
+        size_t lines{};
+    };
+    const Stats& stats() const { return lastStats; }
+
+private:
+    // Edge i runs from (ax, ay) along (dx, dy) and is opposite vertex i, so its edge
+    // function divided by the area is the barycentric weight of vertex i.
+    struct Triangle {
+        float ax[3], ay[3], dx[3], dy[3];
+        bool topLeft[3];
+        float z[3];  // depth at the vertices, pre-divided by the area
+        int minX, minY, maxX, maxY;
+    };
+    struct Line {
+        float x0, y0, x1, y1;
+    };
+    // Setup and binning output of a fixed range of faces and edges. Bins are CSR:
+    // tile t owns triangleIndex[triangleStart[t] .. triangleStart[t + 1]).
+    struct Chunk {
+        std::vector<Triangle> triangles;
+        std::vector<Line> lines;
+        std::vector<std::uint32_t> triangleStart, triangleIndex, lineStart, lineIndex;
+    };
+
+    void setupTriangle(std::vector<Triangle>& out, Vertex v0, Vertex v1, Vertex v2) const;
+    void setupChunk(const Object& o, Chunk& c, size_t faceBegin, size_t faceEnd, size_t edgeBegin, size_t edgeEnd) const;
+    void binChunk(Chunk& c) const;
+    void rasterizeTile(size_t tile);
+
+    RasterOptions opts;
+    int tilesX{}, tilesY{};
+    std::vector<std::uint32_t> colorBuffer;
+    std::vector<float> depthBuffer;
+    std::vector<Chunk> chunks;
+    size_t chunkCount{};
+    std::uint32_t faceRgba{}, lineRgba{};
+    Stats lastStats;
+};
+
+std::uint32_t packRgba(Rgb c);
+
+// Binary PPM (P6) and PNG (uncompressed deflate, no dependencies) of the color
+// buffer. Throw std::runtime_error on I/O errors.
+void writePpm(const std::string& path, const SoftwareRasterizer& r);
+void writePng(const std::string& path, const SoftwareRasterizer& r);
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <span>
+
+#include "affine.hpp"
+
+namespace math3d {
+
+// Single-precision sin and cos of the same angle in one pass: one range reduction
+// (in double) and two short float polynomials on [-pi/4, pi/4]. Branch-free,
+// so the batch form runs four angles per SSE2 instruction; both forms give the same
+// bits. Max error against the correctly rounded result is 2 ulp for |a| <= 8192
+// (covered by the tests); accuracy degrades beyond that, use std::sin/std::cos there.
+void sinCos(float a, float& s, float& c);
+// s[i], c[i] = sin(a[i]), cos(a[i]). All spans have the same length.
+void sinCos(std::span<const float> a, std::span<float> s, std::span<float> c);
+
+// rotX(x) * rotY(y) * rotZ(z) in closed form, angles in radians: the matrix
+// Controller::rotateSliders used to build with two products.
+Affine3x4 eulerXYZ(float x, float y, float z);
+// out[i] = eulerXYZ(x[i], y[i], z[i]). All spans have the same length.
+void eulerXYZ(std::span<const float> x, std::span<const float> y, std::span<const float> z, std::span<Affine3x4> out);
+
+// Euler XYZ rotation as a transform expression factor (see transform_expr.hpp).
+struct EulerXYZ {
+    float x{}, y{}, z{};
+
+    Affine3x4 affine() const { return eulerXYZ(x, y, z); }
+    // acc = acc * R: the three linear columns are replaced by L * R.
+    void applyTo(Affine3x4& acc) const;
+};
+
+// Unit quaternion, in the same rotation convention as the Mat4 builders:
+// toAffine(quatX(a)) == rotX(a), and the product q * r is the rotation toAffine(q) * toAffine(r).
+struct Quat {
+    float w{1}, x{}, y{}, z{};
+};
+
+Quat quatX(float a);
+Quat quatY(float a);
+Quat quatZ(float a);
+// Same rotation as eulerXYZ(x, y, z).
+Quat quatEulerXYZ(float x, float y, float z);
+
+Quat operator*(const Quat& a, const Quat& b);
+float dot(const Quat& a, const Quat& b);
+Quat normalize(const Quat& q);  // the identity for a zero quaternion
+// Shortest-arc spherical interpolation; t = 0 gives a, t = 1 gives b (or -b).
+// Falls back to normalized linear interpolation when the two are nearly equal.
+Quat slerp(const Quat& a, const Quat& b, float t);
+
+Affine3x4 toAffine(const Quat& q);
+// out[i] = toAffine(q[i]); out[i] = toAffine(slerp(a[i], b[i], t)). Same-length spans.
+void toAffine(std::span<const Quat> q, std::span<Affine3x4> out);
+void slerp(std::span<const Quat> a, std::span<const Quat> b, float t, std::span<Affine3x4> out);
+
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "math3d.hpp"
+
+namespace math3d {
+
+class Object;
+class TaskScheduler;
+
+// Hierarchy of nodes with local transforms and cached world matrices
+// (world = parent world * local). Node data lives in flat arrays in depth-first
+// pre-order, so every subtree is one contiguous slot range and a parent always comes
+// before its children. setLocal() only records the node as dirty; update()
+// recomputes the dirty subtrees and nothing else.
+//
+// A node may carry an Object, which receives the node's world matrix as its model
+// and the graph's shared view and projection, so the camera is set once per frame
+// for all of them. An Object must be attached to at most one node.
+class SceneGraph {
+public:
+    using NodeId = std::uint32_t;
+    static constexpr NodeId kNone = ~NodeId{0};
+
+    // Ids are stable for the lifetime of the graph. Adding children depth-first keeps
+    // the order as is; any other order is fixed up by the next update().
+    NodeId addNode(NodeId parent = kNone, const Mat4& local = Mat4::identity(), Object* object = nullptr);
+    // Throws std::runtime_error when `parent` is inside the subtree of `node`.
+    void setParent(NodeId node, NodeId parent);
+    void setLocal(NodeId node, const Mat4& local);
+    // Hands the object the camera right away and the node's world on the next update().
+    // Null detaches it, e.g. while another thread owns the object.
+    void setObject(NodeId node, Object* object);
+
+    void setView(const Mat4& v);
+    void setProjection(const Mat4& p);
+    const Mat4& view() const { return viewMatrix; }
+    const Mat4& projection() const { return projectionMatrix; }
+
+    size_t size() const { return slotOf.size(); }
+    NodeId parent(NodeId node) const;
+    Object* object(NodeId node) const { return objects[slotOf.at(node)]; }
+    const Mat4& local(NodeId node) const { return locals[slotOf.at(node)]; }
+    // As of the last update().
+    const Mat4& world(NodeId node) const { return worlds[slotOf.at(node)]; }
+
+    // Recomputes the world matrices of every dirty subtree, passes them on to the
+    // attached objects and, if it changed, the camera too. Disjoint subtrees run in
+    // parallel on `scheduler`. Returns the number of world matrices recomputed.
+    size_t update(TaskScheduler* scheduler = nullptr);
+
+    struct Stats {
+        unsigned long long updates{};
+        unsigned long long recomputed{};  // world matrices
+        unsigned long long subtrees{};    // dirty ranges processed
+        unsigned long long reorders{};    // rebuilds of the depth-first order
+    } stats;
+
+private:
+    void reorder();
+    void markDirty(NodeId node) { dirty.push_back(node); }
+
+    // Per slot, in depth-first pre-order.
+    std::vector<NodeId> idAt;
+    std::vector<std::uint32_t> parentSlot;  // kNone for roots
+    std::vector<std::uint32_t> subtreeEnd;  // one past the last slot of the subtree
+    std::vector<Mat4> locals, worlds;
+    std::vector<Object*> objects;
+    // Per id.
+    std::vector<std::uint32_t> slotOf;
+
+    std::vector<NodeId> dirty;
+    std::vector<std::uint32_t> rangeBegin;  // scratch for update()
+    bool orderValid{true};
+    bool cameraDirty{false};
+    Mat4 viewMatrix{Mat4::identity()}, projectionMatrix{Mat4::identity()};
+};
+
+}
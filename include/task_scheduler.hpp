@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace math3d {
+
+// Non-owning reference to a callable taking (begin, end). Unlike std::function it
+// never allocates, so parallel loops in steady-state frames stay off the heap. The
+// callable must outlive the call it is passed to, as a lambda argument does.
+class RangeBody {
+public:
+    template <typename F>
+        requires(!std::same_as<std::remove_cvref_t<F>, RangeBody> && std::invocable<const F&, size_t, size_t>)
+    RangeBody(const F& f)
+        : object(&f), call([](const void* o, size_t begin, size_t end) { (*static_cast<const F*>(o))(begin, end); }) {}
+
+    void operator()(size_t begin, size_t end) const { call(object, begin, end); }
+
+private:
+    const void* object;
+    void (*call)(const void*, size_t, size_t);
+};
+
+// Small work-stealing pool for data-parallel loops. Each thread owns a deque of
+// index ranges: it keeps halving its current range, pushing the upper half onto the
+// back of its own deque, and pops from that back when done. An idle thread steals
+// from the front of another deque, where the largest pieces are. The thread that
+// calls parallelFor() works along until its loop has finished.
+class TaskScheduler {
+public:
+    // `threads` includes the calling thread, so 1 runs everything inline.
+    explicit TaskScheduler(unsigned threads = std::thread::hardware_concurrency());
+    ~TaskScheduler();
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    unsigned threadCount() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+    // Calls body(begin, end) on disjoint ranges covering [0, n) and returns once all
+    // of them have run. Loops of at most `minGrain` items, or any loop on a
+    // single-thread pool, run inline without touching the queues, so tiny meshes pay
+    // nothing for threading. May be called from inside a body; the first exception
+    // thrown by a body is rethrown here.
+    void parallelFor(size_t n, size_t minGrain, RangeBody body);
+
+    // Smallest range handed out for n items: about 8 pieces per thread, but never
+    // below minGrain.
+    size_t grainFor(size_t n, size_t minGrain) const;
+
+    // Process-wide pool sized to the hardware.
+    static TaskScheduler& global();
+
+private:
+    struct Loop {
+        RangeBody body;
+        size_t grain;
+        std::atomic<size_t> remaining;
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;
+    };
+    struct Range {
+        Loop* loop;
+        size_t begin, end;
+    };
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::deque<Range> ranges;
+    };
+
+    size_t queueIndex() const;
+    void push(size_t q, Range r);
+    bool pop(size_t q, Range& r);
+    bool steal(size_t q, Range& r);
+    void run(size_t q, Range r);
+    void workerMain(size_t q);
+
+    std::vector<std::thread> workers;
+    // One per worker, plus a shared last one for threads outside the pool.
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::atomic<size_t> queued{0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stopping{false};
+};
+
+}
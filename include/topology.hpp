@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace math3d {
+
+using Edge = std::pair<int, int>;
+
+// Mesh connectivity that depends only on the edge list and face polygons, so it
+// is built once per mesh instead of per frame. Both adjacency directions are
+// stored CSR-style: the faces of edge e are edgeFaces[edgeFaceOffsets[e] ..
+// edgeFaceOffsets[e + 1]), and likewise for the edges of a face.
+class Topology {
+public:
+    // A face edge (a, b) maps to the first entry of `edges` joining a and b in
+    // either direction; face edges missing from `edges` are ignored.
+    void build(std::span<const Edge> edges, std::span<const std::vector<int>> faces);
+    void clear();
+
+    int findEdge(int a, int b) const;  // -1 if a and b are not joined by an edge
+
+    std::span<const int> facesOfEdge(size_t e) const {
+        return {edgeFaces.data() + edgeFaceOffsets[e], edgeFaces.data() + edgeFaceOffsets[e + 1]};
+    }
+    std::span<const int> edgesOfFace(size_t f) const {
+        return {faceEdges.data() + faceEdgeOffsets[f], faceEdges.data() + faceEdgeOffsets[f + 1]};
+    }
+
+    // Replaces `visible` with the indices of edges that border at least one face whose
+    // bit is set in `facing` (64 faces per word). Manifold and boundary edges cost one
+    // OR of two bit tests; only edges shared by more than two faces walk their list.
+    void visibleEdges(std::span<const std::uint64_t> facing, std::vector<int>& visible) const;
+
+    // The flat arrays behind the topology, so it can be stored and restored without
+    // a rebuild (see mesh_cache.hpp).
+    struct Arrays {
+        std::span<const std::uint64_t> edgeKeys;
+        std::span<const int> edgeKeyIds, edgeFaceOffsets, edgeFaces, faceEdgeOffsets, faceEdges;
+        std::span<const int> pairEdge, pairFaceA, pairFaceB, nonManifoldEdges;
+    };
+    Arrays arrays() const;
+    void assign(const Arrays& a);
+    // Whether findEdge() can probe `keys`: empty, or a power of two of at least two
+    // slots with at least one of them free, so every probe ends.
+    static bool validEdgeKeys(std::span<const std::uint64_t> keys);
+
+    size_t edgeCount() const { return edgeFaceOffsets.empty() ? 0 : edgeFaceOffsets.size() - 1; }
+    size_t faceCount() const { return faceEdgeOffsets.empty() ? 0 : faceEdgeOffsets.size() - 1; }
+
+private:
+    static std::uint64_t key(int a, int b) {
+        if (a > b) std::swap(a, b);
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(a)) << 32) | static_cast<std::uint32_t>(b);
+    }
+
+    // Flat hash table from undirected edge key to edge index (power-of-two size,
+    // linear probing), kept as plain arrays so it can be stored as is.
+    static constexpr std::uint64_t kEmptySlot = ~std::uint64_t{0};
+    size_t hashSlot(std::uint64_t k) const;
+    std::vector<std::uint64_t> edgeKeys;
+    std::vector<int> edgeKeyIds;
+    std::vector<int> edgeFaceOffsets, edgeFaces;
+    std::vector<int> faceEdgeOffsets, faceEdges;
+
+    // Edges with one or two faces as flat pairs (a boundary edge repeats its face);
+    // edges without faces are never visible and are left out.
+    std::vector<int> pairEdge, pairFaceA, pairFaceB;
+    std::vector<int> nonManifoldEdges;
+};
+
+}
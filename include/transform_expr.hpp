@@ -0,0 +1,196 @@
+#pragma once
+
+#include <cmath>
+#include <concepts>
+#include <type_traits>
+
+#include "affine.hpp"
+
+namespace math3d {
+
+// Transform expressions: `Translation{...} * RotationX(a) * Scaling{...}` builds a
+// lightweight expression, not a matrix. affine() then evaluates the whole chain
+// into one Affine3x4, applying each factor to the running result in closed form: a
+// translation only moves the last column, a scale scales three columns, a rotation
+// mixes two. No intermediate matrix is built and no general product is taken.
+//
+// Everything is constexpr, so fixed transforms can be baked at compile time:
+//     constexpr Affine3x4 view = (Translation{0, 0, -3} * RotationX(deg2rad(30))).affine();
+// Each step takes the products and sums the corresponding Mat4 product would, in the
+// same order, so without FMA contraction the result at run time is bit-identical to
+// chaining the Mat4 builders with matMul. Rotations use
+// std::sin/std::cos there; at compile time a double-precision series, which can
+// differ from them in the last float bit.
+
+namespace detail {
+
+// sin and cos for constant evaluation: reduction by pi/2 in two parts (Cody-Waite),
+// then Taylor series on [-pi/4, pi/4], accurate to double precision there.
+constexpr void sinCosSeries(double x, double& s, double& c) {
+    constexpr double kTwoOverPi = 0.63661977236758134308;
+    constexpr double kPiOver2Hi = 1.57079632673412561417e+00;
+    constexpr double kPiOver2Lo = 6.07710050650619224932e-11;
+    const double q = x * kTwoOverPi;
+    const long long k = static_cast<long long>(q >= 0.0 ? q + 0.5 : q - 0.5);
+    const double r = (x - k * kPiOver2Hi) - k * kPiOver2Lo;
+    const double r2 = r * r;
+    double sr = 0.0, cr = 0.0, sTerm = r, cTerm = 1.0;
+    for (int n = 1; n <= 19; n += 2) {
+        sr += sTerm;
+        cr += cTerm;
+        sTerm *= -r2 / ((n + 1) * (n + 2));
+        cTerm *= -r2 / (n * (n + 1));
+    }
+    switch (static_cast<int>(k & 3)) {
+    case 0: s = sr; c = cr; break;
+    case 1: s = cr; c = -sr; break;
+    case 2: s = -sr; c = -cr; break;
+    default: s = -cr; c = sr; break;
+    }
+}
+
+struct SinCos {
+    float s, c;
+};
+
+constexpr SinCos sinCos(float a) {
+    if (std::is_constant_evaluated()) {
+        double s = 0.0, c = 0.0;
+        sinCosSeries(a, s, c);
+        return {static_cast<float>(s), static_cast<float>(c)};
+    }
+    return {static_cast<float>(std::sin(static_cast<double>(a))), static_cast<float>(std::cos(static_cast<double>(a)))};
+}
+
+}
+
+// Anything that can be applied on the right of an affine transform.
+template <typename T>
+concept TransformExpr = requires(const T& t, Affine3x4& acc) {
+    { t.applyTo(acc) } -> std::same_as<void>;
+    { t.affine() } -> std::same_as<Affine3x4>;
+};
+
+struct Translation {
+    float x{}, y{}, z{};
+
+    constexpr Affine3x4 affine() const {
+        return Affine3x4{{1, 0, 0, x,
+                          0, 1, 0, y,
+                          0, 0, 1, z}};
+    }
+    // acc = acc * T: the translation column gains L * t.
+    constexpr void applyTo(Affine3x4& acc) const {
+        for (int i = 0; i < 3; ++i) acc(i, 3) = acc(i, 0) * x + acc(i, 1) * y + acc(i, 2) * z + acc(i, 3);
+    }
+};
+
+struct Scaling {
+    float x{1}, y{1}, z{1};
+
+    constexpr Affine3x4 affine() const {
+        return Affine3x4{{x, 0, 0, 0,
+                          0, y, 0, 0,
+                          0, 0, z, 0}};
+    }
+    // acc = acc * S: columns 0-2 scale.
+    constexpr void applyTo(Affine3x4& acc) const {
+        for (int i = 0; i < 3; ++i) {
+            acc(i, 0) *= x;
+            acc(i, 1) *= y;
+            acc(i, 2) *= z;
+        }
+    }
+};
+
+// Same matrices as rotX/rotY/rotZ. Two columns of the running transform are
+// replaced by their rotated combinations.
+struct RotationX {
+    float c{1}, s{0};
+
+    constexpr explicit RotationX(float radians) : RotationX(detail::sinCos(radians)) {}
+    constexpr explicit RotationX(detail::SinCos sc) : c(sc.c), s(sc.s) {}
+
+    constexpr Affine3x4 affine() const {
+        return Affine3x4{{1, 0, 0, 0,
+                          0, c, s, 0,
+                          0, -s, c, 0}};
+    }
+    constexpr void applyTo(Affine3x4& acc) const {
+        for (int i = 0; i < 3; ++i) {
+            const float a = acc(i, 1), b = acc(i, 2);
+            acc(i, 1) = a * c - b * s;
+            acc(i, 2) = a * s + b * c;
+        }
+    }
+};
+
+struct RotationY {
+    float c{1}, s{0};
+
+    constexpr explicit RotationY(float radians) : RotationY(detail::sinCos(radians)) {}
+    constexpr explicit RotationY(detail::SinCos sc) : c(sc.c), s(sc.s) {}
+
+    constexpr Affine3x4 affine() const {
+        return Affine3x4{{c, 0, -s, 0,
+                          0, 1, 0, 0,
+                          s, 0, c, 0}};
+    }
+    constexpr void applyTo(Affine3x4& acc) const {
+        for (int i = 0; i < 3; ++i) {
+            const float a = acc(i, 0), b = acc(i, 2);
+            acc(i, 0) = a * c + b * s;
+            acc(i, 2) = b * c - a * s;
+        }
+    }
+};
+
+struct RotationZ {
+    float c{1}, s{0};
+
+    constexpr explicit RotationZ(float radians) : RotationZ(detail::sinCos(radians)) {}
+    constexpr explicit RotationZ(detail::SinCos sc) : c(sc.c), s(sc.s) {}
+
+    constexpr Affine3x4 affine() const {
+        return Affine3x4{{c, s, 0, 0,
+                          -s, c, 0, 0,
+                          0, 0, 1, 0}};
+    }
+    constexpr void applyTo(Affine3x4& acc) const {
+        for (int i = 0; i < 3; ++i) {
+            const float a = acc(i, 0), b = acc(i, 1);
+            acc(i, 0) = a * c - b * s;
+            acc(i, 1) = a * s + b * c;
+        }
+    }
+};
+
+// Same matrix as reflect(): a scaling by -1 on the chosen axes.
+constexpr Scaling reflection(bool rx, bool ry, bool rz) {
+    return {rx ? -1.0f : 1.0f, ry ? -1.0f : 1.0f, rz ? -1.0f : 1.0f};
+}
+
+// l * r, evaluated left to right.
+template <TransformExpr L, TransformExpr R>
+struct Composed {
+    L l;
+    R r;
+
+    constexpr Affine3x4 affine() const {
+        Affine3x4 acc = l.affine();
+        r.applyTo(acc);
+        return acc;
+    }
+    constexpr void applyTo(Affine3x4& acc) const {
+        l.applyTo(acc);
+        r.applyTo(acc);
+    }
+    constexpr Mat4 mat4() const { return affine().toMat4(); }
+};
+
+template <TransformExpr L, TransformExpr R>
+constexpr Composed<L, R> operator*(const L& l, const R& r) {
+    return {l, r};
+}
+
+}
@@ -0,0 +1,142 @@
+#include "affine.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MATH3D_X86 1
+#include <emmintrin.h>
+#endif
+
+namespace math3d {
+
+Affine3x4 Affine3x4::translate(float dx, float dy, float dz) {
+    return {{1, 0, 0, dx,
+             0, 1, 0, dy,
+             0, 0, 1, dz}};
+}
+
+Affine3x4 Affine3x4::scale(float sx, float sy, float sz) {
+    return {{sx, 0, 0, 0,
+             0, sy, 0, 0,
+             0, 0, sz, 0}};
+}
+
+Affine3x4 Affine3x4::rotX(float a) {
+    const float c = static_cast<float>(cos(a));
+    const float s = static_cast<float>(sin(a));
+    return {{1, 0, 0, 0,
+             0, c, s, 0,
+             0, -s, c, 0}};
+}
+
+Affine3x4 Affine3x4::rotY(float a) {
+    const float c = static_cast<float>(cos(a));
+    const float s = static_cast<float>(sin(a));
+    return {{c, 0, -s, 0,
+             0, 1, 0, 0,
+             s, 0, c, 0}};
+}
+
+Affine3x4 Affine3x4::rotZ(float a) {
+    const float c = static_cast<float>(cos(a));
+    const float s = static_cast<float>(sin(a));
+    return {{c, s, 0, 0,
+             -s, c, 0, 0,
+             0, 0, 1, 0}};
+}
+
+Affine3x4 Affine3x4::reflect(bool rx, bool ry, bool rz) {
+    return scale(rx ? -1.0f : 1.0f, ry ? -1.0f : 1.0f, rz ? -1.0f : 1.0f);
+}
+
+Affine3x4 Affine3x4::fromMat4(const Mat4& m) {
+    if (!isAffine(m)) throw std::runtime_error("invalid affine matrix");
+    Affine3x4 a;
+    for (int i = 0; i < 12; ++i) a.m[i] = m.m[i];
+    return a;
+}
+
+bool operator==(const Affine3x4& A, const Affine3x4& B) {
+    for (int i = 0; i < 12; ++i)
+        if (A.m[i] != B.m[i]) return false;
+    return true;
+}
+
+namespace {
+
+// B's implicit bottom row. Multiplying by it rounds exactly like the Mat4 product.
+constexpr float kBottomRow[4] = {0, 0, 0, 1};
+
+// Row i of A * B: ((a0 * B.row0 + a1 * B.row1) + a2 * B.row2) + a3 * bottom. Written
+// out with SSE2, since compilers fully unroll the three-row loop and then fail to
+// vectorize it.
+inline void productRow(const float* a, const Affine3x4& B, float* out) {
+#if defined(MATH3D_X86)
+    __m128 r = _mm_mul_ps(_mm_set1_ps(a[0]), _mm_load_ps(B.m));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(a[1]), _mm_load_ps(B.m + 4)));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(a[2]), _mm_load_ps(B.m + 8)));
+    _mm_store_ps(out, _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(a[3]), _mm_loadu_ps(kBottomRow))));
+#else
+    for (int j = 0; j < 4; j++) out[j] = a[0] * B.m[j] + a[1] * B.m[4 + j] + a[2] * B.m[8 + j] + a[3] * kBottomRow[j];
+#endif
+}
+
+}
+
+Affine3x4 matMul(const Affine3x4& A, const Affine3x4& B) {
+    Affine3x4 R;
+    for (int i = 0; i < 3; i++) productRow(A.m + i * 4, B, R.m + i * 4);
+    return R;
+}
+
+Mat4 matMul(const Mat4& A, const Affine3x4& B) {
+    Mat4 R;
+    for (int i = 0; i < 4; i++) productRow(A.m + i * 4, B, R.m + i * 4);
+    return R;
+}
+
+Vertex mulMatVec(const Affine3x4& m, const Vertex& v) {
+    Vertex r;
+    r.x = m(0, 0) * v.x + m(0, 1) * v.y + m(0, 2) * v.z + m(0, 3) * v.w;
+    r.y = m(1, 0) * v.x + m(1, 1) * v.y + m(1, 2) * v.z + m(1, 3) * v.w;
+    r.z = m(2, 0) * v.x + m(2, 1) * v.y + m(2, 2) * v.z + m(2, 3) * v.w;
+    r.w = v.w;
+    return r;
+}
+
+Affine3x4 inverse(const Affine3x4& m) {
+    // Linear part: transposed cofactors over the determinant; translation: -L^-1 * t.
+    const float c00 = m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1);
+    const float c01 = m(1, 2) * m(2, 0) - m(1, 0) * m(2, 2);
+    const float c02 = m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0);
+    const float det = m(0, 0) * c00 + m(0, 1) * c01 + m(0, 2) * c02;
+    if (det == 0.0f || !std::isfinite(det)) throw std::runtime_error("invalid affine matrix: singular");
+    const float inv = 1.0f / det;
+
+    Affine3x4 r;
+    r(0, 0) = c00 * inv;
+    r(1, 0) = c01 * inv;
+    r(2, 0) = c02 * inv;
+    r(0, 1) = (m(0, 2) * m(2, 1) - m(0, 1) * m(2, 2)) * inv;
+    r(1, 1) = (m(0, 0) * m(2, 2) - m(0, 2) * m(2, 0)) * inv;
+    r(2, 1) = (m(0, 1) * m(2, 0) - m(0, 0) * m(2, 1)) * inv;
+    r(0, 2) = (m(0, 1) * m(1, 2) - m(0, 2) * m(1, 1)) * inv;
+    r(1, 2) = (m(0, 2) * m(1, 0) - m(0, 0) * m(1, 2)) * inv;
+    r(2, 2) = (m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0)) * inv;
+    for (int i = 0; i < 3; ++i)
+        r(i, 3) = -(r(i, 0) * m(0, 3) + r(i, 1) * m(1, 3) + r(i, 2) * m(2, 3));
+    return r;
+}
+
+void transformVertices(const Affine3x4& m, std::span<const Vertex> in, std::span<Vertex> out) {
+    // An AoS vertex is one 4-float vector, so the SIMD kernels get w in the same
+    // instructions as x, y and z; with the implicit row it comes out unchanged.
+    transformVertices(m.toMat4(), in, out);
+}
+
+void transformVertices(const Affine3x4& m, const VertexSoA& in, VertexSoA& out) {
+    transformVertices(m.toMat4(), in, out);
+}
+
+}
@@ -0,0 +1,36 @@
+#include "alloc_counter.hpp"
+
+#include <atomic>
+
+namespace math3d {
+
+namespace {
+
+// Constant-initialized, so allocations made before main() are counted too.
+std::atomic<bool> counting{false};
+std::atomic<std::uint64_t> allocations{0}, allocatedBytes{0};
+
+}
+
+bool heapCountingEnabled() {
+    return counting.load(std::memory_order_relaxed);
+}
+
+HeapStats heapStats() {
+    return {allocations.load(std::memory_order_relaxed), allocatedBytes.load(std::memory_order_relaxed)};
+}
+
+namespace detail {
+
+void enableHeapCounting() {
+    counting.store(true, std::memory_order_relaxed);
+}
+
+void countHeapAllocation(std::size_t bytes) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+}
+
+}
@@ -0,0 +1,55 @@
+// Replacement global operator new/delete that feed alloc_counter.hpp. Built as its own
+// object library and linked only where counting is wanted (see CMakeLists.txt). The
+// nothrow forms of the standard library forward to the ones below; the sized
+// deletes are defined here too, since the compiler calls them directly.
+#include <cstdlib>
+#include <new>
+
+#include "alloc_counter.hpp"
+
+namespace {
+
+[[maybe_unused]] const bool kInstalled = (math3d::detail::enableHeapCounting(), true);
+
+void* allocate(std::size_t size) {
+    math3d::detail::countHeapAllocation(size);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* allocateAligned(std::size_t size, std::align_val_t align) {
+    math3d::detail::countHeapAllocation(size);
+    const auto a = static_cast<std::size_t>(align);
+#if defined(_WIN32)
+    void* p = _aligned_malloc(size ? size : 1, a);
+#else
+    // aligned_alloc wants a multiple of the alignment.
+    void* p = std::aligned_alloc(a, size ? (size + a - 1) / a * a : a);
+#endif
+    if (p) return p;
+    throw std::bad_alloc();
+}
+
+void releaseAligned(void* p) noexcept {
+#if defined(_WIN32)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+}
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t align) { return allocateAligned(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align) { return allocateAligned(size, align); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { releaseAligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { releaseAligned(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { releaseAligned(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { releaseAligned(p); }
@@ -0,0 +1,58 @@
+#include "bounds.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace math3d {
+
+Bounds Bounds::of(std::span<const Vertex> vertices) {
+    Bounds b;
+    if (vertices.empty()) return b;
+    b.empty = false;
+    b.box.min = b.box.max = {vertices[0].x, vertices[0].y, vertices[0].z};
+    for (const auto& v : vertices) {
+        b.box.min = {std::min(b.box.min.x, v.x), std::min(b.box.min.y, v.y), std::min(b.box.min.z, v.z)};
+        b.box.max = {std::max(b.box.max.x, v.x), std::max(b.box.max.y, v.y), std::max(b.box.max.z, v.z)};
+    }
+    const Vertex c{(b.box.min.x + b.box.max.x) * 0.5f, (b.box.min.y + b.box.max.y) * 0.5f,
+                   (b.box.min.z + b.box.max.z) * 0.5f};
+    float r2 = 0.0f;
+    for (const auto& v : vertices) {
+        const Vertex d{v.x - c.x, v.y - c.y, v.z - c.z};
+        r2 = std::max(r2, dot(d, d));
+    }
+    b.sphere = {c, std::sqrt(r2)};
+    return b;
+}
+
+Frustum::Frustum(const Mat4& m) {
+    // Left/right, bottom/top, near/far: row 3 plus or minus rows 0, 1 and 2.
+    for (int p = 0; p < 6; ++p) {
+        const int row = p / 2;
+        const float sign = (p & 1) ? -1.0f : 1.0f;
+        for (int c = 0; c < 4; ++c) planes[p][c] = m(3, c) + sign * m(row, c);
+        const float len = std::sqrt(planes[p][0] * planes[p][0] + planes[p][1] * planes[p][1] + planes[p][2] * planes[p][2]);
+        // A degenerate projection leaves an all-zero plane, which rejects nothing.
+        if (len > 0.0f)
+            for (float& v : planes[p]) v /= len;
+    }
+}
+
+bool Frustum::outside(const BoundingSphere& s) const {
+    for (const auto& p : planes)
+        if (p[0] * s.center.x + p[1] * s.center.y + p[2] * s.center.z + p[3] < -s.radius) return true;
+    return false;
+}
+
+bool Frustum::outside(const Aabb& box) const {
+    // The box corner farthest along the plane normal; if even it is outside, all are.
+    for (const auto& p : planes) {
+        const float x = p[0] >= 0.0f ? box.max.x : box.min.x;
+        const float y = p[1] >= 0.0f ? box.max.y : box.min.y;
+        const float z = p[2] >= 0.0f ? box.max.z : box.min.z;
+        if (p[0] * x + p[1] * y + p[2] * z + p[3] < 0.0f) return true;
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,77 @@
+#include "frame_arena.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <new>
+
+namespace math3d {
+
+namespace {
+
+constexpr size_t kBlockAlign = alignof(std::max_align_t);
+
+constexpr size_t alignUp(size_t n, size_t a) {
+    return (n + a - 1) / a * a;
+}
+
+}
+
+FrameArena::FrameArena(size_t capacity, std::pmr::memory_resource* upstream)
+    : upstream(upstream), blockSize(std::max<size_t>(capacity, 256)) {
+    addBlock(blockSize);
+}
+
+FrameArena::~FrameArena() {
+    freeBlocks();
+}
+
+size_t FrameArena::capacity() const {
+    size_t n = 0;
+    for (const Block* b = head; b; b = b->next) n += b->size;
+    return n;
+}
+
+void FrameArena::addBlock(size_t size) {
+    void* p = upstream->allocate(size, kBlockAlign);
+    ++upstreamCalls;
+    head = ::new (p) Block{head, size, alignUp(sizeof(Block), kBlockAlign)};
+}
+
+void FrameArena::freeBlocks() {
+    while (head) {
+        Block* next = head->next;
+        upstream->deallocate(head, head->size, kBlockAlign);
+        head = next;
+    }
+}
+
+void* FrameArena::do_allocate(size_t bytes, size_t alignment) {
+    for (;;) {
+        const auto base = reinterpret_cast<std::uintptr_t>(head);
+        const std::uintptr_t start = alignUp(base + head->used, alignment);
+        if (start + bytes <= base + head->size) {
+            head->used = start + bytes - base;
+            usedBytes += bytes;
+            return reinterpret_cast<void*>(start);
+        }
+        // The rest of the current block is left unused until reset().
+        addBlock(std::max(blockSize, alignUp(sizeof(Block), kBlockAlign) + bytes + alignment));
+    }
+}
+
+void FrameArena::reset() {
+    size_t total = 0, blocks = 0;
+    for (const Block* b = head; b; b = b->next, ++blocks) total += b->used;
+    peakBytes = std::max(peakBytes, total);
+    usedBytes = 0;
+    if (blocks == 1) {
+        head->used = alignUp(sizeof(Block), kBlockAlign);
+        return;
+    }
+    // The frame overflowed: one block for all of it, with room for different padding.
+    freeBlocks();
+    blockSize = std::max(blockSize, std::bit_ceil(total + total / 8));
+    addBlock(blockSize);
+}
+
+}
@@ -0,0 +1,126 @@
+#include "frame_pipeline.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace math3d {
+
+void FrameSnapshot::capture(const Object& o) {
+    projViewModel = o.projViewModel;
+    useRoberts = o.useRoberts;
+    cpuProjection = o.cpuProjection;
+    culled = o.culled;
+    if (culled) return;
+
+    projected.resize(o.original.size());
+    if (o.cpuProjection) {
+        if (o.layout == VertexLayout::SoA) {
+            for (size_t i = 0; i < projected.size(); ++i) projected[i] = o.projectedAt(i);
+        } else {
+            std::copy(o.projected.begin(), o.projected.end(), projected.begin());
+        }
+    }
+    facing.assign(o.facing.begin(), o.facing.end());
+    faceDots.assign(o.faceDots.begin(), o.faceDots.end());
+    visibleEdges.assign(o.visibleEdges.begin(), o.visibleEdges.end());
+    meshVersion = o.meshVersion;
+    facingVersion = o.facingVersion;
+}
+
+void FrameMetrics::record(FrameClock::time_point submitted, FrameClock::time_point displayed) {
+    const size_t slot = static_cast<size_t>(count % latencies.size());
+    latencies[slot] = std::chrono::duration<double, std::milli>(displayed - submitted).count();
+    displays[slot] = displayed;
+    ++count;
+}
+
+double FrameMetrics::meanLatencyMs() const {
+    const size_t n = filled();
+    return n == 0 ? 0.0 : std::accumulate(latencies.begin(), latencies.begin() + n, 0.0) / n;
+}
+
+double FrameMetrics::maxLatencyMs() const {
+    const size_t n = filled();
+    return n == 0 ? 0.0 : *std::max_element(latencies.begin(), latencies.begin() + n);
+}
+
+double FrameMetrics::framesPerSecond() const {
+    const size_t n = filled();
+    if (n < 2) return 0.0;
+    const size_t newest = static_cast<size_t>((count - 1) % displays.size());
+    const size_t oldest = static_cast<size_t>((count - n) % displays.size());
+    const double seconds = std::chrono::duration<double>(displays[newest] - displays[oldest]).count();
+    return seconds > 0 ? (n - 1) / seconds : 0.0;
+}
+
+FramePipeline::FramePipeline(Object& o) : object(o), worker([this] { workerMain(); }) {}
+
+FramePipeline::~FramePipeline() {
+    stopping.store(true, std::memory_order_release);
+    inputSequence.fetch_add(1, std::memory_order_release);
+    inputSequence.notify_one();
+    worker.join();
+}
+
+void FramePipeline::submit(FrameInputs in) {
+    in.frame = ++submitted;
+    in.submitted = FrameClock::now();
+    inputs.back() = in;
+    inputs.publish();
+    inputSequence.fetch_add(1, std::memory_order_release);
+    inputSequence.notify_one();
+}
+
+const FrameSnapshot* FramePipeline::acquire() {
+    if (frames.update()) {
+        const FrameSnapshot& f = frames.front();
+        dropped += f.frame - lastDisplayed - 1;
+        lastDisplayed = f.frame;
+        haveFrame = newFrame = true;
+    }
+    return haveFrame ? &frames.front() : nullptr;
+}
+
+void FramePipeline::frameDrawn() {
+    if (!newFrame) return;
+    newFrame = false;
+    frameMetrics.record(frames.front().submitted, FrameClock::now());
+}
+
+void FramePipeline::flush() {
+    for (unsigned long long c = completedFrame.load(std::memory_order_acquire); c < submitted;
+         c = completedFrame.load(std::memory_order_acquire))
+        completedFrame.wait(c, std::memory_order_acquire);
+}
+
+void FramePipeline::workerMain() {
+    unsigned long long seen = 0;
+    for (;;) {
+        inputSequence.wait(seen, std::memory_order_acquire);
+        seen = inputSequence.load(std::memory_order_acquire);
+        if (stopping.load(std::memory_order_acquire)) return;
+        if (!inputs.update()) continue;
+
+        const FrameInputs& in = inputs.front();
+        object.setModel(in.model);
+        object.setView(in.view);
+        object.setProjection(in.projection);
+        object.useRoberts = in.useRoberts;
+        object.cpuProjection = in.cpuProjection;
+        object.setLayout(in.layout);
+        object.update();
+
+        FrameSnapshot& out = frames.back();
+        out.capture(object);
+        out.frame = in.frame;
+        out.submitted = in.submitted;
+        out.completed = FrameClock::now();
+        frames.publish();
+
+        producedCount.fetch_add(1, std::memory_order_relaxed);
+        completedFrame.store(in.frame, std::memory_order_release);
+        completedFrame.notify_all();
+    }
+}
+
+}
@@ -0,0 +1,298 @@
+#include "hidden_lines.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#include "profiler.hpp"
+#include "task_scheduler.hpp"
+
+namespace math3d {
+
+namespace {
+
+// A point counts as hidden only when it is this far (NDC units) inside every face
+// plane and behind the body. Edges lying on another body's surface, e.g. where two
+// boxes touch, therefore stay visible.
+constexpr float kEps = 1e-5f;
+// Visible pieces shorter than this (in edge parameter) are dropped.
+constexpr float kMinPiece = 1e-6f;
+// Fixed chunking of the edge list; it sets the output order, not the thread count.
+constexpr size_t kEdgeChunk = 1024;
+constexpr int kMaxGrid = 512;
+
+}
+
+void HiddenLineRemover::addBody(const Object& o, std::uint32_t body) {
+    const size_t n = o.original.size();
+    ndc.resize(n);
+    bool inFront = true;
+    for (size_t i = 0; i < n; ++i) {
+        const Vertex p = o.projectedAt(i);
+        inFront = inFront && p.w > 0.0f;
+        ndc[i] = {p.x / p.w, p.y / p.w, p.z / p.w};
+    }
+
+    const auto& bodyEdges = o.edges;
+    const auto addEdge = [&](size_t ei) {
+        const auto [a, b] = bodyEdges[ei];
+        if (o.projectedAt(a).w <= 0.0f || o.projectedAt(b).w <= 0.0f) return;
+        edges.push_back({ndc[a].x, ndc[a].y, ndc[a].z, ndc[b].x, ndc[b].y, ndc[b].z, body,
+                         static_cast<std::uint32_t>(ei)});
+    };
+    if (o.useRoberts) {
+        for (int ei : o.visibleEdges) addEdge(static_cast<size_t>(ei));
+    } else {
+        for (size_t ei = 0; ei < bodyEdges.size(); ++ei) addEdge(ei);
+    }
+
+    if (!o.useRoberts || o.planes.empty() || n == 0 || !inFront) return;
+
+    Vertex c{0, 0, 0};
+    Occluder oc{planes.size() / 4, 0, ndc[0].x, ndc[0].y, ndc[0].z, ndc[0].x, ndc[0].y, ndc[0].z};
+    for (const auto& v : ndc) {
+        c.x += v.x;
+        c.y += v.y;
+        c.z += v.z;
+        oc.minX = std::min(oc.minX, v.x);
+        oc.minY = std::min(oc.minY, v.y);
+        oc.minZ = std::min(oc.minZ, v.z);
+        oc.maxX = std::max(oc.maxX, v.x);
+        oc.maxY = std::max(oc.maxY, v.y);
+        oc.maxZ = std::max(oc.maxZ, v.z);
+    }
+    c = {c.x / n, c.y / n, c.z / n};
+
+    // Same construction as computeFaceNormals, but on the projected body: a convex
+    // body stays convex under a projective map that keeps it in front of the eye.
+    for (const auto& pl : o.planes) {
+        const auto& verts = pl.verts;
+        Vertex nrm{0, 0, 0}, fc{0, 0, 0};
+        for (size_t i = 0; i < verts.size(); ++i) {
+            const Vertex& cur = ndc[verts[i]];
+            const Vertex& nxt = ndc[verts[(i + 1) % verts.size()]];
+            nrm.x += (cur.y - nxt.y) * (cur.z + nxt.z);
+            nrm.y += (cur.z - nxt.z) * (cur.x + nxt.x);
+            nrm.z += (cur.x - nxt.x) * (cur.y + nxt.y);
+            fc.x += cur.x;
+            fc.y += cur.y;
+            fc.z += cur.z;
+        }
+        fc = {fc.x / verts.size(), fc.y / verts.size(), fc.z / verts.size()};
+        float len = std::sqrt(dot(nrm, nrm));
+        if (len == 0.0f || !std::isfinite(len)) continue;
+        if (dot(nrm, Vertex{fc.x - c.x, fc.y - c.y, fc.z - c.z}) < 0.0f) len = -len;
+        const float a = nrm.x / len, b = nrm.y / len, cz = nrm.z / len;
+        planes.insert(planes.end(), {a, b, cz, -(a * fc.x + b * fc.y + cz * fc.z)});
+        ++oc.planeCount;
+    }
+    if (oc.planeCount == 0) return;
+    occluders.push_back(oc);
+    occluderBody.push_back(body);
+}
+
+void HiddenLineRemover::buildGrid() {
+    const size_t n = occluders.size();
+    gridX = gridY = std::clamp(static_cast<int>(std::ceil(std::sqrt(static_cast<double>(n)))), 1, kMaxGrid);
+    gridMinX = gridMinY = 0.0f;
+    float maxX = 0.0f, maxY = 0.0f;
+    if (n != 0) {
+        gridMinX = occluders[0].minX;
+        gridMinY = occluders[0].minY;
+        maxX = occluders[0].maxX;
+        maxY = occluders[0].maxY;
+    }
+    for (const auto& oc : occluders) {
+        gridMinX = std::min(gridMinX, oc.minX);
+        gridMinY = std::min(gridMinY, oc.minY);
+        maxX = std::max(maxX, oc.maxX);
+        maxY = std::max(maxY, oc.maxY);
+    }
+    cellW = maxX > gridMinX ? (maxX - gridMinX) / gridX : 1.0f;
+    cellH = maxY > gridMinY ? (maxY - gridMinY) / gridY : 1.0f;
+
+    // Counting sort into CSR bins: count, prefix sum, fill, shift back.
+    const size_t cells = static_cast<size_t>(gridX) * gridY;
+    const auto forCells = [&](const Occluder& oc, auto&& fn) {
+        const int x0 = std::clamp(static_cast<int>((oc.minX - gridMinX) / cellW), 0, gridX - 1);
+        const int x1 = std::clamp(static_cast<int>((oc.maxX - gridMinX) / cellW), 0, gridX - 1);
+        const int y0 = std::clamp(static_cast<int>((oc.minY - gridMinY) / cellH), 0, gridY - 1);
+        const int y1 = std::clamp(static_cast<int>((oc.maxY - gridMinY) / cellH), 0, gridY - 1);
+        for (int y = y0; y <= y1; ++y)
+            for (int x = x0; x <= x1; ++x) fn(static_cast<size_t>(y) * gridX + x);
+    };
+    cellStart.assign(cells + 1, 0);
+    for (const auto& oc : occluders) forCells(oc, [&](size_t cell) { ++cellStart[cell + 1]; });
+    for (size_t i = 0; i < cells; ++i) cellStart[i + 1] += cellStart[i];
+    cellIndex.resize(cellStart[cells]);
+    for (size_t oi = 0; oi < n; ++oi)
+        forCells(occluders[oi], [&](size_t cell) { cellIndex[cellStart[cell]++] = static_cast<std::uint32_t>(oi); });
+    for (size_t i = cells; i > 0; --i) cellStart[i] = cellStart[i - 1];
+    cellStart[0] = 0;
+}
+
+// Roberts' test for one edge against one convex body. With the edge at
+// P(t) = P0 + t * (P1 - P0) and a point s units nearer the eye at P(t) - s * z, the
+// point of the edge at t is hidden when some s > 0 puts P(t) - s * z inside every
+// face plane. Each plane is one linear constraint in (t, s), so the hidden points
+// are the t-extent of a convex polygon: clip the box t in [0, 1], s in
+// (0, depth range] by every plane and take its smallest and largest t.
+bool HiddenLineRemover::hiddenInterval(const Edge& e, const Occluder& oc, Chunk& c, float& t0, float& t1) const {
+    const float sMax = std::max(e.z0, e.z1) - oc.minZ;
+    if (sMax <= kEps) return false;
+    const float dx = e.x1 - e.x0, dy = e.y1 - e.y0, dz = e.z1 - e.z0;
+
+    auto& poly = c.poly;
+    auto& out = c.clipped;
+    poly.assign({0.0f, kEps, 1.0f, kEps, 1.0f, sMax, 0.0f, sMax});
+    for (size_t pi = oc.firstPlane; pi < oc.firstPlane + oc.planeCount; ++pi) {
+        const float* pl = &planes[pi * 4];
+        const float p = pl[0] * e.x0 + pl[1] * e.y0 + pl[2] * e.z0 + pl[3] + kEps;
+        const float q = pl[0] * dx + pl[1] * dy + pl[2] * dz;
+        const float r = -pl[2];
+        // Sutherland-Hodgman against p + q*t + r*s <= 0.
+        out.clear();
+        const size_t count = poly.size() / 2;
+        for (size_t i = 0; i < count; ++i) {
+            const size_t j = (i + 1) % count;
+            const float ti = poly[2 * i], si = poly[2 * i + 1];
+            const float tj = poly[2 * j], sj = poly[2 * j + 1];
+            const float fi = p + q * ti + r * si, fj = p + q * tj + r * sj;
+            if (fi <= 0.0f) out.insert(out.end(), {ti, si});
+            if ((fi <= 0.0f) != (fj <= 0.0f)) {
+                const float k = fi / (fi - fj);
+                out.insert(out.end(), {ti + k * (tj - ti), si + k * (sj - si)});
+            }
+        }
+        poly.swap(out);
+        if (poly.size() < 6) return false;
+    }
+
+    t0 = 1.0f;
+    t1 = 0.0f;
+    for (size_t i = 0; i < poly.size(); i += 2) {
+        t0 = std::min(t0, poly[i]);
+        t1 = std::max(t1, poly[i]);
+    }
+    t0 = std::max(t0, 0.0f);
+    t1 = std::min(t1, 1.0f);
+    return t1 - t0 > kMinPiece;
+}
+
+void HiddenLineRemover::processEdges(Chunk& c, size_t begin, size_t end) const {
+    c.segments.clear();
+    c.candidatePairs = c.occludedPairs = 0;
+    for (size_t i = begin; i < end; ++i) {
+        const Edge& e = edges[i];
+        const float minX = std::min(e.x0, e.x1), maxX = std::max(e.x0, e.x1);
+        const float minY = std::min(e.y0, e.y1), maxY = std::max(e.y0, e.y1);
+        const float maxZ = std::max(e.z0, e.z1);
+
+        c.candidates.clear();
+        if (!occluders.empty()) {
+            const int x0 = std::clamp(static_cast<int>(std::floor((minX - gridMinX) / cellW)), 0, gridX - 1);
+            const int x1 = std::clamp(static_cast<int>(std::floor((maxX - gridMinX) / cellW)), 0, gridX - 1);
+            const int y0 = std::clamp(static_cast<int>(std::floor((minY - gridMinY) / cellH)), 0, gridY - 1);
+            const int y1 = std::clamp(static_cast<int>(std::floor((maxY - gridMinY) / cellH)), 0, gridY - 1);
+            for (int y = y0; y <= y1; ++y)
+                for (int x = x0; x <= x1; ++x) {
+                    const size_t cell = static_cast<size_t>(y) * gridX + x;
+                    c.candidates.insert(c.candidates.end(), cellIndex.begin() + cellStart[cell],
+                                        cellIndex.begin() + cellStart[cell + 1]);
+                }
+            std::sort(c.candidates.begin(), c.candidates.end());
+            c.candidates.erase(std::unique(c.candidates.begin(), c.candidates.end()), c.candidates.end());
+        }
+
+        c.hidden.clear();
+        for (std::uint32_t oi : c.candidates) {
+            const Occluder& oc = occluders[oi];
+            if (occluderBody[oi] == e.body) continue;  // convex: its own back faces are already culled
+            if (oc.maxX < minX || oc.minX > maxX || oc.maxY < minY || oc.minY > maxY) continue;
+            if (oc.minZ >= maxZ) continue;  // entirely behind the edge
+            ++c.candidatePairs;
+            float t0, t1;
+            if (hiddenInterval(e, oc, c, t0, t1)) {
+                ++c.occludedPairs;
+                c.hidden.emplace_back(t0, t1);
+            }
+        }
+
+        // The visible pieces are what the union of the hidden ranges leaves of [0, 1].
+        std::sort(c.hidden.begin(), c.hidden.end());
+        const auto emit = [&](float a, float b) {
+            if (b - a <= kMinPiece) return;
+            c.segments.push_back({e.x0 + a * (e.x1 - e.x0), e.y0 + a * (e.y1 - e.y0), e.z0 + a * (e.z1 - e.z0),
+                                  e.x0 + b * (e.x1 - e.x0), e.y0 + b * (e.y1 - e.y0), e.z0 + b * (e.z1 - e.z0),
+                                  e.body, e.edge});
+        };
+        float cursor = 0.0f;
+        for (const auto& [a, b] : c.hidden) {
+            if (a > cursor) emit(cursor, a);
+            cursor = std::max(cursor, b);
+        }
+        emit(cursor, 1.0f);
+    }
+}
+
+const std::vector<VisibleSegment>& HiddenLineRemover::compute(std::span<const Object* const> bodies,
+                                                              TaskScheduler* scheduler) {
+    ProfileScope profile("hidden lines");
+    planes.clear();
+    occluders.clear();
+    occluderBody.clear();
+    edges.clear();
+    for (size_t b = 0; b < bodies.size(); ++b) {
+        if (!bodies[b]->cpuProjection)
+            throw std::runtime_error("invalid object: hidden-line removal needs cpuProjection");
+        // Entirely outside the view volume: it neither shows nor hides anything on screen.
+        if (bodies[b]->culled) continue;
+        addBody(*bodies[b], static_cast<std::uint32_t>(b));
+    }
+    buildGrid();
+
+    const size_t chunkCount = (edges.size() + kEdgeChunk - 1) / kEdgeChunk;
+    if (chunks.size() < chunkCount) chunks.resize(chunkCount);
+    const auto run = [&](size_t first, size_t last) {
+        for (size_t ci = first; ci < last; ++ci)
+            processEdges(chunks[ci], ci * kEdgeChunk, std::min(edges.size(), (ci + 1) * kEdgeChunk));
+    };
+    if (scheduler) scheduler->parallelFor(chunkCount, 1, run);
+    else run(0, chunkCount);
+
+    result.clear();
+    lastStats = {};
+    lastStats.bodies = occluders.size();
+    lastStats.edges = edges.size();
+    for (size_t ci = 0; ci < chunkCount; ++ci) {
+        result.insert(result.end(), chunks[ci].segments.begin(), chunks[ci].segments.end());
+        lastStats.candidates += chunks[ci].candidatePairs;
+        lastStats.occluded += chunks[ci].occludedPairs;
+    }
+    lastStats.segments = result.size();
+    return result;
+}
+
+void writeSvg(const std::string& path, std::span<const VisibleSegment> segments, int width, int height,
+              float strokeWidth) {
+    if (width <= 0 || height <= 0) throw std::runtime_error("invalid svg size");
+    std::ofstream out(path);
+    if (!out) throw std::runtime_error("cannot write " + path);
+    out << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << width << "\" height=\"" << height
+        << "\" viewBox=\"0 0 " << width << ' ' << height << "\">\n"
+        << "<g fill=\"none\" stroke=\"black\" stroke-width=\"" << strokeWidth << "\" stroke-linecap=\"round\">\n";
+    char line[160];
+    for (const auto& s : segments) {
+        // Same mapping as glViewport, with y pointing down as SVG expects.
+        std::snprintf(line, sizeof line, "<line x1=\"%.3f\" y1=\"%.3f\" x2=\"%.3f\" y2=\"%.3f\"/>\n",
+                      (s.x0 + 1.0f) * 0.5f * width, (1.0f - s.y0) * 0.5f * height,
+                      (s.x1 + 1.0f) * 0.5f * width, (1.0f - s.y1) * 0.5f * height);
+        out << line;
+    }
+    out << "</g>\n</svg>\n";
+    if (!out) throw std::runtime_error("cannot write " + path);
+}
+
+}
@@ -0,0 +1,113 @@
+#include "instancing.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "profiler.hpp"
+#include "task_scheduler.hpp"
+
+namespace math3d {
+
+namespace {
+
+// Instances per parallel piece; a cube instance costs a few hundred flops.
+constexpr size_t kInstanceGrain = 4096;
+
+}
+
+InstancedObject::InstancedObject(Object& mesh) : shared(&mesh) {
+    prepareMesh();
+}
+
+void InstancedObject::prepareMesh() {
+    Object& o = *shared;
+    if (o.topologyDirty) o.buildTopology();
+    o.computeFaceNormals();
+    words = (o.planes.size() + 63) / 64;
+    meshBounds = Bounds::of(o.original);
+    preparedMesh = o.meshVersion;
+}
+
+size_t InstancedObject::add(const Mat4& model) {
+    models.push_back(model);
+    modelsDirty = true;
+    return models.size() - 1;
+}
+
+void InstancedObject::resize(size_t n, const Mat4& model) {
+    if (n == models.size()) return;
+    models.resize(n, model);
+    modelsDirty = true;
+}
+
+void InstancedObject::setModel(size_t instance, const Mat4& model) {
+    if (model == models[instance]) return;
+    models[instance] = model;
+    modelsDirty = true;
+}
+
+void InstancedObject::visibleEdges(size_t instance, std::vector<int>& out) const {
+    shared->topology.visibleEdges(facing(instance), out);
+}
+
+bool InstancedObject::update(TaskScheduler* scheduler) {
+    ++stats.updates;
+    if (preparedMesh != shared->meshVersion) {
+        prepareMesh();
+        modelsDirty = true;
+    }
+    if (!modelsDirty && !cameraDirty) {
+        ++stats.skipped;
+        return false;
+    }
+    ProfileScope profile("instances");
+
+    const size_t n = models.size();
+    pvm.resize(n);
+    facingBits.resize(n * words);
+    inside.resize(n);
+
+    const VertexSoA& normals = shared->faceNormals;
+    const size_t faces = shared->planes.size();
+    const Vertex toEye{-shared->viewDirection.x, -shared->viewDirection.y, -shared->viewDirection.z};
+    const auto body = [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            const Mat4& m = models[i];
+            std::uint64_t* bits = facingBits.data() + i * words;
+            std::fill(bits, bits + words, 0);
+
+            // Same products, in the same order, as Object::recompute.
+            const Mat4 vm = matMul(view, m);
+            pvm[i] = matMul(projection, vm);
+
+            // Planes taken back to object space through this instance's matrix, so the
+            // shared bounds are tested as they are, also under non-uniform scale.
+            const bool in = !Frustum(pvm[i]).outside(meshBounds);
+            inside[i] = in;
+            if (!in) continue;
+
+            // dot(N * n, toEye) == dot(n, N^T * toEye) with N the normal matrix.
+            const Mat4 nm = normalMatrix(vm);
+            const float ex = nm(0, 0) * toEye.x + nm(1, 0) * toEye.y + nm(2, 0) * toEye.z;
+            const float ey = nm(0, 1) * toEye.x + nm(1, 1) * toEye.y + nm(2, 1) * toEye.z;
+            const float ez = nm(0, 2) * toEye.x + nm(1, 2) * toEye.y + nm(2, 2) * toEye.z;
+            for (size_t f = 0; f < faces; ++f) {
+                const float d = normals.x[f] * ex + normals.y[f] * ey + normals.z[f] * ez;
+                bits[f >> 6] |= static_cast<std::uint64_t>(d > 0.0f) << (f & 63);
+            }
+        }
+    };
+    if (scheduler) scheduler->parallelFor(n, kInstanceGrain, body);
+    else body(0, n);
+
+    visibleIds.clear();
+    for (size_t i = 0; i < n; ++i)
+        if (inside[i]) visibleIds.push_back(static_cast<std::uint32_t>(i));
+
+    cull = {n, n - visibleIds.size(), visibleIds.size()};
+    stats.instancesUpdated += n;
+    modelsDirty = cameraDirty = false;
+    return true;
+}
+
+}
@@ -7,210 +7,586 @@
 #include <vector>
 #include <cmath>
 #include <algorithm>
-#include <sstream>
+#include <memory>
 #include <iomanip>
+#include <cstddef>
+#include <memory_resource>
+#include <span>
+#include <string>
 #include "math3d.hpp"
+#include "affine.hpp"
+#include "alloc_counter.hpp"
+#include "transform_expr.hpp"
+#include "object.hpp"
+#include "frame_arena.hpp"
+#include "frame_pipeline.hpp"
+#include "hidden_lines.hpp"
+#include "instancing.hpp"
+#include "mesh_cache.hpp"
+#include "profiler.hpp"
+#include "rotation.hpp"
+#include "scene_graph.hpp"
+#include "task_scheduler.hpp"
 
 using math3d::Vertex;
 using namespace math3d;
 
-struct Plane {
-    std::vector<int> verts;
-    std::vector<std::vector<int>> tris;  
-    float dot;
-    bool facing{true};
-};
+// Draw code reads the static mesh (original, edges, planes) from an Object and the
+// per-frame results from `f`, which is either that same Object or a FrameSnapshot
+// produced by the pipeline worker.
 
-class Object {
-public:
-    Vertex viewDirection{ 0, 0, -1 };
-    std::vector<Vertex> original, world, projected;
-    std::vector<std::pair<int,int>> edges;
-    std::vector<Plane> planes;
-    std::vector<std::vector<int>> edgeAdj;
-    
-    std::vector<std::vector<float>> model, view, projection;
-    Vertex center;
-    bool useRoberts{true};
-
-
-    Object() {
-        model = {{1,0,0,0},{0,1,0,0},{0,0,1,0},{0,0,0,1}};
-        view = model;
-        projection = model;
-    }
-
-    void recompute() {
-        auto VM = matMul(view, model);
-        world.resize(original.size());
-        projected.resize(original.size());
-        for (size_t i = 0; i < original.size(); ++i) {
-            world[i] = mulMatVec(VM, original[i]);
-            projected[i] = mulMatVec(projection, world[i]);
-        }
-        updateFaceFacingEye();
-        buildEdgeAdjacency();
-    }
-
-    void setModel(const std::vector<std::vector<float>>& m) { model = m; recompute(); }
-    void setView(const std::vector<std::vector<float>>& v) { view = v; recompute(); }
-    void setProjection(const std::vector<std::vector<float>>& p) { projection = p; recompute(); }
-
-    void updateFaceFacingEye() {
-        computeCenter();
-        for (auto &pl : planes) {
-            Vertex v0, v1, v2;
-            // if (!pl.tris.empty()) {
-            //     auto &tri = pl.tris[0];
-            //     v0 = world[tri[0]]; v1 = world[tri[1]]; v2 = world[tri[2]];
-            // } 
-            // else {
-                //if (pl.verts.size() < 3) { pl.facing = false; continue; }
-                //}
-            v0 = world[pl.verts[0]]; v1 = world[pl.verts[1]]; v2 = world[pl.verts[2]];
-            Vertex a{v1.x-v0.x, v1.y-v0.y, v1.z-v0.z};
-            Vertex b{v2.x-v0.x, v2.y-v0.y, v2.z-v0.z};
-            Vertex n;
-
-            Vertex toFace{v0.x - center.x, v0.y - center.y, v0.z - center.z};
-            if (dot(n, toFace) > 0.0f) {
-                n.x = -n.x; 
-                n.y = -n.y; 
-                n.z = -n.z;
+// Immediate mode: one glVertex call per vertex per frame from the CPU-projected
+// stream. Kept behind RenderBackend::Immediate for A/B comparison.
+template <typename Frame>
+void drawWireImmediate(const Object& o, const Frame& f) {
+    glBegin(GL_LINES);
+    glColor3f(1,1,1);
+    for (auto &e : o.edges) {
+        const Vertex v1 = f.projectedAt(e.first);
+        const Vertex v2 = f.projectedAt(e.second);
+        glVertex3f(v1.x,v1.y,v1.z);
+        glVertex3f(v2.x,v2.y,v2.z);
+    }
+    glEnd();
+}
+
+template <typename Frame>
+void drawRobertsImmediate(const Object& o, const Frame& f) {
+    glEnable(GL_DEPTH_TEST);
+    for (size_t pi = 0; pi < o.planes.size(); ++pi) {
+        const auto &pl = o.planes[pi];
+        if (!f.isFacing(pi)) continue;
+        if (!pl.tris.empty()) {
+            glBegin(GL_TRIANGLES);
+            glColor3f(0.3f,0.6f,0.9f);
+            for (auto &tri : pl.tris) {
+                for (int idx : tri) {
+                    const Vertex v = f.projectedAt(idx);
+                    glVertex3f(v.x,v.y,v.z);
+                }
             }
+            glEnd();
+
+        } else {
+            if (pl.verts.size()==3) glBegin(GL_TRIANGLES);
+            else glBegin(GL_POLYGON);
+            glColor3f(0.3f,0.6f,0.9f);
+            for (int idx : pl.verts) {
+                const Vertex v = f.projectedAt(idx);
+                glVertex3f(v.x,v.y,v.z);
+            }
+            glEnd();
 
-            n.x = a.y*b.z - a.z*b.y;
-            n.y = a.z*b.x - a.x*b.z;
-            n.z = a.x*b.y - a.y*b.x;
-        
-            pl.dot = dot(n, viewDirection);
-        
-            pl.facing = (pl.dot > 0.0f);
         }
     }
+    glDisable(GL_DEPTH_TEST);
+    glBegin(GL_LINES);
+    for (int ei : f.visibleEdges) {
+        const Vertex v1 = f.projectedAt(o.edges[ei].first);
+        const Vertex v2 = f.projectedAt(o.edges[ei].second);
+        glColor3f(1,1,1);
+        glVertex3f(v1.x,v1.y,v1.z);
+        glVertex3f(v2.x,v2.y,v2.z);
+    }
+    glEnd();
+}
 
-    void computeCenter() {
-        center = {0, 0, 0};
-        for (const auto& v : world) {
-            center.x += v.x;
-            center.y += v.y;
-            center.z += v.z;
-        }
-        if (!world.empty()) {
-            center.x /= world.size();
-            center.y /= world.size();
-            center.z /= world.size();
-        }
+GLuint compileShader(GLenum type, const char* src) {
+    GLuint sh = glCreateShader(type);
+    glShaderSource(sh, 1, &src, nullptr);
+    glCompileShader(sh);
+    GLint ok = GL_FALSE;
+    glGetShaderiv(sh, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[512];
+        glGetShaderInfoLog(sh, sizeof(log), nullptr, log);
+        std::cerr<<"shader compile failed: "<<log<<"\n";
     }
+    return sh;
+}
 
-    void buildEdgeAdjacency() {
-        edgeAdj.assign(edges.size(), {});
-        for (size_t pi = 0; pi < planes.size(); ++pi) {  
-            auto &pl = planes[pi];
-            for (size_t i = 0; i < pl.verts.size(); ++i) {
-                int a = pl.verts[i];
-                int b = pl.verts[(i+1)%pl.verts.size()];
-                for (size_t ei = 0; ei < edges.size(); ++ei) {
-                    int e1 = edges[ei].first, e2 = edges[ei].second;
-                    if ((e1==a && e2==b) || (e1==b && e2==a)) {
-                        edgeAdj[ei].push_back(pi);
-                        break;
-                    }
-                }
-            }
+// Retained mode for GL 2.1 / GLSL 1.20 (no VAOs, so it runs on Mesa llvmpipe).
+// Object-space positions and topology are uploaded once; the vertex shader applies
+// projViewModel, so the CPU never projects. Only the index lists of visible faces
+// and edges are re-uploaded, and only when facing changes: two draw calls per
+// Roberts object, one per wireframe object.
+class GpuMesh {
+public:
+    GpuMesh() = default;
+    GpuMesh(const GpuMesh&) = delete;
+    GpuMesh& operator=(const GpuMesh&) = delete;
+
+    template <typename Frame>
+    void draw(const Object& o, const Frame& f) {
+        if (uploadedMesh != f.meshVersion) upload(o, f.meshVersion);
+        if (f.useRoberts && uploadedFacing != f.facingVersion) uploadVisible(o, f);
+
+        const Program& p = program();
+        glUseProgram(p.id);
+        glUniformMatrix4fv(p.pvm, 1, GL_TRUE, f.projViewModel.m);
+        glBindBuffer(GL_ARRAY_BUFFER, positions);
+        glEnableVertexAttribArray(p.position);
+        glVertexAttribPointer(p.position, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), nullptr);
+
+        if (f.useRoberts) {
+            glEnable(GL_DEPTH_TEST);
+            glUniform3f(p.color, 0.3f, 0.6f, 0.9f);
+            drawIndexed(GL_TRIANGLES, visibleTris, visibleTriCount);
+            glDisable(GL_DEPTH_TEST);
+            glUniform3f(p.color, 1, 1, 1);
+            drawIndexed(GL_LINES, visibleLines, visibleLineCount);
+        } else {
+            glUniform3f(p.color, 1, 1, 1);
+            drawIndexed(GL_LINES, allLines, allLineCount);
         }
+
+        glDisableVertexAttribArray(p.position);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        glUseProgram(0);
     }
 
+    // Must run while the GL context is still current.
+    void release() {
+        const GLuint buffers[] = {positions, allLines, visibleTris, visibleLines};
+        glDeleteBuffers(4, buffers);
+        positions = allLines = visibleTris = visibleLines = 0;
+        uploadedMesh = uploadedFacing = ~0ull;
+    }
+
+private:
+    struct Program {
+        GLuint id{};
+        GLint pvm{}, color{};
+        GLuint position{};
+    };
 
-    void draw() {
-        if (useRoberts) drawRoberts(); else drawWire();
+    static const Program& program() {
+        static const Program p = [] {
+            const char* vs =
+                "#version 120\n"
+                "uniform mat4 uPVM;\n"
+                "attribute vec4 aPosition;\n"
+                "void main() { gl_Position = uPVM * aPosition; }\n";
+            const char* fs =
+                "#version 120\n"
+                "uniform vec3 uColor;\n"
+                "void main() { gl_FragColor = vec4(uColor, 1.0); }\n";
+            Program r;
+            r.id = glCreateProgram();
+            const GLuint v = compileShader(GL_VERTEX_SHADER, vs);
+            const GLuint f = compileShader(GL_FRAGMENT_SHADER, fs);
+            glAttachShader(r.id, v);
+            glAttachShader(r.id, f);
+            glBindAttribLocation(r.id, 0, "aPosition");
+            glLinkProgram(r.id);
+            glDeleteShader(v);
+            glDeleteShader(f);
+            r.pvm = glGetUniformLocation(r.id, "uPVM");
+            r.color = glGetUniformLocation(r.id, "uColor");
+            r.position = 0;
+            return r;
+        }();
+        return p;
     }
 
-    void drawWire() {
-        glBegin(GL_LINES);
-        glColor3f(1,1,1);
-        for (auto &e : edges) {
-            auto &v1 = projected[e.first];
-            auto &v2 = projected[e.second];
-            glVertex3f(v1.x,v1.y,v1.z);
-            glVertex3f(v2.x,v2.y,v2.z);
-        }
-        glEnd();
+    static void drawIndexed(GLenum mode, GLuint ibo, GLsizei count) {
+        if (count == 0) return;
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+        glDrawElements(mode, count, GL_UNSIGNED_INT, nullptr);
     }
 
-    void drawRoberts() {
-        glEnable(GL_DEPTH_TEST);
-        for (auto &pl : planes) {
-            if (!pl.facing) continue;
-            if (!pl.tris.empty()) {
-                glBegin(GL_TRIANGLES);
-                glColor3f(0.3f,0.6f,0.9f);
-                for (auto &tri : pl.tris) {
-                    for (int idx : tri) {
-                        auto &v = projected[idx];
-                        glVertex3f(v.x,v.y,v.z);
-                    }
-                }
-                glEnd();
+    static void fill(GLenum target, GLuint& buffer, const void* data, size_t bytes, GLenum usage) {
+        if (!buffer) glGenBuffers(1, &buffer);
+        glBindBuffer(target, buffer);
+        glBufferData(target, static_cast<GLsizeiptr>(bytes), data, usage);
+        glBindBuffer(target, 0);
+    }
+
+    // Positions, all edges and the per-face triangle lists (explicit tris, otherwise
+    // a fan, which matches GL_POLYGON for the convex faces we draw).
+    void upload(const Object& o, unsigned long long meshVersion) {
+        fill(GL_ARRAY_BUFFER, positions, o.original.data(), o.original.size() * sizeof(Vertex), GL_STATIC_DRAW);
 
+        scratch.clear();
+        for (const auto& e : o.edges) {
+            scratch.push_back(e.first);
+            scratch.push_back(e.second);
+        }
+        fill(GL_ELEMENT_ARRAY_BUFFER, allLines, scratch.data(), scratch.size() * sizeof(GLuint), GL_STATIC_DRAW);
+        allLineCount = static_cast<GLsizei>(scratch.size());
+
+        faceTriOffsets.assign(1, 0);
+        triIndices.clear();
+        for (const auto& pl : o.planes) {
+            if (!pl.tris.empty()) {
+                for (const auto& tri : pl.tris) triIndices.insert(triIndices.end(), tri.begin(), tri.end());
             } else {
-                if (pl.verts.size()==3) glBegin(GL_TRIANGLES);
-                else glBegin(GL_POLYGON);
-                glColor3f(0.3f,0.6f,0.9f);
-                for (int idx : pl.verts) {
-                    auto &v = projected[idx];
-                    glVertex3f(v.x,v.y,v.z);
+                for (size_t i = 1; i + 1 < pl.verts.size(); ++i) {
+                    triIndices.push_back(pl.verts[0]);
+                    triIndices.push_back(pl.verts[i]);
+                    triIndices.push_back(pl.verts[i + 1]);
                 }
-                glEnd();
+            }
+            faceTriOffsets.push_back(static_cast<GLuint>(triIndices.size()));
+        }
+
+        uploadedMesh = meshVersion;
+        uploadedFacing = ~0ull;
+    }
+
+    template <typename Frame>
+    void uploadVisible(const Object& o, const Frame& frame) {
+        scratch.clear();
+        for (size_t f = 0; f < o.planes.size(); ++f) {
+            if (!frame.isFacing(f)) continue;
+            scratch.insert(scratch.end(), triIndices.begin() + faceTriOffsets[f], triIndices.begin() + faceTriOffsets[f + 1]);
+        }
+        fill(GL_ELEMENT_ARRAY_BUFFER, visibleTris, scratch.data(), scratch.size() * sizeof(GLuint), GL_STREAM_DRAW);
+        visibleTriCount = static_cast<GLsizei>(scratch.size());
+
+        scratch.clear();
+        for (int ei : frame.visibleEdges) {
+            scratch.push_back(o.edges[ei].first);
+            scratch.push_back(o.edges[ei].second);
+        }
+        fill(GL_ELEMENT_ARRAY_BUFFER, visibleLines, scratch.data(), scratch.size() * sizeof(GLuint), GL_STREAM_DRAW);
+        visibleLineCount = static_cast<GLsizei>(scratch.size());
+
+        uploadedFacing = frame.facingVersion;
+    }
 
+    GLuint positions{}, allLines{}, visibleTris{}, visibleLines{};
+    GLsizei allLineCount{}, visibleTriCount{}, visibleLineCount{};
+    std::vector<GLuint> faceTriOffsets, triIndices, scratch;
+    unsigned long long uploadedMesh{~0ull}, uploadedFacing{~0ull};
+};
+
+// All instances of an InstancedObject in two instanced draw calls (faces, then
+// edges) when the driver has GL 3.3 or ARB_instanced_arrays + ARB_draw_instanced;
+// the per-instance projViewModel goes in as four vec4 attributes with divisor 1,
+// followed by the instance's facing bits. On plain GL 2.1 it falls back to uniform
+// updates and two draws per instance over the same buffers. Either way the mesh is
+// uploaded once and only the data of visible instances moves per frame.
+//
+// Faces are drawn from a copy of the triangles with one vertex per corner, each
+// tagged with its face, so the vertex shader can drop the faces the batch facing
+// test found turned away: a back face collapses to a degenerate triangle. Edges
+// are depth-tested against the front faces (polygon offset), which hides the same
+// edges the per-instance facing would, and edges behind other instances too.
+class GpuInstances {
+public:
+    GpuInstances() = default;
+    GpuInstances(const GpuInstances&) = delete;
+    GpuInstances& operator=(const GpuInstances&) = delete;
+
+    // The per-instance data is staged in `frame`, which only has to outlive the upload.
+    void draw(const InstancedObject& batch, std::pmr::memory_resource& frame) {
+        const Object& o = batch.mesh();
+        if (uploadedMesh != o.meshVersion) upload(o);
+        const auto visible = batch.visible();
+        if (visible.empty()) return;
+
+        const bool instanced = supported();
+        const Program& p = instanced ? instancedProgram() : program();
+        glUseProgram(p.id);
+        glEnableVertexAttribArray(p.position);
+        if (instanced) {
+            std::pmr::vector<InstanceData> data(visible.size(), &frame);
+            for (size_t k = 0; k < visible.size(); ++k) {
+                data[k].pvm = batch.projViewModel(visible[k]);
+                packFacing(batch.facing(visible[k]), data[k].facing);
+            }
+            if (!instanceBuffer) glGenBuffers(1, &instanceBuffer);
+            glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+            glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(data.size() * sizeof(InstanceData)), data.data(), GL_STREAM_DRAW);
+            for (GLuint row = 0; row < 4; ++row) {
+                glEnableVertexAttribArray(p.pvmRows + row);
+                glVertexAttribPointer(p.pvmRows + row, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                                      reinterpret_cast<const void*>(row * 4 * sizeof(float)));
+                divisor(p.pvmRows + row, 1);
             }
+            glEnableVertexAttribArray(p.facing);
+            glVertexAttribPointer(p.facing, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                                  reinterpret_cast<const void*>(offsetof(InstanceData, facing)));
+            divisor(p.facing, 1);
         }
+
+        const auto pass = [&](float r, float g, float b, const auto& submit) {
+            glUniform3f(p.color, r, g, b);
+            if (instanced) {
+                submit(static_cast<GLsizei>(visible.size()));
+                return;
+            }
+            for (std::uint32_t i : visible) {
+                float facing[4];
+                packFacing(batch.facing(i), facing);
+                glUniformMatrix4fv(p.pvm, 1, GL_TRUE, batch.projViewModel(i).m);
+                glUniform4fv(p.facingMask, 1, facing);
+                submit(1);
+            }
+        };
+
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LEQUAL);
+        if (faceVertexCount) {
+            glBindBuffer(GL_ARRAY_BUFFER, faceVertices);
+            glVertexAttribPointer(p.position, 4, GL_FLOAT, GL_FALSE, sizeof(FaceVertex), nullptr);
+            glEnableVertexAttribArray(p.face);
+            glVertexAttribPointer(p.face, 1, GL_FLOAT, GL_FALSE, sizeof(FaceVertex),
+                                  reinterpret_cast<const void*>(offsetof(FaceVertex, face)));
+            glEnable(GL_POLYGON_OFFSET_FILL);
+            glPolygonOffset(1.0f, 1.0f);
+            pass(0.3f, 0.6f, 0.9f, [&](GLsizei instances) {
+                if (instanced) drawArraysInstanced(GL_TRIANGLES, faceVertexCount, instances);
+                else glDrawArrays(GL_TRIANGLES, 0, faceVertexCount);
+            });
+            glDisable(GL_POLYGON_OFFSET_FILL);
+            glDisableVertexAttribArray(p.face);
+        }
+        if (lineCount) {
+            // Indexed over the shared positions; a negative face is never dropped.
+            glBindBuffer(GL_ARRAY_BUFFER, positions);
+            glVertexAttribPointer(p.position, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), nullptr);
+            glVertexAttrib1f(p.face, -1.0f);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, lines);
+            pass(1, 1, 1, [&](GLsizei instances) {
+                if (instanced) drawInstanced(GL_LINES, lineCount, instances);
+                else glDrawElements(GL_LINES, lineCount, GL_UNSIGNED_INT, nullptr);
+            });
+        }
+        glDepthFunc(GL_LESS);
         glDisable(GL_DEPTH_TEST);
-        glBegin(GL_LINES);
-        for (size_t ei=0; ei<edges.size(); ++ei) {
-            bool vis=false;
-            for (int pi : edgeAdj[ei]) {
-                if (planes[pi].facing) { vis=true; break; }
+
+        if (instanced) {
+            for (GLuint row = 0; row < 4; ++row) {
+                divisor(p.pvmRows + row, 0);
+                glDisableVertexAttribArray(p.pvmRows + row);
             }
-            if (!vis) continue;
-            auto &v1 = projected[edges[ei].first];
-            auto &v2 = projected[edges[ei].second];
-            glColor3f(1,1,1);
-            glVertex3f(v1.x,v1.y,v1.z);
-            glVertex3f(v2.x,v2.y,v2.z);
+            divisor(p.facing, 0);
+            glDisableVertexAttribArray(p.facing);
         }
-        glEnd();
+        glDisableVertexAttribArray(p.position);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        glUseProgram(0);
+    }
+
+    // Must run while the GL context is still current.
+    void release() {
+        const GLuint buffers[] = {positions, faceVertices, lines, instanceBuffer};
+        glDeleteBuffers(4, buffers);
+        positions = faceVertices = lines = instanceBuffer = 0;
+        uploadedMesh = ~0ull;
     }
-};
 
-Object initCube()
-{
-    Object o;
-    o.original = {
-        make_vertex(-0.2f, -0.2f, -0.2f),
-        make_vertex( 0.2f, -0.2f, -0.2f),
-        make_vertex( 0.2f,  0.2f, -0.2f),
-        make_vertex(-0.2f,  0.2f, -0.2f),
-        make_vertex(-0.2f, -0.2f,  0.2f),
-        make_vertex( 0.2f, -0.2f,  0.2f),
-        make_vertex( 0.2f,  0.2f,  0.2f),
-        make_vertex(-0.2f,  0.2f,  0.2f)
+private:
+    // Faces past this count are always drawn: their bits do not fit in aFacing.
+    static constexpr size_t kMaskedFaces = 96;
+
+    struct FaceVertex {
+        Vertex position;
+        float face;  // -1 when the mesh has too many faces to mask
+    };
+    struct InstanceData {
+        Mat4 pvm;
+        float facing[4];
     };
 
-    o.edges = {
-        {0,1},{1,2},{2,3},{3,0},
-        {4,5},{5,6},{6,7},{7,4},
-        {0,4},{1,5},{2,6},{3,7}
+    struct Program {
+        GLuint id{};
+        GLint pvm{-1}, color{}, facingMask{-1};
+        GLuint position{}, pvmRows{}, face{}, facing{};
+    };
+
+    static bool supported() {
+        return GLAD_GL_VERSION_3_3 || (GLAD_GL_ARB_instanced_arrays && GLAD_GL_ARB_draw_instanced);
+    }
+    static void divisor(GLuint attribute, GLuint d) {
+        if (GLAD_GL_VERSION_3_3) glVertexAttribDivisor(attribute, d);
+        else glVertexAttribDivisorARB(attribute, d);
+    }
+    static void drawInstanced(GLenum mode, GLsizei count, GLsizei instances) {
+        if (GLAD_GL_VERSION_3_3) glDrawElementsInstanced(mode, count, GL_UNSIGNED_INT, nullptr, instances);
+        else glDrawElementsInstancedARB(mode, count, GL_UNSIGNED_INT, nullptr, instances);
+    }
+    static void drawArraysInstanced(GLenum mode, GLsizei count, GLsizei instances) {
+        if (GLAD_GL_VERSION_3_3) glDrawArraysInstanced(mode, 0, count, instances);
+        else glDrawArraysInstancedARB(mode, 0, count, instances);
+    }
+
+    // Facing bits of faces [24k, 24k + 24) as out[k]: a float holds 24 bits exactly,
+    // and GLSL 1.20 has neither integer attributes nor bit operations.
+    static void packFacing(std::span<const std::uint64_t> bits, float out[4]) {
+        for (size_t k = 0; k < 4; ++k) {
+            const size_t first = 24 * k, word = first >> 6, shift = first & 63;
+            std::uint64_t v = word < bits.size() ? bits[word] >> shift : 0;
+            if (shift > 40 && word + 1 < bits.size()) v |= bits[word + 1] << (64 - shift);
+            out[k] = static_cast<float>(v & 0xffffff);
+        }
+    }
+
+    static Program link(const char* vs, bool perInstance) {
+        const char* fs =
+            "#version 120\n"
+            "uniform vec3 uColor;\n"
+            "void main() { gl_FragColor = vec4(uColor, 1.0); }\n";
+        Program r;
+        r.id = glCreateProgram();
+        const GLuint v = compileShader(GL_VERTEX_SHADER, vs);
+        const GLuint f = compileShader(GL_FRAGMENT_SHADER, fs);
+        glAttachShader(r.id, v);
+        glAttachShader(r.id, f);
+        glBindAttribLocation(r.id, 0, "aPosition");
+        glBindAttribLocation(r.id, 5, "aFace");
+        if (perInstance) {
+            const char* rows[] = {"aPvm0", "aPvm1", "aPvm2", "aPvm3"};
+            for (GLuint i = 0; i < 4; ++i) glBindAttribLocation(r.id, 1 + i, rows[i]);
+            glBindAttribLocation(r.id, 6, "aFacing");
+        }
+        glLinkProgram(r.id);
+        glDeleteShader(v);
+        glDeleteShader(f);
+        r.pvm = glGetUniformLocation(r.id, "uPVM");
+        r.color = glGetUniformLocation(r.id, "uColor");
+        r.facingMask = glGetUniformLocation(r.id, "uFacing");
+        r.position = 0;
+        r.pvmRows = 1;
+        r.face = 5;
+        r.facing = 6;
+        return r;
+    }
+
+    // Keeps p when bit aFace of the 4 x 24 facing bits is set, or when aFace < 0.
+    static constexpr const char* kFacingTest =
+        "attribute float aFace;\n"
+        "vec4 facingOnly(vec4 p, vec4 facing) {\n"
+        "    if (aFace < 0.0) return p;\n"
+        "    float word = dot(facing, vec4(equal(vec4(floor(aFace / 24.0)), vec4(0.0, 1.0, 2.0, 3.0))));\n"
+        "    return mod(floor(word / exp2(mod(aFace, 24.0))), 2.0) > 0.5 ? p : vec4(0.0);\n"
+        "}\n";
+
+    static const Program& program() {
+        static const Program p = link((std::string(
+            "#version 120\n"
+            "uniform mat4 uPVM;\n"
+            "uniform vec4 uFacing;\n"
+            "attribute vec4 aPosition;\n") + kFacingTest +
+            "void main() { gl_Position = facingOnly(uPVM * aPosition, uFacing); }\n").c_str(), false);
+        return p;
+    }
+
+    // Mat4 is row-major, so its rows become the columns of the GLSL matrix, i.e. the
+    // transpose; multiplying from the left undoes that.
+    static const Program& instancedProgram() {
+        static const Program p = link((std::string(
+            "#version 120\n"
+            "attribute vec4 aPosition;\n"
+            "attribute vec4 aPvm0, aPvm1, aPvm2, aPvm3;\n"
+            "attribute vec4 aFacing;\n") + kFacingTest +
+            "void main() { gl_Position = facingOnly(aPosition * mat4(aPvm0, aPvm1, aPvm2, aPvm3), aFacing); }\n").c_str(), true);
+        return p;
+    }
+
+    static void fill(GLenum target, GLuint& buffer, const void* data, size_t bytes) {
+        if (!buffer) glGenBuffers(1, &buffer);
+        glBindBuffer(target, buffer);
+        glBufferData(target, static_cast<GLsizeiptr>(bytes), data, GL_STATIC_DRAW);
+        glBindBuffer(target, 0);
+    }
+
+    void upload(const Object& o) {
+        fill(GL_ARRAY_BUFFER, positions, o.original.data(), o.original.size() * sizeof(Vertex));
+        const bool masked = o.planes.size() <= kMaskedFaces;
+        std::vector<FaceVertex> corners;
+        for (size_t f = 0; f < o.planes.size(); ++f) {
+            const Plane& pl = o.planes[f];
+            const float face = masked ? static_cast<float>(f) : -1.0f;
+            if (!pl.tris.empty()) {
+                for (const auto& tri : pl.tris)
+                    for (int vi : tri) corners.push_back({o.original[vi], face});
+            } else {
+                for (size_t i = 1; i + 1 < pl.verts.size(); ++i)
+                    for (int vi : {pl.verts[0], pl.verts[i], pl.verts[i + 1]}) corners.push_back({o.original[vi], face});
+            }
+        }
+        fill(GL_ARRAY_BUFFER, faceVertices, corners.data(), corners.size() * sizeof(FaceVertex));
+        faceVertexCount = static_cast<GLsizei>(corners.size());
+        std::vector<GLuint> indices;
+        for (const auto& e : o.edges) indices.insert(indices.end(), {static_cast<GLuint>(e.first), static_cast<GLuint>(e.second)});
+        fill(GL_ELEMENT_ARRAY_BUFFER, lines, indices.data(), indices.size() * sizeof(GLuint));
+        lineCount = static_cast<GLsizei>(indices.size());
+        uploadedMesh = o.meshVersion;
+    }
+
+    GLuint positions{}, faceVertices{}, lines{}, instanceBuffer{};
+    GLsizei faceVertexCount{}, lineCount{};
+    unsigned long long uploadedMesh{~0ull};
+};
+
+// Immediate-mode counterpart for A/B comparison: projects every visible instance on
+// the CPU and draws only its facing faces and visible edges, like drawRobertsImmediate.
+// `edges` is scratch for the edge lists, kept by the caller between frames.
+void drawInstancesImmediate(const InstancedObject& batch, std::vector<int>& edges) {
+    const Object& o = batch.mesh();
+    const auto corner = [&](const Mat4& pvm, int idx) {
+        const Vertex v = mulMatVec(pvm, o.original[idx]);
+        glVertex4f(v.x,v.y,v.z,v.w);
     };
+    glEnable(GL_DEPTH_TEST);
+    glColor3f(0.3f,0.6f,0.9f);
+    glBegin(GL_TRIANGLES);
+    for (std::uint32_t i : batch.visible()) {
+        const Mat4& pvm = batch.projViewModel(i);
+        for (size_t pi = 0; pi < o.planes.size(); ++pi) {
+            if (!batch.isFacing(i, pi)) continue;
+            const Plane& pl = o.planes[pi];
+            if (!pl.tris.empty()) {
+                for (const auto& tri : pl.tris)
+                    for (int idx : tri) corner(pvm, idx);
+            } else {
+                for (size_t k = 1; k + 1 < pl.verts.size(); ++k)
+                    for (int idx : {pl.verts[0], pl.verts[k], pl.verts[k + 1]}) corner(pvm, idx);
+            }
+        }
+    }
+    glEnd();
+    glDisable(GL_DEPTH_TEST);
+    glBegin(GL_LINES);
+    glColor3f(1,1,1);
+    for (std::uint32_t i : batch.visible()) {
+        const Mat4& pvm = batch.projViewModel(i);
+        batch.visibleEdges(i, edges);
+        for (int ei : edges) {
+            const Vertex v1 = mulMatVec(pvm, o.original[o.edges[ei].first]);
+            const Vertex v2 = mulMatVec(pvm, o.original[o.edges[ei].second]);
+            glVertex4f(v1.x,v1.y,v1.z,v1.w);
+            glVertex4f(v2.x,v2.y,v2.z,v2.w);
+        }
+    }
+    glEnd();
+}
+
+enum class RenderBackend { Immediate, Buffered };
 
-    o.planes.push_back({{0,1,2,3},{}});
-    o.planes.push_back({{4,7,6,5},{}});
-    o.planes.push_back({{0,4,5,1},{}});
-    o.planes.push_back({{2,6,7,3},{}});
-    o.planes.push_back({{0,3,7,4},{}});
-    o.planes.push_back({{1,5,6,2},{}});
-    
-    return o;
+// The immediate backend needs the CPU-projected stream, the buffered one projects on the GPU.
+bool needsCpuProjection(RenderBackend backend) { return backend == RenderBackend::Immediate; }
+
+template <typename Frame>
+void drawObject(const Object& o, const Frame& f, GpuMesh& gpu, RenderBackend backend) {
+    if (f.culled) return;
+    if (backend == RenderBackend::Buffered) {
+        gpu.draw(o, f);
+        return;
+    }
+    if (f.useRoberts) drawRobertsImmediate(o, f); else drawWireImmediate(o, f);
+}
+
+// Sequential mode: update on the render thread, then draw the Object itself.
+void updateAndDraw(Object& o, GpuMesh& gpu, RenderBackend backend) {
+    o.cpuProjection = needsCpuProjection(backend);
+    o.update();
+    drawObject(o, o, gpu, backend);
 }
 
 // Object initLetterK() {
@@ -280,15 +656,6 @@ Object initCube()
 //     return o;
 // }
 
-Object initAxes() {
-    Object a;
-    a.original = { make_vertex(0,0,0), make_vertex(2,0,0),
-                   make_vertex(0,2,0), make_vertex(0,0,2) };
-    a.edges = {{0,1},{0,2},{0,3}};
-    a.useRoberts = false;
-    return a;
-}
-
 class Controller {
     Object &obj;
 
@@ -312,16 +679,17 @@ class Controller {
 public:
     Controller(Object &o): obj(o), animationParam(&px, &rz) {}
 
-    std::vector<std::vector<float>> posSliders() {
+    // Transform expressions; main() evaluates the whole model chain at once.
+    Translation posSliders() {
         ImGui::BeginChild("position");
         ImGui::Text("Position");
         ImGui::SliderFloat("X", &px, -1.0f, 1.0f, "%.3f");
         ImGui::SliderFloat("Y", &py, -1.0f, 1.0f, "%.3f");
         ImGui::SliderFloat("Z", &pz, -1.0f, 1.0f, "%.3f");
         ImGui::EndChild(); ImGui::Separator();
-        return translate(px,py,pz);
+        return {px,py,pz};
     }
-    std::vector<std::vector<float>> scaleSliders() {
+    Scaling scaleSliders() {
         ImGui::BeginChild("scale");
         ImGui::Text("Scale");
         static float sx=1, sy=1, sz=1;
@@ -329,23 +697,20 @@ public:
         ImGui::SliderFloat("Y", &sy, 0.01f, 5.0f, "%.2f");
         ImGui::SliderFloat("Z", &sz, 0.01f, 5.0f, "%.2f");
         ImGui::EndChild(); ImGui::Separator();
-        return scaleMat(sx,sy,sz);
+        return {sx,sy,sz};
     }
 
-    std::vector<std::vector<float>> rotateSliders() {
+    EulerXYZ rotateSliders() {
         ImGui::BeginChild("rotate");
         ImGui::Text("Rotate");
         ImGui::SliderFloat("X", &rx, -180.0f, 180.0f, "%.1f");
         ImGui::SliderFloat("Y", &ry, -180.0f, 180.0f, "%.1f");
         ImGui::SliderFloat("Z", &rz, -180.0f, 180.0f, "%.1f");
         ImGui::EndChild(); ImGui::Separator();
-        auto m = rotX(deg2rad(rx));
-        m = matMul(m, rotY(deg2rad(ry)));
-        m = matMul(m, rotZ(deg2rad(rz)));
-        return m;
+        return {deg2rad(rx), deg2rad(ry), deg2rad(rz)};
     }
 
-    std::vector<std::vector<float>> reflectionCB() {
+    Scaling reflectionCB() {
         ImGui::BeginChild("reflection");
         ImGui::Text("Reflection");
         static bool rx=false, ry=false, rz=false;
@@ -353,7 +718,7 @@ public:
         ImGui::Checkbox("Y-Z plane", &ry);
         ImGui::Checkbox("X-Z plane", &rz);
         ImGui::EndChild(); ImGui::Separator();
-        return reflect(rx, ry, rz);
+        return reflection(rx, ry, rz);
     }
 
     bool imguiAnim()
@@ -403,11 +768,79 @@ public:
     }
 };
 
+// Stage percentiles over the last frames and a timeline of the last complete frame,
+// one row per thread and nesting depth. Buffers persist, so it does not allocate
+// once warmed up.
+void drawProfilerWindow(Profiler& profiler) {
+    static std::vector<ProfileEvent> events;
+    static ProfileReport report;
+    if (events.capacity() < profiler.capacity()) events.reserve(profiler.capacity());
+    constexpr std::uint64_t kWindowFrames = 120;
+
+    ImGui::Begin("Profiler");
+    bool enabled = profiler.enabled();
+    if (ImGui::Checkbox("Enabled", &enabled)) profiler.setEnabled(enabled);
+    profiler.snapshot(events);
+    const std::uint64_t last = profiler.frame();  // still being recorded
+    if (ImGui::Button("Export trace")) {
+        try {
+            writeChromeTrace("trace.json", events);
+            std::cout << "wrote trace.json: " << events.size() << " events\n";
+        } catch (const std::exception& e) {
+            std::cerr << "trace export failed: " << e.what() << "\n";
+        }
+    }
+    if (last == 0 || events.empty()) {
+        ImGui::End();
+        return;
+    }
+
+    report.build(events, last > kWindowFrames ? last - kWindowFrames : 0, last);
+    ImGui::Text("%-14s %8s %8s %8s %8s  (ms, last %llu frames)", "stage", "p50", "p95", "p99", "max",
+                static_cast<unsigned long long>(kWindowFrames));
+    for (const auto& s : report.stages())
+        ImGui::Text("%-14s %8.3f %8.3f %8.3f %8.3f", s.name, s.p50, s.p95, s.p99, s.max);
+
+    std::uint64_t begin = ~0ull, end = 0;
+    std::uint32_t rows = 0, depths = 0;
+    for (const auto& e : events) {
+        if (e.frame != last - 1) continue;
+        begin = std::min(begin, e.beginNs);
+        end = std::max(end, e.endNs);
+        depths = std::max(depths, e.depth + 1);
+        rows = std::max(rows, e.thread + 1);
+    }
+    if (end <= begin) {
+        ImGui::End();
+        return;
+    }
+    rows *= depths;
+    const float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    const float width = std::max(ImGui::GetContentRegionAvail().x, 100.0f);
+    const float scale = width / static_cast<float>(end - begin);
+    ImDrawList* draw = ImGui::GetWindowDrawList();
+    draw->PushClipRect(origin, ImVec2(origin.x + width, origin.y + rows * rowHeight), true);
+    for (const auto& e : events) {
+        if (e.frame != last - 1) continue;
+        const float x0 = origin.x + (e.beginNs - begin) * scale, x1 = origin.x + (e.endNs - begin) * scale;
+        const float y0 = origin.y + (e.thread * depths + e.depth) * rowHeight;
+        const ImVec2 a(x0, y0), b(std::max(x1, x0 + 1.0f), y0 + rowHeight - 1.0f);
+        const ImU32 hue = static_cast<ImU32>(reinterpret_cast<std::uintptr_t>(e.name) * 2654435761u);
+        draw->AddRectFilled(a, b, IM_COL32(80 + (hue & 127), 80 + ((hue >> 8) & 127), 80 + ((hue >> 16) & 127), 255));
+        draw->AddText(ImVec2(x0 + 2.0f, y0), IM_COL32(0, 0, 0, 255), e.name);
+    }
+    draw->PopClipRect();
+    ImGui::Dummy(ImVec2(width, rows * rowHeight));
+    ImGui::Text("frame %llu: %.3f ms", static_cast<unsigned long long>(last - 1), (end - begin) * 1e-6);
+    ImGui::End();
+}
+
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0,0,width,height);
 }
 
-int main() {
+int main(int argc, char** argv) {
     if (!glfwInit()) { std::cerr<<"failed to init glfw\n"; return -1; }
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
@@ -423,25 +856,64 @@ int main() {
     ImGui_ImplGlfw_InitForOpenGL(window,true);
     ImGui_ImplOpenGL3_Init("#version 120");
 
-    auto view = translate(0.0f,0.0f,-3.0f);
-    view = matMul(view, rotX(deg2rad(30.0f)));
-    view = matMul(view, rotY(deg2rad(-40.0f)));
-    view = matMul(view, scaleMat(1.0f,1.0f,-1.0f));
+    // Fixed, so evaluated at compile time.
+    constexpr Affine3x4 view = (Translation{0.0f,0.0f,-3.0f} * RotationX(deg2rad(30.0f)) *
+                                RotationY(deg2rad(-40.0f)) * Scaling{1.0f,1.0f,-1.0f}).affine();
 
     // Object k = initLetterK();
-    Object cube = initCube();
-    Object axes = initAxes();
-    cube.setView(view);  
-    axes.setView(view);
+    Object cube = builtinCube();
+    if (argc > 1) {
+        try {
+            const MeshLoadStats st { loadMeshCached(argv[1], cube) };
+            fitToBuiltinCube(cube);
+            std::cout << (st.fromCache ? "loaded cached " : "loaded ") << argv[1] << ": " << st.vertices << " vertices, " << st.faces << " faces, "
+                      << st.edges << " edges in " << st.seconds * 1000.0 << " ms ("
+                      << st.megabytesPerSecond() << " MB/s, " << st.verticesPerSecond() << " vertices/s)\n";
+        } catch (const std::exception& e) {
+            std::cerr << "failed to load " << argv[1] << ": " << e.what() << "\n";
+            return -1;
+        }
+    }
+    // Per-vertex and per-face passes of the (possibly loaded) cube go wide; the axes are too small to.
+    cube.scheduler = &TaskScheduler::global();
+    Object axes = builtinAxes();
 
-    auto proj = ortho(-1.0f,1.0f,-1.0f,1.0f,0.1f,100.0f);
-    cube.setProjection(proj);
-    axes.setProjection(proj);
+    // Both objects take their model from the scene and share its camera.
+    SceneGraph scene;
+    scene.setView(view.toMat4());
+    scene.setProjection(ortho(-1.0f,1.0f,-1.0f,1.0f,0.1f,100.0f));
+    const auto cubeNode = scene.addNode(SceneGraph::kNone, Mat4::identity(), &cube);
+    scene.addNode(SceneGraph::kNone, Mat4::identity(), &axes);
 
-    Controller ctrl(cube);
+    // Copies of the cube's mesh on a grid behind it: one shared mesh, one matrix each.
+    Object instanceMesh = cube;
+    InstancedObject instances(instanceMesh);
+    GpuInstances instancesGpu;
+    std::vector<int> instanceEdges;  // scratch for the immediate-mode instance path
+    int instanceCount{0};
 
+    Controller ctrl(cube);
+    GpuMesh cubeGpu, axesGpu;
+    int backendChoice{static_cast<int>(RenderBackend::Buffered)};
+    bool useRoberts{cube.useRoberts};
+    VertexLayout layout{cube.layout};
+    // Pipelined mode: a worker updates the cube for the next frame while this thread
+    // draws the previous one. Sequential mode keeps its own metrics for comparison.
+    std::unique_ptr<FramePipeline> pipeline;
+    FrameMetrics sequentialMetrics;
+    Profiler& profiler = Profiler::global();
+    // Scratch memory for one frame; heap counts are only available in Debug builds,
+    // which link the counting operator new.
+    FrameArena frameArena;
+    HeapStats heapAtFrameStart = heapStats();
+    std::uint64_t heapAllocationsLastFrame{0};
 
     while (!glfwWindowShouldClose(window)) {
+        profiler.beginFrame();
+        frameArena.reset();
+        const HeapStats heapNow = heapStats();
+        heapAllocationsLastFrame = heapNow.allocations - heapAtFrameStart.allocations;
+        heapAtFrameStart = heapNow;
         glfwPollEvents();
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
@@ -451,6 +923,7 @@ int main() {
         ImGui::Begin("Settings");
         if(ctrl.imguiAnim())
         {
+            ProfileScope stage("animFrame");
             ctrl.animFrame();
         }
         auto T = ctrl.posSliders();
@@ -458,37 +931,162 @@ int main() {
         auto S = ctrl.scaleSliders();
         auto refl = ctrl.reflectionCB();
 
+        ImGui::Checkbox("Hidden surface removal", &useRoberts);
+        static bool soaLayout = false;
+        if (ImGui::Checkbox("SoA vertex layout", &soaLayout))
+            layout = soaLayout ? VertexLayout::SoA : VertexLayout::AoS;
+        ImGui::Text("Renderer");
+        ImGui::RadioButton("Immediate", &backendChoice, static_cast<int>(RenderBackend::Immediate));
+        ImGui::SameLine();
+        ImGui::RadioButton("Buffered", &backendChoice, static_cast<int>(RenderBackend::Buffered));
+        const auto backend = static_cast<RenderBackend>(backendChoice);
+        ImGui::SliderInt("Instances", &instanceCount, 0, 100000);
+
+        bool pipelined = pipeline != nullptr;
+        if (ImGui::Checkbox("Pipelined update (worker thread)", &pipelined)) {
+            // The worker owns the cube while it runs, so the scene must not write to it.
+            if (pipelined) {
+                scene.setObject(cubeNode, nullptr);
+                pipeline = std::make_unique<FramePipeline>(cube);
+            } else {
+                pipeline.reset();
+                scene.setObject(cubeNode, &cube);
+            }
+        }
 
+        {
+            ProfileScope stage("matrices");
+            const Affine3x4 modelMat = (T * R * S * refl).affine();
+            scene.setLocal(cubeNode, modelMat.toMat4());
+            scene.update();
+        }
 
-        auto modelMat = T;
-        modelMat = matMul(modelMat, R);
-        modelMat = matMul(modelMat, S);
-        //modelMat = matMul(modelMat, refl);
-        cube.setModel(modelMat);
+        if (static_cast<size_t>(instanceCount) != instances.size()) {
+            instances.resize(instanceCount);
+            const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(instanceCount))));
+            const float step = 2.0f / std::max(side, 1);
+            for (int i = 0; i < instanceCount; ++i)
+                instances.setModel(i, matMul(translate(-1.0f + step * (i % side + 0.5f), -1.0f + step * (i / side + 0.5f), -1.0f),
+                                             scaleMat(step, step, step)));
+        }
+        if (instanceCount > 0) {
+            instances.setView(scene.view());
+            instances.setProjection(scene.projection());
+            instances.update(&TaskScheduler::global());
+        }
+
+        const FrameSnapshot* frame = nullptr;
+        const auto inputTime = FrameClock::now();
+        if (pipeline) {
+            FrameInputs in;
+            in.model = scene.world(cubeNode);
+            in.view = scene.view();
+            in.projection = scene.projection();
+            in.useRoberts = useRoberts;
+            in.cpuProjection = needsCpuProjection(backend);
+            in.layout = layout;
+            pipeline->submit(in);
+            frame = pipeline->acquire();
+
+            const FrameMetrics& m = pipeline->metrics();
+            ImGui::Text("Pipelined: %.1f fps, latency %.2f ms (max %.2f), dropped %llu of %llu",
+                        m.framesPerSecond(), m.meanLatencyMs(), m.maxLatencyMs(),
+                        pipeline->framesDropped(), pipeline->framesSubmitted());
+        } else {
+            cube.useRoberts = useRoberts;
+            cube.setLayout(layout);
+            cube.cpuProjection = needsCpuProjection(backend);
+            cube.update();
+
+            ImGui::Text("Updates: %llu, skipped: %llu, transformed vertices: %llu",
+                        cube.stats.updates, cube.stats.skipped, cube.stats.transformedVertices);
+            ImGui::Text("Sequential: %.1f fps, latency %.2f ms (max %.2f)", sequentialMetrics.framesPerSecond(),
+                        sequentialMetrics.meanLatencyMs(), sequentialMetrics.maxLatencyMs());
+
+            // Analytic hidden lines of the current view; needs the CPU-projected streams.
+            if (ImGui::Button("Export SVG")) {
+                cube.cpuProjection = axes.cpuProjection = true;
+                cube.update();
+                axes.update();
+                const Object* hlrObjects[] = { &cube, &axes };
+                HiddenLineRemover hlr;
+                int width = 0, height = 0;
+                glfwGetFramebufferSize(window, &width, &height);
+                try {
+                    writeSvg("roberts.svg", hlr.compute(hlrObjects), width, height);
+                    std::cout << "wrote roberts.svg: " << hlr.stats().segments << " segments\n";
+                } catch (const std::exception& e) {
+                    std::cerr << "svg export failed: " << e.what() << "\n";
+                }
+            }
+        }
+
+        // The axes are updated while drawing, so their result is the previous frame's.
+        CullStats cull;
+        if (frame || !pipeline) cull.add(frame ? frame->culled : cube.culled);
+        cull.add(axes.culled);
+        if (instanceCount > 0) cull += instances.cullStats();
+        ImGui::Text("Culling: %zu tested, %zu culled, %zu drawn", cull.tested, cull.culled, cull.drawn);
+        ImGui::Text("Frame arena: %zu / %zu bytes", frameArena.highWater(), frameArena.capacity());
+        if (heapCountingEnabled())
+            ImGui::Text("Heap allocations last frame: %llu", static_cast<unsigned long long>(heapAllocationsLastFrame));
 
         ImGui::End();
 
+        // Only the rows in view are formatted, straight into ImGui's buffer.
         ImGui::Begin("Roberts Info");
-        for (size_t i=0; i<cube.planes.size(); ++i) {
-            std::ostringstream oss;
-            oss<<"Face "<<i<<" dot = "<<cube.planes[i].dot;
-            if (cube.planes[i].facing) 
-                ImGui::TextColored(ImVec4(0.3f,1.0f,0.3f,1.0f), "%s", oss.str().c_str());
-            else
-                ImGui::TextColored(ImVec4(1.0f,0.3f,0.3f,1.0f), "%s", oss.str().c_str());
+        // The facing data of a culled frame is left from an older one, so it is not listed.
+        static const std::vector<float> noDots;
+        const bool culled = frame ? frame->culled : !pipeline && cube.culled;
+        const std::vector<float>& faceDots = culled ? noDots : frame ? frame->faceDots : pipeline ? noDots : cube.faceDots;
+        if (culled) ImGui::TextUnformatted("Culled: outside the view volume");
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(faceDots.size()));
+        while (clipper.Step()) {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                const bool facing = frame ? frame->isFacing(i) : cube.isFacing(i);
+                ImGui::TextColored(facing ? ImVec4(0.3f,1.0f,0.3f,1.0f) : ImVec4(1.0f,0.3f,0.3f,1.0f),
+                                   "Face %d dot = %g", i, faceDots[i]);
+            }
         }
+        clipper.End();
         ImGui::End();
 
-        glClearColor(0.1f,0.1f,0.1f,1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        axes.draw();
-        cube.draw();
+        drawProfilerWindow(profiler);
 
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-        glfwSwapBuffers(window);
+        {
+            ProfileScope stage("draw");
+            glClearColor(0.1f,0.1f,0.1f,1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            updateAndDraw(axes, axesGpu, backend);
+            if (instanceCount > 0) {
+                if (backend == RenderBackend::Buffered) instancesGpu.draw(instances, frameArena);
+                else drawInstancesImmediate(instances, instanceEdges);
+            }
+            if (pipeline) {
+                if (frame) drawObject(cube, *frame, cubeGpu, backend);
+                pipeline->frameDrawn();
+            } else {
+                drawObject(cube, cube, cubeGpu, backend);
+                sequentialMetrics.record(inputTime, FrameClock::now());
+            }
+        }
+
+        {
+            ProfileScope stage("imgui");
+            ImGui::Render();
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        }
+        {
+            ProfileScope stage("swap");
+            glfwSwapBuffers(window);
+        }
     }
 
+    pipeline.reset();
+    cubeGpu.release();
+    axesGpu.release();
+    instancesGpu.release();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
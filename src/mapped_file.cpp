@@ -0,0 +1,154 @@
+#include "mapped_file.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace math3d {
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const std::string& path) {
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                       FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("cannot open " + path);
+
+    LARGE_INTEGER sz;
+    if (!GetFileSizeEx(file, &sz)) {
+        CloseHandle(file);
+        throw std::runtime_error("cannot stat " + path);
+    }
+    fileSize = static_cast<std::uint64_t>(sz.QuadPart);
+    if (fileSize != 0) {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) {
+            CloseHandle(file);
+            throw std::runtime_error("cannot map " + path);
+        }
+    }
+}
+
+MappedFile::~MappedFile() {
+    unmap();
+    if (mapping) CloseHandle(mapping);
+    if (file && file != INVALID_HANDLE_VALUE) CloseHandle(file);
+}
+
+size_t MappedFile::granularity() {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwAllocationGranularity;
+}
+
+std::span<const char> MappedFile::map(std::uint64_t offset, size_t length) {
+    unmap();
+    if (offset >= fileSize || length == 0) return {};
+
+    const std::uint64_t aligned = offset - offset % granularity();
+    const size_t len = static_cast<size_t>(std::min<std::uint64_t>(length + (offset - aligned), fileSize - aligned));
+    view = MapViewOfFile(mapping, FILE_MAP_READ, static_cast<DWORD>(aligned >> 32),
+                         static_cast<DWORD>(aligned & 0xffffffffu), len);
+    if (!view) throw std::runtime_error("MapViewOfFile failed");
+    viewLength = len;
+    return {static_cast<const char*>(view) + (offset - aligned), len - static_cast<size_t>(offset - aligned)};
+}
+
+void MappedFile::unmap() {
+    if (view) UnmapViewOfFile(view);
+    view = nullptr;
+    viewLength = 0;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("cannot open " + path);
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("cannot stat " + path);
+    }
+    fileSize = static_cast<std::uint64_t>(st.st_size);
+}
+
+MappedFile::~MappedFile() {
+    unmap();
+    if (fd >= 0) ::close(fd);
+}
+
+size_t MappedFile::granularity() {
+    return static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+}
+
+std::span<const char> MappedFile::map(std::uint64_t offset, size_t length) {
+    unmap();
+    if (offset >= fileSize || length == 0) return {};
+
+    const std::uint64_t aligned = offset - offset % granularity();
+    const size_t len = static_cast<size_t>(std::min<std::uint64_t>(length + (offset - aligned), fileSize - aligned));
+    void* p = ::mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, static_cast<off_t>(aligned));
+    if (p == MAP_FAILED) throw std::runtime_error("mmap failed");
+    ::madvise(p, len, MADV_SEQUENTIAL);
+    view = p;
+    viewLength = len;
+    return {static_cast<const char*>(view) + (offset - aligned), len - static_cast<size_t>(offset - aligned)};
+}
+
+void MappedFile::unmap() {
+    if (view) ::munmap(view, viewLength);
+    view = nullptr;
+    viewLength = 0;
+}
+
+#endif
+
+SequentialReader::SequentialReader(const std::string& path, size_t windowBytes)
+    : file(path), window(std::max(windowBytes, MappedFile::granularity())) {}
+
+void SequentialReader::slide(size_t minBytes) {
+    while (window < minBytes) window *= 2;
+    view = file.map(pos, window);
+    viewStart = pos;
+}
+
+const char* SequentialReader::ensure(size_t n) {
+    if (pos + n > file.size()) return nullptr;
+    if (pos < viewStart || pos + n > viewStart + view.size()) slide(n);
+    return view.data() + (pos - viewStart);
+}
+
+bool SequentialReader::nextLine(std::string_view& line) {
+    if (eof()) return false;
+    if (pos < viewStart || pos >= viewStart + view.size()) slide(0);
+
+    for (;;) {
+        const char* begin = view.data() + (pos - viewStart);
+        const size_t avail = static_cast<size_t>(viewStart + view.size() - pos);
+        const void* nl = std::memchr(begin, '\n', avail);
+        if (nl || viewStart + view.size() == file.size()) {
+            const size_t len = nl ? static_cast<size_t>(static_cast<const char*>(nl) - begin) : avail;
+            pos += nl ? len + 1 : len;
+            line = std::string_view(begin, len);
+            if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            return true;
+        }
+        // The line runs past the window: restart the window at the line, growing it if
+        // the line alone does not fit.
+        slide(avail < window ? 0 : window * 2);
+    }
+}
+
+}
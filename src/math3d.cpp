@@ -1,7 +1,6 @@
 #include "math3d.hpp"
 
 #include <cmath>
-#include <numbers>
 #include <stdexcept>
 
 namespace math3d {
@@ -10,6 +9,99 @@ Vertex make_vertex(float x, float y, float z) {
     return Vertex{x, y, z, 1.0f};
 }
 
+void VertexSoA::resize(size_t n, bool withW) {
+    x.resize(n);
+    y.resize(n);
+    z.resize(n);
+    if (withW) w.resize(n, 1.0f);
+    else w.clear();
+}
+
+void VertexSoA::assign(std::span<const Vertex> v) {
+    bool withW = false;
+    for (const auto& p : v) {
+        if (p.w != 1.0f) { withW = true; break; }
+    }
+
+    resize(v.size(), withW);
+    for (size_t i = 0; i < v.size(); ++i) {
+        x[i] = v[i].x;
+        y[i] = v[i].y;
+        z[i] = v[i].z;
+        if (withW) w[i] = v[i].w;
+    }
+}
+
+Mat4 Mat4::fromRows(const std::vector<std::vector<float>>& rows) {
+    if (rows.size() != 4)
+        throw std::runtime_error("invalid matrix size");
+
+    Mat4 r;
+    for (int i = 0; i < 4; i++) {
+        if (rows[i].size() != 4)
+            throw std::runtime_error("invalid matrix size");
+        for (int j = 0; j < 4; j++)
+            r(i, j) = rows[i][j];
+    }
+    return r;
+}
+
+Mat4::operator std::vector<std::vector<float>>() const {
+    return {{m[0], m[1], m[2], m[3]},
+            {m[4], m[5], m[6], m[7]},
+            {m[8], m[9], m[10], m[11]},
+            {m[12], m[13], m[14], m[15]}};
+}
+
+bool operator==(const Mat4& A, const Mat4& B) {
+    for (int i = 0; i < 16; i++)
+        if (A.m[i] != B.m[i]) return false;
+    return true;
+}
+
+bool isAffine(const Mat4& m) {
+    return m(3, 0) == 0.0f && m(3, 1) == 0.0f && m(3, 2) == 0.0f && m(3, 3) == 1.0f;
+}
+
+Mat4 normalMatrix(const Mat4& m) {
+    // Cofactors of the upper 3x3 block; cof / det is the inverse-transpose.
+    const float c00 = m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1);
+    const float c01 = m(1, 2) * m(2, 0) - m(1, 0) * m(2, 2);
+    const float c02 = m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0);
+    const float c10 = m(0, 2) * m(2, 1) - m(0, 1) * m(2, 2);
+    const float c11 = m(0, 0) * m(2, 2) - m(0, 2) * m(2, 0);
+    const float c12 = m(0, 1) * m(2, 0) - m(0, 0) * m(2, 1);
+    const float c20 = m(0, 1) * m(1, 2) - m(0, 2) * m(1, 1);
+    const float c21 = m(0, 2) * m(1, 0) - m(0, 0) * m(1, 2);
+    const float c22 = m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0);
+
+    const float det = m(0, 0) * c00 + m(0, 1) * c01 + m(0, 2) * c02;
+    const float inv = det != 0.0f ? 1.0f / det : 1.0f;
+    return {{c00 * inv, c01 * inv, c02 * inv, 0,
+             c10 * inv, c11 * inv, c12 * inv, 0,
+             c20 * inv, c21 * inv, c22 * inv, 0,
+             0, 0, 0, 1}};
+}
+
+Vertex mulMatVec(const Mat4& m, const Vertex& v) {
+    Vertex r;
+    r.x = m(0, 0) * v.x + m(0, 1) * v.y + m(0, 2) * v.z + m(0, 3) * v.w;
+    r.y = m(1, 0) * v.x + m(1, 1) * v.y + m(1, 2) * v.z + m(1, 3) * v.w;
+    r.z = m(2, 0) * v.x + m(2, 1) * v.y + m(2, 2) * v.z + m(2, 3) * v.w;
+    r.w = m(3, 0) * v.x + m(3, 1) * v.y + m(3, 2) * v.z + m(3, 3) * v.w;
+    return r;
+}
+
+Mat4 matMul(const Mat4& A, const Mat4& B) {
+    Mat4 R;
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            R(i, j) = A(i, 0) * B(0, j) + A(i, 1) * B(1, j) + A(i, 2) * B(2, j) + A(i, 3) * B(3, j);
+        }
+    }
+    return R;
+}
+
 Vertex mulMatVec(const std::vector<std::vector<float>>& m, const Vertex& v) {
     Vertex r;
     r.x = m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z + m[0][3] * v.w;
@@ -45,52 +137,72 @@ std::vector<std::vector<float>> matMul(const std::vector<std::vector<float>>& A,
     return R;
 }
 
-std::vector<std::vector<float>> translate(float dx, float dy, float dz) {
-    return {{1, 0, 0, dx}, {0, 1, 0, dy}, {0, 0, 1, dz}, {0, 0, 0, 1}};
+Mat4 translate(float dx, float dy, float dz) {
+    return {{1, 0, 0, dx,
+             0, 1, 0, dy,
+             0, 0, 1, dz,
+             0, 0, 0, 1}};
 }
 
-std::vector<std::vector<float>> scaleMat(float sx, float sy, float sz) {
-    return {{sx, 0, 0, 0}, {0, sy, 0, 0}, {0, 0, sz, 0}, {0, 0, 0, 1}};
+Mat4 scaleMat(float sx, float sy, float sz) {
+    return {{sx, 0, 0, 0,
+             0, sy, 0, 0,
+             0, 0, sz, 0,
+             0, 0, 0, 1}};
 }
 
-std::vector<std::vector<float>> rotX(float a) {
-    return {{1, 0, 0, 0}, {0, static_cast<float>(cos(a)), static_cast<float>(sin(a)), 0}, {0, static_cast<float>(-sin(a)), static_cast<float>(cos(a)), 0}, {0, 0, 0, 1}};
+Mat4 rotX(float a) {
+    const float c = static_cast<float>(cos(a));
+    const float s = static_cast<float>(sin(a));
+    return {{1, 0, 0, 0,
+             0, c, s, 0,
+             0, -s, c, 0,
+             0, 0, 0, 1}};
 }
 
-std::vector<std::vector<float>> rotY(float a) {
-    return {{static_cast<float>(cos(a)), 0, static_cast<float>(-sin(a)), 0}, {0, 1, 0, 0}, {static_cast<float>(sin(a)), 0, static_cast<float>(cos(a)), 0}, {0, 0, 0, 1}};
+Mat4 rotY(float a) {
+    const float c = static_cast<float>(cos(a));
+    const float s = static_cast<float>(sin(a));
+    return {{c, 0, -s, 0,
+             0, 1, 0, 0,
+             s, 0, c, 0,
+             0, 0, 0, 1}};
 }
 
-std::vector<std::vector<float>> rotZ(float a) {
-    return {{static_cast<float>(cos(a)), static_cast<float>(sin(a)), 0, 0}, {static_cast<float>(-sin(a)), static_cast<float>(cos(a)), 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}};
+Mat4 rotZ(float a) {
+    const float c = static_cast<float>(cos(a));
+    const float s = static_cast<float>(sin(a));
+    return {{c, s, 0, 0,
+             -s, c, 0, 0,
+             0, 0, 1, 0,
+             0, 0, 0, 1}};
 }
 
-std::vector<std::vector<float>> reflect(bool rx, bool ry, bool rz) {
+Mat4 reflect(bool rx, bool ry, bool rz) {
     const float fx = rx ? -1.0f : 1.0f;
     const float fy = ry ? -1.0f : 1.0f;
     const float fz = rz ? -1.0f : 1.0f;
-    return {{fx, 0, 0, 0}, {0, fy, 0, 0}, {0, 0, fz, 0}, {0, 0, 0, 1}};
+    return {{fx, 0, 0, 0,
+             0, fy, 0, 0,
+             0, 0, fz, 0,
+             0, 0, 0, 1}};
 }
 
-std::vector<std::vector<float>> ortho(float left, float right, float bottom, float top, float n, float f) {
+Mat4 ortho(float left, float right, float bottom, float top, float n, float f) {
     const float tx = -(right + left) / (right - left);
     const float ty = -(top + bottom) / (top - bottom);
     const float tz = -(f + n) / (f - n);
 
-    return {
-        {2.0f / (right - left), 0, 0, tx},
-        {0, 2.0f / (top - bottom), 0, ty},
-        {0, 0, -2.0f / (f - n), tz},
-        {0, 0, 0, 1}
-    };
+    return {{
+        2.0f / (right - left), 0, 0, tx,
+        0, 2.0f / (top - bottom), 0, ty,
+        0, 0, -2.0f / (f - n), tz,
+        0, 0, 0, 1
+    }};
 }
 
 float dot(Vertex v1, Vertex v2) {
     return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z;
 }
 
-float deg2rad(float d) {
-    return d * std::numbers::pi_v<float> / 180.0f;
-}
-
 }
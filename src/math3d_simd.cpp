@@ -0,0 +1,419 @@
+#include "math3d.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MATH3D_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define MATH3D_TARGET_AVX2
+#else
+#define MATH3D_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__ARM_NEON) || defined(__aarch64__) || defined(_M_ARM64)
+#define MATH3D_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace math3d {
+
+static_assert(sizeof(Vertex) == 4 * sizeof(float), "kernels load a Vertex as one 4-float vector");
+
+namespace {
+
+void transformScalar(const Mat4& m, const Vertex* in, Vertex* out, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        out[i] = mulMatVec(m, in[i]);
+}
+
+// Raw lane pointers of a VertexSoA. A null input w means w == 1; a null output w
+// means w is not stored.
+struct LanesIn {
+    const float *x, *y, *z, *w;
+};
+
+struct LanesOut {
+    float *x, *y, *z, *w;
+};
+
+void transformLanesScalar(const Mat4& m, LanesIn in, LanesOut out, size_t begin, size_t n) {
+    for (size_t i = begin; i < n; ++i) {
+        const float x = in.x[i], y = in.y[i], z = in.z[i], w = in.w ? in.w[i] : 1.0f;
+        const float rx = m(0, 0) * x + m(0, 1) * y + m(0, 2) * z + m(0, 3) * w;
+        const float ry = m(1, 0) * x + m(1, 1) * y + m(1, 2) * z + m(1, 3) * w;
+        const float rz = m(2, 0) * x + m(2, 1) * y + m(2, 2) * z + m(2, 3) * w;
+        if (out.w) out.w[i] = m(3, 0) * x + m(3, 1) * y + m(3, 2) * z + m(3, 3) * w;
+        out.x[i] = rx;
+        out.y[i] = ry;
+        out.z[i] = rz;
+    }
+}
+
+#if defined(MATH3D_X86)
+
+bool cpuHasAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+// Columns of the row-major matrix, so that m * v = c0*x + c1*y + c2*z + c3*w.
+struct Columns128 {
+    __m128 c0, c1, c2, c3;
+
+    explicit Columns128(const Mat4& m)
+        : c0{_mm_setr_ps(m(0, 0), m(1, 0), m(2, 0), m(3, 0))},
+          c1{_mm_setr_ps(m(0, 1), m(1, 1), m(2, 1), m(3, 1))},
+          c2{_mm_setr_ps(m(0, 2), m(1, 2), m(2, 2), m(3, 2))},
+          c3{_mm_setr_ps(m(0, 3), m(1, 3), m(2, 3), m(3, 3))} {}
+
+    __m128 apply(__m128 v) const {
+        __m128 r = _mm_mul_ps(c0, _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+        r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+        r = _mm_add_ps(r, _mm_mul_ps(c3, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))));
+        return r;
+    }
+};
+
+void transformSSE2(const Mat4& m, const Vertex* in, Vertex* out, size_t n) {
+    const Columns128 cols(m);
+    for (size_t i = 0; i < n; ++i)
+        _mm_storeu_ps(&out[i].x, cols.apply(_mm_loadu_ps(&in[i].x)));
+}
+
+// Two vertices per 256-bit register; the matrix columns are duplicated into
+// both 128-bit lanes so the in-lane permutes act as per-vertex broadcasts.
+MATH3D_TARGET_AVX2
+inline __m256 apply256(__m256 c0, __m256 c1, __m256 c2, __m256 c3, __m256 v) {
+    __m256 r = _mm256_mul_ps(c0, _mm256_permute_ps(v, 0x00));
+    r = _mm256_add_ps(r, _mm256_mul_ps(c1, _mm256_permute_ps(v, 0x55)));
+    r = _mm256_add_ps(r, _mm256_mul_ps(c2, _mm256_permute_ps(v, 0xAA)));
+    r = _mm256_add_ps(r, _mm256_mul_ps(c3, _mm256_permute_ps(v, 0xFF)));
+    return r;
+}
+
+MATH3D_TARGET_AVX2
+void transformAVX2(const Mat4& m, const Vertex* in, Vertex* out, size_t n) {
+    const Columns128 cols(m);
+    const __m256 c0 = _mm256_set_m128(cols.c0, cols.c0);
+    const __m256 c1 = _mm256_set_m128(cols.c1, cols.c1);
+    const __m256 c2 = _mm256_set_m128(cols.c2, cols.c2);
+    const __m256 c3 = _mm256_set_m128(cols.c3, cols.c3);
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256 a = _mm256_loadu_ps(&in[i].x);
+        const __m256 b = _mm256_loadu_ps(&in[i + 2].x);
+        _mm256_storeu_ps(&out[i].x, apply256(c0, c1, c2, c3, a));
+        _mm256_storeu_ps(&out[i + 2].x, apply256(c0, c1, c2, c3, b));
+    }
+    for (; i < n; ++i)
+        _mm_storeu_ps(&out[i].x, cols.apply(_mm_loadu_ps(&in[i].x)));
+}
+
+inline __m128 row128(const __m128* e, int row, __m128 x, __m128 y, __m128 z, __m128 w) {
+    __m128 r = _mm_mul_ps(e[row * 4], x);
+    r = _mm_add_ps(r, _mm_mul_ps(e[row * 4 + 1], y));
+    r = _mm_add_ps(r, _mm_mul_ps(e[row * 4 + 2], z));
+    r = _mm_add_ps(r, _mm_mul_ps(e[row * 4 + 3], w));
+    return r;
+}
+
+void transformLanesSSE2(const Mat4& m, LanesIn in, LanesOut out, size_t n) {
+    __m128 e[16];
+    for (int k = 0; k < 16; ++k) e[k] = _mm_set1_ps(m.m[k]);
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128 x = _mm_loadu_ps(in.x + i);
+        const __m128 y = _mm_loadu_ps(in.y + i);
+        const __m128 z = _mm_loadu_ps(in.z + i);
+        const __m128 w = in.w ? _mm_loadu_ps(in.w + i) : one;
+        const __m128 rx = row128(e, 0, x, y, z, w);
+        const __m128 ry = row128(e, 1, x, y, z, w);
+        const __m128 rz = row128(e, 2, x, y, z, w);
+        if (out.w) _mm_storeu_ps(out.w + i, row128(e, 3, x, y, z, w));
+        _mm_storeu_ps(out.x + i, rx);
+        _mm_storeu_ps(out.y + i, ry);
+        _mm_storeu_ps(out.z + i, rz);
+    }
+    transformLanesScalar(m, in, out, i, n);
+}
+
+MATH3D_TARGET_AVX2
+inline __m256 row256(const __m256* e, int row, __m256 x, __m256 y, __m256 z, __m256 w) {
+    __m256 r = _mm256_mul_ps(e[row * 4], x);
+    r = _mm256_add_ps(r, _mm256_mul_ps(e[row * 4 + 1], y));
+    r = _mm256_add_ps(r, _mm256_mul_ps(e[row * 4 + 2], z));
+    r = _mm256_add_ps(r, _mm256_mul_ps(e[row * 4 + 3], w));
+    return r;
+}
+
+MATH3D_TARGET_AVX2
+void transformLanesAVX2(const Mat4& m, LanesIn in, LanesOut out, size_t n) {
+    __m256 e[16];
+    for (int k = 0; k < 16; ++k) e[k] = _mm256_set1_ps(m.m[k]);
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256 x = _mm256_loadu_ps(in.x + i);
+        const __m256 y = _mm256_loadu_ps(in.y + i);
+        const __m256 z = _mm256_loadu_ps(in.z + i);
+        const __m256 w = in.w ? _mm256_loadu_ps(in.w + i) : one;
+        const __m256 rx = row256(e, 0, x, y, z, w);
+        const __m256 ry = row256(e, 1, x, y, z, w);
+        const __m256 rz = row256(e, 2, x, y, z, w);
+        if (out.w) _mm256_storeu_ps(out.w + i, row256(e, 3, x, y, z, w));
+        _mm256_storeu_ps(out.x + i, rx);
+        _mm256_storeu_ps(out.y + i, ry);
+        _mm256_storeu_ps(out.z + i, rz);
+    }
+    transformLanesScalar(m, in, out, i, n);
+}
+
+#endif
+
+#if defined(MATH3D_NEON)
+
+void transformNEON(const Mat4& m, const Vertex* in, Vertex* out, size_t n) {
+    const float c[4][4] = {
+        {m(0, 0), m(1, 0), m(2, 0), m(3, 0)},
+        {m(0, 1), m(1, 1), m(2, 1), m(3, 1)},
+        {m(0, 2), m(1, 2), m(2, 2), m(3, 2)},
+        {m(0, 3), m(1, 3), m(2, 3), m(3, 3)},
+    };
+    const float32x4_t c0 = vld1q_f32(c[0]);
+    const float32x4_t c1 = vld1q_f32(c[1]);
+    const float32x4_t c2 = vld1q_f32(c[2]);
+    const float32x4_t c3 = vld1q_f32(c[3]);
+
+    // Separate multiply and add (no vmla/vfma) to stay bit-identical to the scalar path.
+    for (size_t i = 0; i < n; ++i) {
+        const float32x4_t v = vld1q_f32(&in[i].x);
+        const float32x2_t lo = vget_low_f32(v);
+        const float32x2_t hi = vget_high_f32(v);
+        float32x4_t r = vmulq_lane_f32(c0, lo, 0);
+        r = vaddq_f32(r, vmulq_lane_f32(c1, lo, 1));
+        r = vaddq_f32(r, vmulq_lane_f32(c2, hi, 0));
+        r = vaddq_f32(r, vmulq_lane_f32(c3, hi, 1));
+        vst1q_f32(&out[i].x, r);
+    }
+}
+
+inline float32x4_t rowNEON(const float32x4_t* e, int row, float32x4_t x, float32x4_t y, float32x4_t z, float32x4_t w) {
+    float32x4_t r = vmulq_f32(e[row * 4], x);
+    r = vaddq_f32(r, vmulq_f32(e[row * 4 + 1], y));
+    r = vaddq_f32(r, vmulq_f32(e[row * 4 + 2], z));
+    r = vaddq_f32(r, vmulq_f32(e[row * 4 + 3], w));
+    return r;
+}
+
+void transformLanesNEON(const Mat4& m, LanesIn in, LanesOut out, size_t n) {
+    float32x4_t e[16];
+    for (int k = 0; k < 16; ++k) e[k] = vdupq_n_f32(m.m[k]);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const float32x4_t x = vld1q_f32(in.x + i);
+        const float32x4_t y = vld1q_f32(in.y + i);
+        const float32x4_t z = vld1q_f32(in.z + i);
+        const float32x4_t w = in.w ? vld1q_f32(in.w + i) : one;
+        const float32x4_t rx = rowNEON(e, 0, x, y, z, w);
+        const float32x4_t ry = rowNEON(e, 1, x, y, z, w);
+        const float32x4_t rz = rowNEON(e, 2, x, y, z, w);
+        if (out.w) vst1q_f32(out.w + i, rowNEON(e, 3, x, y, z, w));
+        vst1q_f32(out.x + i, rx);
+        vst1q_f32(out.y + i, ry);
+        vst1q_f32(out.z + i, rz);
+    }
+    transformLanesScalar(m, in, out, i, n);
+}
+
+#endif
+
+}
+
+bool simdPathSupported(SimdPath path) {
+    switch (path) {
+    case SimdPath::Scalar:
+        return true;
+#if defined(MATH3D_X86)
+    case SimdPath::SSE2:
+        return true;
+    case SimdPath::AVX2: {
+        static const bool hasAvx2 = cpuHasAvx2();
+        return hasAvx2;
+    }
+#endif
+#if defined(MATH3D_NEON)
+    case SimdPath::NEON:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+SimdPath bestSimdPath() {
+    static const SimdPath best = [] {
+        for (SimdPath p : {SimdPath::AVX2, SimdPath::NEON, SimdPath::SSE2})
+            if (simdPathSupported(p)) return p;
+        return SimdPath::Scalar;
+    }();
+    return best;
+}
+
+const char* simdPathName(SimdPath path) {
+    switch (path) {
+    case SimdPath::Scalar: return "scalar";
+    case SimdPath::SSE2: return "sse2";
+    case SimdPath::AVX2: return "avx2";
+    case SimdPath::NEON: return "neon";
+    }
+    return "unknown";
+}
+
+void transformVertices(const Mat4& m, std::span<const Vertex> in, std::span<Vertex> out) {
+    transformVertices(m, in, out, bestSimdPath());
+}
+
+void transformVertices(const Mat4& m, std::span<const Vertex> in, std::span<Vertex> out, SimdPath path) {
+    if (in.size() != out.size())
+        throw std::runtime_error("invalid vertex span size");
+    if (!simdPathSupported(path))
+        throw std::runtime_error("unsupported simd path");
+
+    switch (path) {
+#if defined(MATH3D_X86)
+    case SimdPath::SSE2:
+        transformSSE2(m, in.data(), out.data(), in.size());
+        return;
+    case SimdPath::AVX2:
+        transformAVX2(m, in.data(), out.data(), in.size());
+        return;
+#endif
+#if defined(MATH3D_NEON)
+    case SimdPath::NEON:
+        transformNEON(m, in.data(), out.data(), in.size());
+        return;
+#endif
+    default:
+        transformScalar(m, in.data(), out.data(), in.size());
+        return;
+    }
+}
+
+void transformVertices(const Mat4& m, const VertexSoA& in, VertexSoA& out) {
+    transformVertices(m, in, out, bestSimdPath());
+}
+
+namespace {
+
+void transformLanes(const Mat4& m, LanesIn src, LanesOut dst, size_t n, SimdPath path) {
+    switch (path) {
+#if defined(MATH3D_X86)
+    case SimdPath::SSE2:
+        transformLanesSSE2(m, src, dst, n);
+        return;
+    case SimdPath::AVX2:
+        transformLanesAVX2(m, src, dst, n);
+        return;
+#endif
+#if defined(MATH3D_NEON)
+    case SimdPath::NEON:
+        transformLanesNEON(m, src, dst, n);
+        return;
+#endif
+    default:
+        transformLanesScalar(m, src, dst, 0, n);
+        return;
+    }
+}
+
+}
+
+void transformVertices(const Mat4& m, const VertexSoA& in, VertexSoA& out, SimdPath path) {
+    if (!simdPathSupported(path))
+        throw std::runtime_error("unsupported simd path");
+
+    const size_t n = in.size();
+    const bool withW = in.hasW() || !isAffine(m);
+    // Resizing `out` may reallocate `in` when both are the same object, so the input
+    // pointers are taken afterwards. An existing input w lane survives because then withW is true.
+    out.resize(n, withW);
+    const LanesIn src{in.x.data(), in.y.data(), in.z.data(), in.hasW() ? in.w.data() : nullptr};
+    const LanesOut dst{out.x.data(), out.y.data(), out.z.data(), withW ? out.w.data() : nullptr};
+    transformLanes(m, src, dst, n, path);
+}
+
+void transformVertices(const Mat4& m, const VertexSoA& in, VertexSoA& out, size_t begin, size_t end) {
+    if (out.size() != in.size() || begin > end || end > in.size())
+        throw std::runtime_error("invalid vertex range");
+    if (!out.hasW() && (in.hasW() || !isAffine(m)))
+        throw std::runtime_error("invalid vertex range: output needs a w lane");
+
+    const LanesIn src{in.x.data() + begin, in.y.data() + begin, in.z.data() + begin,
+                      in.hasW() ? in.w.data() + begin : nullptr};
+    const LanesOut dst{out.x.data() + begin, out.y.data() + begin, out.z.data() + begin,
+                       out.hasW() ? out.w.data() + begin : nullptr};
+    transformLanes(m, src, dst, end - begin, bestSimdPath());
+}
+
+void facingTest(const VertexSoA& normals, Vertex toEye, std::span<float> dots, std::span<std::uint64_t> mask) {
+    facingTest(normals, toEye, dots, mask, 0, normals.size());
+}
+
+void facingTest(const VertexSoA& normals, Vertex toEye, std::span<float> dots, std::span<std::uint64_t> mask,
+                size_t begin, size_t end) {
+    const size_t n = normals.size();
+    if (dots.size() < n || mask.size() < (n + 63) / 64)
+        throw std::runtime_error("invalid facing span size");
+    if (begin % 64 != 0 || begin > end || end > n)
+        throw std::runtime_error("invalid facing range");
+
+    const float* nx = normals.x.data();
+    const float* ny = normals.y.data();
+    const float* nz = normals.z.data();
+    std::fill(mask.begin() + begin / 64, mask.begin() + (end + 63) / 64, 0);
+
+    size_t i = begin;
+#if defined(MATH3D_X86)
+    // SSE2 is part of the x86-64 baseline, so no runtime dispatch is needed here.
+    // i stays a multiple of 4, so a group of 4 bits never straddles two mask words.
+    const __m128 ex = _mm_set1_ps(toEye.x);
+    const __m128 ey = _mm_set1_ps(toEye.y);
+    const __m128 ez = _mm_set1_ps(toEye.z);
+    const __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= end; i += 4) {
+        __m128 d = _mm_mul_ps(_mm_loadu_ps(nx + i), ex);
+        d = _mm_add_ps(d, _mm_mul_ps(_mm_loadu_ps(ny + i), ey));
+        d = _mm_add_ps(d, _mm_mul_ps(_mm_loadu_ps(nz + i), ez));
+        _mm_storeu_ps(dots.data() + i, d);
+        const auto bits = static_cast<std::uint64_t>(_mm_movemask_ps(_mm_cmpgt_ps(d, zero)));
+        mask[i >> 6] |= bits << (i & 63);
+    }
+#endif
+    for (; i < end; ++i) {
+        const float d = nx[i] * toEye.x + ny[i] * toEye.y + nz[i] * toEye.z;
+        dots[i] = d;
+        if (d > 0.0f) mask[i >> 6] |= std::uint64_t{1} << (i & 63);
+    }
+}
+
+}
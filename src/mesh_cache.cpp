@@ -0,0 +1,312 @@
+#include "mesh_cache.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace math3d {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr char kMagic[8] = {'M', '3', 'D', 'M', 'E', 'S', 'H', '\0'};
+constexpr std::uint32_t kByteOrderMark = 0x01020304u;
+constexpr std::uint64_t kSectionAlignment = 64;
+
+enum Section : std::uint32_t {
+    Vertices,
+    Edges,
+    FaceOffsets,
+    FaceIndices,
+    TriOffsets,
+    TriIndices,
+    EdgeKeys,
+    EdgeKeyIds,
+    EdgeFaceOffsets,
+    EdgeFaces,
+    FaceEdgeOffsets,
+    FaceEdges,
+    PairEdge,
+    PairFaceA,
+    PairFaceB,
+    NonManifoldEdges,
+    SectionCount
+};
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint64_t sourceSize;
+    std::int64_t sourceMtime;
+    std::uint32_t sectionCount;
+    std::uint32_t reserved;
+};
+
+struct SectionEntry {
+    std::uint32_t kind;
+    std::uint32_t elemSize;
+    std::uint64_t offset;
+    std::uint64_t count;
+};
+
+struct PendingSection {
+    const void* data;
+    std::uint32_t elemSize;
+    std::uint64_t count;
+};
+
+template <typename T>
+PendingSection pending(std::span<const T> s) {
+    return {s.data(), static_cast<std::uint32_t>(sizeof(T)), s.size()};
+}
+
+std::uint64_t alignUp(std::uint64_t n) { return (n + kSectionAlignment - 1) / kSectionAlignment * kSectionAlignment; }
+
+// Indices in [lowest, bound); the edge hash marks empty slots with -1.
+void checkIndices(std::span<const std::int32_t> indices, size_t bound, std::int32_t lowest = 0) {
+    for (std::int32_t i : indices)
+        if (i < lowest || (i >= 0 && static_cast<size_t>(i) >= bound)) throw std::runtime_error("invalid mesh cache index");
+}
+
+// CSR offsets for `rows` rows whose lengths are multiples of `stride`.
+void checkOffsets(std::span<const std::int32_t> offsets, size_t rows, size_t total, std::int32_t stride = 1) {
+    if (offsets.empty() || offsets.size() - 1 != rows || offsets.front() != 0 || static_cast<size_t>(offsets.back()) != total)
+        throw std::runtime_error("invalid mesh cache offsets");
+    for (size_t i = 0; i < rows; ++i)
+        if (offsets[i] > offsets[i + 1] || (offsets[i + 1] - offsets[i]) % stride != 0)
+            throw std::runtime_error("invalid mesh cache offsets");
+}
+
+}
+
+MeshSourceStamp MeshSourceStamp::of(const std::string& path) {
+    MeshSourceStamp s;
+    s.size = std::filesystem::file_size(path);
+    s.mtime = static_cast<std::int64_t>(std::filesystem::last_write_time(path).time_since_epoch().count());
+    return s;
+}
+
+void writeMeshCache(const std::string& path, const Object& o, const MeshSourceStamp& source) {
+    static_assert(std::is_trivially_copyable_v<Vertex> && sizeof(Vertex) == 16);
+
+    std::vector<std::int32_t> edges, faceOffsets{0}, faceIndices, triOffsets{0}, triIndices;
+    edges.reserve(o.edges.size() * 2);
+    for (const auto& [a, b] : o.edges) {
+        edges.push_back(a);
+        edges.push_back(b);
+    }
+    faceOffsets.reserve(o.planes.size() + 1);
+    triOffsets.reserve(o.planes.size() + 1);
+    for (const auto& pl : o.planes) {
+        faceIndices.insert(faceIndices.end(), pl.verts.begin(), pl.verts.end());
+        faceOffsets.push_back(static_cast<std::int32_t>(faceIndices.size()));
+        for (const auto& tri : pl.tris) triIndices.insert(triIndices.end(), tri.begin(), tri.end());
+        triOffsets.push_back(static_cast<std::int32_t>(triIndices.size()));
+    }
+
+    Topology built;
+    const Topology* topo = &o.topology;
+    if (o.topologyDirty) {
+        std::vector<std::vector<int>> faces;
+        faces.reserve(o.planes.size());
+        for (const auto& pl : o.planes) faces.push_back(pl.verts);
+        built.build(o.edges, faces);
+        topo = &built;
+    }
+    const Topology::Arrays t = topo->arrays();
+
+    const PendingSection sections[SectionCount] = {
+        pending(std::span<const Vertex>(o.original)),
+        pending(std::span<const std::int32_t>(edges)),
+        pending(std::span<const std::int32_t>(faceOffsets)),
+        pending(std::span<const std::int32_t>(faceIndices)),
+        pending(std::span<const std::int32_t>(triOffsets)),
+        pending(std::span<const std::int32_t>(triIndices)),
+        pending(t.edgeKeys),
+        pending(t.edgeKeyIds),
+        pending(t.edgeFaceOffsets),
+        pending(t.edgeFaces),
+        pending(t.faceEdgeOffsets),
+        pending(t.faceEdges),
+        pending(t.pairEdge),
+        pending(t.pairFaceA),
+        pending(t.pairFaceB),
+        pending(t.nonManifoldEdges),
+    };
+
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof kMagic);
+    header.version = kMeshCacheVersion;
+    header.byteOrder = kByteOrderMark;
+    header.sourceSize = source.size;
+    header.sourceMtime = source.mtime;
+    header.sectionCount = SectionCount;
+
+    SectionEntry table[SectionCount];
+    std::uint64_t offset = alignUp(sizeof header + sizeof table);
+    for (std::uint32_t k = 0; k < SectionCount; ++k) {
+        table[k] = {k, sections[k].elemSize, offset, sections[k].count};
+        offset = alignUp(offset + sections[k].count * sections[k].elemSize);
+    }
+
+    // Written next to the target and renamed into place, so a reader never maps a
+    // half-written cache. A failed write leaves no temporary behind.
+    const std::string tmp = path + ".tmp";
+    try {
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            if (!out) throw std::runtime_error("cannot write " + tmp);
+            out.write(reinterpret_cast<const char*>(&header), sizeof header);
+            out.write(reinterpret_cast<const char*>(table), sizeof table);
+            const char zeros[kSectionAlignment]{};
+            std::uint64_t written = sizeof header + sizeof table;
+            for (std::uint32_t k = 0; k < SectionCount; ++k) {
+                out.write(zeros, static_cast<std::streamsize>(table[k].offset - written));
+                const std::uint64_t n = sections[k].count * sections[k].elemSize;
+                out.write(static_cast<const char*>(sections[k].data), static_cast<std::streamsize>(n));
+                written = table[k].offset + n;
+            }
+            out.close();
+            if (!out) throw std::runtime_error("cannot write " + tmp);
+        }
+        std::filesystem::rename(tmp, path);
+    } catch (...) {
+        std::error_code ignored;
+        std::filesystem::remove(tmp, ignored);
+        throw;
+    }
+}
+
+MeshCache::MeshCache(const std::string& path) : file(path) {
+    bytes = file.map(0, static_cast<size_t>(file.size()));
+
+    FileHeader header;
+    if (bytes.size() < sizeof header) throw std::runtime_error("invalid mesh cache: truncated");
+    std::memcpy(&header, bytes.data(), sizeof header);
+    if (std::memcmp(header.magic, kMagic, sizeof kMagic) != 0) throw std::runtime_error("invalid mesh cache: bad magic");
+    if (header.version != kMeshCacheVersion) throw std::runtime_error("invalid mesh cache: version mismatch");
+    if (header.byteOrder != kByteOrderMark) throw std::runtime_error("invalid mesh cache: byte order mismatch");
+    if (header.sectionCount != SectionCount ||
+        bytes.size() < sizeof header + SectionCount * sizeof(SectionEntry))
+        throw std::runtime_error("invalid mesh cache: bad section table");
+
+    for (std::uint32_t k = 0; k < SectionCount; ++k) {
+        SectionEntry e;
+        std::memcpy(&e, bytes.data() + sizeof header + k * sizeof e, sizeof e);
+        if (e.kind != k || e.offset % kSectionAlignment != 0 || e.offset > bytes.size() ||
+            e.elemSize == 0 || e.count > (bytes.size() - e.offset) / e.elemSize)
+            throw std::runtime_error("invalid mesh cache: bad section table");
+    }
+    stamp = {header.sourceSize, header.sourceMtime};
+
+    // Every index is range-checked once here, so a corrupt file cannot make applyTo()
+    // or the Topology queries read out of bounds later.
+    const Topology::Arrays t = topology();
+    if (faceOffsets().empty()) throw std::runtime_error("invalid mesh cache offsets");
+    if (edges().size() % 2 != 0 || t.edgeKeys.size() != t.edgeKeyIds.size() || !Topology::validEdgeKeys(t.edgeKeys) ||
+        t.pairEdge.size() != t.pairFaceA.size() || t.pairEdge.size() != t.pairFaceB.size())
+        throw std::runtime_error("invalid mesh cache: inconsistent sections");
+    const size_t faceCount = faceOffsets().size() - 1, edgeCount = edges().size() / 2;
+    checkIndices(edges(), vertices().size());
+    checkOffsets(faceOffsets(), faceCount, faceIndices().size());
+    checkIndices(faceIndices(), vertices().size());
+    checkOffsets(triOffsets(), faceCount, triIndices().size(), 3);
+    checkIndices(triIndices(), vertices().size());
+    checkIndices(t.edgeKeyIds, edgeCount, -1);
+    checkOffsets(t.edgeFaceOffsets, edgeCount, t.edgeFaces.size());
+    checkIndices(t.edgeFaces, faceCount);
+    checkOffsets(t.faceEdgeOffsets, faceCount, t.faceEdges.size());
+    checkIndices(t.faceEdges, edgeCount);
+    checkIndices(t.pairEdge, edgeCount);
+    checkIndices(t.pairFaceA, faceCount);
+    checkIndices(t.pairFaceB, faceCount);
+    checkIndices(t.nonManifoldEdges, edgeCount);
+}
+
+template <typename T>
+std::span<const T> MeshCache::section(std::uint32_t kind) const {
+    SectionEntry e;
+    std::memcpy(&e, bytes.data() + sizeof(FileHeader) + kind * sizeof e, sizeof e);
+    if (e.elemSize != sizeof(T)) throw std::runtime_error("invalid mesh cache: element size mismatch");
+    return {reinterpret_cast<const T*>(bytes.data() + e.offset), static_cast<size_t>(e.count)};
+}
+
+std::span<const Vertex> MeshCache::vertices() const { return section<Vertex>(Vertices); }
+std::span<const std::int32_t> MeshCache::edges() const { return section<std::int32_t>(Edges); }
+std::span<const std::int32_t> MeshCache::faceOffsets() const { return section<std::int32_t>(FaceOffsets); }
+std::span<const std::int32_t> MeshCache::faceIndices() const { return section<std::int32_t>(FaceIndices); }
+std::span<const std::int32_t> MeshCache::triOffsets() const { return section<std::int32_t>(TriOffsets); }
+std::span<const std::int32_t> MeshCache::triIndices() const { return section<std::int32_t>(TriIndices); }
+
+Topology::Arrays MeshCache::topology() const {
+    return {section<std::uint64_t>(EdgeKeys),    section<std::int32_t>(EdgeKeyIds),
+            section<std::int32_t>(EdgeFaceOffsets), section<std::int32_t>(EdgeFaces),
+            section<std::int32_t>(FaceEdgeOffsets), section<std::int32_t>(FaceEdges),
+            section<std::int32_t>(PairEdge),    section<std::int32_t>(PairFaceA),
+            section<std::int32_t>(PairFaceB),   section<std::int32_t>(NonManifoldEdges)};
+}
+
+void MeshCache::applyTo(Object& o) const {
+    const auto v = vertices();
+    o.original.assign(v.begin(), v.end());
+
+    const auto e = edges();
+    o.edges.resize(e.size() / 2);
+    for (size_t i = 0; i < o.edges.size(); ++i) o.edges[i] = {e[2 * i], e[2 * i + 1]};
+
+    const auto fo = faceOffsets(), fi = faceIndices(), to = triOffsets(), ti = triIndices();
+    o.planes.resize(fo.size() - 1);
+    for (size_t f = 0; f + 1 < fo.size(); ++f) {
+        Plane& pl = o.planes[f];
+        pl.verts.assign(fi.begin() + fo[f], fi.begin() + fo[f + 1]);
+        pl.tris.clear();
+        for (std::int32_t k = to[f]; k < to[f + 1]; k += 3) pl.tris.push_back({ti[k], ti[k + 1], ti[k + 2]});
+    }
+
+    o.convex = false;
+    o.invalidate();
+    o.topology.assign(topology());
+    o.topologyDirty = false;
+}
+
+MeshLoadStats loadMeshCached(const std::string& path, Object& o, const MeshLoadOptions& options) {
+    const auto start = Clock::now();
+    const std::string cachePath = options.cachePath.empty() ? path + ".m3dc" : options.cachePath;
+    const MeshSourceStamp source = MeshSourceStamp::of(path);
+
+    if (std::filesystem::exists(cachePath)) {
+        try {
+            MeshCache cache(cachePath);
+            if (cache.source() == source) {
+                cache.applyTo(o);
+                MeshLoadStats st;
+                st.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+                st.bytes = std::filesystem::file_size(cachePath);
+                st.vertices = o.original.size();
+                st.faces = o.planes.size();
+                st.edges = o.edges.size();
+                st.fromCache = true;
+                return st;
+            }
+        } catch (const std::runtime_error&) {
+            // Corrupt or from another version: fall through and rebuild it.
+        }
+    }
+
+    MeshLoadStats st = loadMesh(path, o, options);
+    o.buildTopology();
+    try {
+        writeMeshCache(cachePath, o, source);
+    } catch (const std::runtime_error&) {
+        // A cache that cannot be written (e.g. read-only directory) only costs the next startup.
+    }
+    st.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return st;
+}
+
+}
@@ -0,0 +1,378 @@
+#include "mesh_io.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+
+#include "mapped_file.hpp"
+
+namespace math3d {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::string_view trimLeft(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    return s;
+}
+
+// Next whitespace-separated token; empty at end of line.
+std::string_view nextToken(std::string_view& s) {
+    s = trimLeft(s);
+    size_t n = 0;
+    while (n < s.size() && s[n] != ' ' && s[n] != '\t') ++n;
+    std::string_view tok = s.substr(0, n);
+    s.remove_prefix(n);
+    return tok;
+}
+
+template <typename T>
+T parseNumber(std::string_view tok) {
+    T v{};
+    if (!tok.empty() && tok.front() == '+') tok.remove_prefix(1);
+    auto [p, ec] = std::from_chars(tok.data(), tok.data() + tok.size(), v);
+    if (ec != std::errc{} || p != tok.data() + tok.size())
+        throw std::runtime_error("invalid number '" + std::string(tok) + "'");
+    return v;
+}
+
+// Unique undirected face sides, min index in the high half so the order matches
+// the sorted (a, b) pairs.
+void buildEdges(Object& o) {
+    std::vector<std::uint64_t> keys;
+    for (const auto& pl : o.planes) {
+        const size_t n = pl.verts.size();
+        for (size_t i = 0; i < n; ++i) {
+            auto a = static_cast<std::uint32_t>(pl.verts[i]);
+            auto b = static_cast<std::uint32_t>(pl.verts[(i + 1) % n]);
+            if (a > b) std::swap(a, b);
+            if (a != b) keys.push_back(std::uint64_t{a} << 32 | b);
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    o.edges.clear();
+    o.edges.reserve(keys.size());
+    for (std::uint64_t k : keys) o.edges.emplace_back(static_cast<int>(k >> 32), static_cast<int>(k & 0xffffffffu));
+}
+
+void addFace(Object& o, const std::vector<int>& corners) {
+    if (corners.size() < 3) throw std::runtime_error("invalid face with fewer than 3 corners");
+    Plane pl;
+    pl.verts = corners;
+    if (corners.size() > 3) {
+        pl.tris.reserve(corners.size() - 2);
+        for (size_t i = 1; i + 1 < corners.size(); ++i) pl.tris.push_back({corners[0], corners[i], corners[i + 1]});
+    }
+    o.planes.push_back(std::move(pl));
+}
+
+void reset(Object& o) {
+    o.original.clear();
+    o.edges.clear();
+    o.planes.clear();
+    o.convex = false;
+}
+
+MeshLoadStats finish(Object& o, std::uint64_t bytes, Clock::time_point start) {
+    // Checked once at the end: PLY may list faces before vertices.
+    for (const auto& pl : o.planes)
+        for (int i : pl.verts)
+            if (i < 0 || static_cast<size_t>(i) >= o.original.size()) throw std::runtime_error("invalid face index");
+    buildEdges(o);
+    o.invalidate();
+    o.invalidateTopology();
+
+    MeshLoadStats st;
+    st.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    st.bytes = bytes;
+    st.vertices = o.original.size();
+    st.faces = o.planes.size();
+    st.edges = o.edges.size();
+    return st;
+}
+
+// OBJ index: 1-based, or negative relative to the vertices read so far. Only the
+// position part of "v/vt/vn" is used.
+int objIndex(std::string_view tok, size_t vertexCount) {
+    tok = tok.substr(0, tok.find('/'));
+    const long long i = parseNumber<long long>(tok);
+    if (i > 0) return static_cast<int>(i - 1);
+    if (i < 0) return static_cast<int>(static_cast<long long>(vertexCount) + i);
+    throw std::runtime_error("invalid face index 0");
+}
+
+enum class PlyFormat { Ascii, BinaryLE, BinaryBE };
+enum class PlyType { Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64 };
+
+struct PlyProperty {
+    std::string name;
+    PlyType type{};
+    bool isList{false};
+    PlyType countType{};
+};
+
+struct PlyElement {
+    std::string name;
+    size_t count{};
+    std::vector<PlyProperty> props;
+};
+
+PlyType plyType(std::string_view s) {
+    if (s == "char" || s == "int8") return PlyType::Int8;
+    if (s == "uchar" || s == "uint8") return PlyType::UInt8;
+    if (s == "short" || s == "int16") return PlyType::Int16;
+    if (s == "ushort" || s == "uint16") return PlyType::UInt16;
+    if (s == "int" || s == "int32") return PlyType::Int32;
+    if (s == "uint" || s == "uint32") return PlyType::UInt32;
+    if (s == "float" || s == "float32") return PlyType::Float32;
+    if (s == "double" || s == "float64") return PlyType::Float64;
+    throw std::runtime_error("invalid PLY type '" + std::string(s) + "'");
+}
+
+size_t plySize(PlyType t) {
+    switch (t) {
+        case PlyType::Int8: case PlyType::UInt8: return 1;
+        case PlyType::Int16: case PlyType::UInt16: return 2;
+        case PlyType::Int32: case PlyType::UInt32: case PlyType::Float32: return 4;
+        case PlyType::Float64: return 8;
+    }
+    return 0;
+}
+
+// Most records of `e` that `bytesLeft` bytes can hold. A binary record takes at least
+// its fixed-size values and list counts (lists may be empty), and is counted as at
+// least 1 byte; an ASCII record at least a token and a line break, which the last
+// line may lack.
+std::uint64_t maxRecords(const PlyElement& e, PlyFormat format, std::uint64_t bytesLeft) {
+    if (format == PlyFormat::Ascii) return (bytesLeft + 1) / 2;
+    size_t n = 0;
+    for (const auto& p : e.props) n += plySize(p.isList ? p.countType : p.type);
+    return bytesLeft / std::max<size_t>(n, 1);
+}
+
+template <typename T>
+T loadScalar(const char* p, bool swap) {
+    unsigned char b[sizeof(T)];
+    std::memcpy(b, p, sizeof(T));
+    if (swap) std::reverse(b, b + sizeof(T));
+    T v;
+    std::memcpy(&v, b, sizeof(T));
+    return v;
+}
+
+double readBinary(const char* p, PlyType t, bool swap) {
+    switch (t) {
+        case PlyType::Int8: return loadScalar<std::int8_t>(p, swap);
+        case PlyType::UInt8: return loadScalar<std::uint8_t>(p, swap);
+        case PlyType::Int16: return loadScalar<std::int16_t>(p, swap);
+        case PlyType::UInt16: return loadScalar<std::uint16_t>(p, swap);
+        case PlyType::Int32: return loadScalar<std::int32_t>(p, swap);
+        case PlyType::UInt32: return loadScalar<std::uint32_t>(p, swap);
+        case PlyType::Float32: return loadScalar<float>(p, swap);
+        case PlyType::Float64: return loadScalar<double>(p, swap);
+    }
+    return 0;
+}
+
+// Reads one element instance, storing x/y/z and the face index list when present.
+class PlyRecordReader {
+public:
+    PlyRecordReader(SequentialReader& in, PlyFormat format) : in(in), format(format) {}
+
+    // Values of the properties of one record; list properties append to `list`.
+    void read(const PlyElement& e, double* xyz, std::vector<int>* list) {
+        if (format == PlyFormat::Ascii) readAscii(e, xyz, list);
+        else readBinaryRecord(e, xyz, list);
+    }
+
+private:
+    static int axis(const std::string& name) {
+        if (name == "x") return 0;
+        if (name == "y") return 1;
+        if (name == "z") return 2;
+        return -1;
+    }
+    static bool isIndexList(const std::string& name) {
+        return name == "vertex_indices" || name == "vertex_index";
+    }
+
+    void readAscii(const PlyElement& e, double* xyz, std::vector<int>* list) {
+        std::string_view line;
+        do {
+            if (!in.nextLine(line)) throw std::runtime_error("invalid PLY: unexpected end of file");
+            line = trimLeft(line);
+        } while (line.empty());
+
+        for (const auto& p : e.props) {
+            if (p.isList) {
+                const auto n = parseNumber<long long>(nextToken(line));
+                if (n < 0) throw std::runtime_error("invalid PLY list length");
+                const bool keep = list && isIndexList(p.name);
+                if (keep) list->clear();
+                for (long long k = 0; k < n; ++k) {
+                    std::string_view tok = nextToken(line);
+                    if (tok.empty()) throw std::runtime_error("invalid PLY: short list");
+                    if (keep) list->push_back(static_cast<int>(parseNumber<long long>(tok)));
+                }
+            } else {
+                std::string_view tok = nextToken(line);
+                if (tok.empty()) throw std::runtime_error("invalid PLY: short record");
+                const int a = xyz ? axis(p.name) : -1;
+                if (a >= 0) xyz[a] = parseNumber<double>(tok);
+            }
+        }
+    }
+
+    void readBinaryRecord(const PlyElement& e, double* xyz, std::vector<int>* list) {
+        const bool swap = (format == PlyFormat::BinaryBE) == (std::endian::native == std::endian::little);
+        for (const auto& p : e.props) {
+            if (p.isList) {
+                const size_t cs = plySize(p.countType);
+                const char* c = in.ensure(cs);
+                if (!c) throw std::runtime_error("invalid PLY: unexpected end of file");
+                const double nd = readBinary(c, p.countType, swap);
+                if (nd < 0) throw std::runtime_error("invalid PLY list length");
+                const auto n = static_cast<size_t>(nd);
+                in.advance(cs);
+
+                const size_t es = plySize(p.type);
+                const char* d = in.ensure(n * es);
+                if (!d && n) throw std::runtime_error("invalid PLY: unexpected end of file");
+                if (list && isIndexList(p.name)) {
+                    list->resize(n);
+                    for (size_t k = 0; k < n; ++k) (*list)[k] = static_cast<int>(readBinary(d + k * es, p.type, swap));
+                }
+                in.advance(n * es);
+            } else {
+                const size_t s = plySize(p.type);
+                const char* d = in.ensure(s);
+                if (!d) throw std::runtime_error("invalid PLY: unexpected end of file");
+                const int a = xyz ? axis(p.name) : -1;
+                if (a >= 0) xyz[a] = readBinary(d, p.type, swap);
+                in.advance(s);
+            }
+        }
+    }
+
+    SequentialReader& in;
+    PlyFormat format;
+};
+
+}
+
+MeshLoadStats loadObj(const std::string& path, Object& o, const MeshLoadOptions& options) {
+    const auto start = Clock::now();
+    SequentialReader in(path, options.windowBytes);
+    reset(o);
+
+    std::vector<int> corners;
+    std::string_view line;
+    while (in.nextLine(line)) {
+        line = trimLeft(line);
+        const std::string_view kind = nextToken(line);
+        if (kind == "v") {
+            Vertex v;
+            v.x = parseNumber<float>(nextToken(line));
+            v.y = parseNumber<float>(nextToken(line));
+            v.z = parseNumber<float>(nextToken(line));
+            o.original.push_back(v);
+        } else if (kind == "f") {
+            corners.clear();
+            for (std::string_view tok = nextToken(line); !tok.empty(); tok = nextToken(line))
+                corners.push_back(objIndex(tok, o.original.size()));
+            addFace(o, corners);
+        }
+        // Normals, texture coordinates, groups, materials and comments are ignored.
+    }
+    return finish(o, in.size(), start);
+}
+
+MeshLoadStats loadPly(const std::string& path, Object& o, const MeshLoadOptions& options) {
+    const auto start = Clock::now();
+    SequentialReader in(path, options.windowBytes);
+    reset(o);
+
+    std::string_view line;
+    if (!in.nextLine(line) || line != "ply") throw std::runtime_error("invalid PLY: missing magic");
+
+    PlyFormat format{PlyFormat::Ascii};
+    bool haveFormat = false;
+    std::vector<PlyElement> elements;
+    for (;;) {
+        if (!in.nextLine(line)) throw std::runtime_error("invalid PLY: missing end_header");
+        const std::string_view kw = nextToken(line);
+        if (kw == "end_header") break;
+        if (kw == "format") {
+            const std::string_view f = nextToken(line);
+            if (f == "ascii") format = PlyFormat::Ascii;
+            else if (f == "binary_little_endian") format = PlyFormat::BinaryLE;
+            else if (f == "binary_big_endian") format = PlyFormat::BinaryBE;
+            else throw std::runtime_error("invalid PLY format '" + std::string(f) + "'");
+            haveFormat = true;
+        } else if (kw == "element") {
+            PlyElement e;
+            e.name = std::string(nextToken(line));
+            e.count = parseNumber<size_t>(nextToken(line));
+            elements.push_back(std::move(e));
+        } else if (kw == "property") {
+            if (elements.empty()) throw std::runtime_error("invalid PLY: property before element");
+            PlyProperty p;
+            std::string_view t = nextToken(line);
+            if (t == "list") {
+                p.isList = true;
+                p.countType = plyType(nextToken(line));
+                t = nextToken(line);
+            }
+            p.type = plyType(t);
+            p.name = std::string(nextToken(line));
+            elements.back().props.push_back(std::move(p));
+        }
+        // comment / obj_info lines carry nothing we need.
+    }
+    if (!haveFormat) throw std::runtime_error("invalid PLY: missing format");
+
+    PlyRecordReader records(in, format);
+    std::vector<int> corners;
+    for (const auto& e : elements) {
+        // A header count the rest of the file cannot hold is rejected before anything is reserved.
+        if (e.count > maxRecords(e, format, in.size() - in.position()))
+            throw std::runtime_error("invalid PLY: " + e.name + " count exceeds the file size");
+        if (e.name == "vertex") {
+            o.original.reserve(o.original.size() + e.count);
+            for (size_t i = 0; i < e.count; ++i) {
+                double xyz[3]{};
+                records.read(e, xyz, nullptr);
+                o.original.push_back(make_vertex(static_cast<float>(xyz[0]), static_cast<float>(xyz[1]),
+                                                 static_cast<float>(xyz[2])));
+            }
+        } else if (e.name == "face") {
+            o.planes.reserve(o.planes.size() + e.count);
+            for (size_t i = 0; i < e.count; ++i) {
+                corners.clear();
+                records.read(e, nullptr, &corners);
+                addFace(o, corners);
+            }
+        } else {
+            for (size_t i = 0; i < e.count; ++i) records.read(e, nullptr, nullptr);
+        }
+    }
+    return finish(o, in.size(), start);
+}
+
+MeshLoadStats loadMesh(const std::string& path, Object& o, const MeshLoadOptions& options) {
+    const size_t dot = path.find_last_of('.');
+    std::string ext = dot == std::string::npos ? std::string() : path.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (ext == "obj") return loadObj(path, o, options);
+    if (ext == "ply") return loadPly(path, o, options);
+    throw std::runtime_error("invalid mesh extension '" + ext + "'");
+}
+
+}
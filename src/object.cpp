@@ -0,0 +1,256 @@
+#include "object.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "profiler.hpp"
+#include "task_scheduler.hpp"
+
+namespace math3d {
+
+namespace {
+
+// Minimum items per parallel piece. A piece has to cost well above the microsecond
+// or so a steal takes, so the cube and other small meshes never leave the caller.
+constexpr size_t kVertexGrain = 16384;
+constexpr size_t kFaceGrain = 4096;
+// Fixed block size of the centroid reduction; it sets the summation order, so it
+// must not depend on the thread count.
+constexpr size_t kCenterBlock = 4096;
+
+}
+
+void Object::forRange(size_t n, size_t minGrain, RangeBody body) const {
+    if (scheduler) scheduler->parallelFor(n, minGrain, body);
+    else body(0, n);
+}
+
+void Object::transformStream(const Mat4& m, std::span<const Vertex> in, std::vector<Vertex>& out) const {
+    out.resize(in.size());
+    const std::span<Vertex> dst(out);
+    forRange(in.size(), kVertexGrain, [&](size_t b, size_t e) {
+        transformVertices(m, in.subspan(b, e - b), dst.subspan(b, e - b));
+    });
+}
+
+void Object::transformStream(const Mat4& m, const VertexSoA& in, VertexSoA& out) const {
+    if (!scheduler) {
+        transformVertices(m, in, out);
+        return;
+    }
+    out.resize(in.size(), in.hasW() || !isAffine(m));
+    forRange(in.size(), kVertexGrain, [&](size_t b, size_t e) { transformVertices(m, in, out, b, e); });
+}
+
+bool Object::update() {
+    ++stats.updates;
+    if (!isDirty()) { ++stats.skipped; return false; }
+    recompute();
+    return true;
+}
+
+void Object::requestWorld() {
+    update();
+    computeWorld();
+}
+
+void Object::recompute() {
+    ProfileScope profile("recompute");
+    const bool worldChanged = modelDirty || viewDirty || geometryDirty;
+    const bool projectedChanged = worldChanged || projectionDirty;
+    if (geometryDirty && layout == VertexLayout::SoA) originalSoA.assign(original);
+    if (geometryDirty) bounds = Bounds::of(original);
+    if (worldChanged) worldValid = facingValid = false;
+    if (projectedChanged) projectedValid = false;
+    if (geometryDirty) normalsValid = false;
+    viewModel = matMul(view, model);
+    projViewModel = matMul(projection, viewModel);
+    modelDirty = viewDirty = projectionDirty = geometryDirty = false;
+
+    culled = frustumCulling && Frustum(projViewModel).outside(bounds);
+    if (culled) {
+        ++stats.culled;
+        return;
+    }
+
+    if (useRoberts) {
+        if (topologyDirty) {
+            ProfileScope stage("adjacency");
+            buildTopology();
+            normalsValid = facingValid = false;
+        }
+        if (!normalsValid || !facingValid) {
+            ProfileScope stage("facing");
+            if (!normalsValid) {
+                computeFaceNormals();
+                facingValid = false;
+            }
+            updateFaceFacingEye();
+            facingValid = true;
+        }
+    }
+
+    if (cpuProjection && !projectedValid) {
+        ProfileScope stage("projection");
+        const Mat4& m = worldValid ? projection : projViewModel;
+        if (layout == VertexLayout::SoA) transformStream(m, worldValid ? worldSoA : originalSoA, projectedSoA);
+        else transformStream(m, worldValid ? world : original, projected);
+        projectedValid = true;
+        ++stats.projectedPasses;
+        stats.transformedVertices += original.size();
+    }
+}
+
+void Object::computeWorld() {
+    if (worldValid) return;
+    if (layout == VertexLayout::SoA) transformStream(viewModel, originalSoA, worldSoA);
+    else transformStream(viewModel, original, world);
+    worldValid = true;
+    ++stats.worldPasses;
+    stats.transformedVertices += original.size();
+}
+
+void Object::setLayout(VertexLayout l) {
+    if (l == layout) return;
+    layout = l;
+    invalidate();
+}
+
+void Object::computeFaceNormals() {
+    Vertex c{0, 0, 0};
+    if (convex && !original.empty()) {
+        for (const auto& v : original) {
+            c.x += v.x;
+            c.y += v.y;
+            c.z += v.z;
+        }
+        c.x /= original.size();
+        c.y /= original.size();
+        c.z /= original.size();
+    }
+
+    faceNormals.resize(planes.size(), false);
+    forRange(planes.size(), kFaceGrain, [&](size_t first, size_t last) {
+        for (size_t pi = first; pi < last; ++pi) {
+            const auto& verts = planes[pi].verts;
+            Vertex n{0, 0, 0}, fc{0, 0, 0};
+            for (size_t i = 0; i < verts.size(); ++i) {
+                const Vertex& cur = original[verts[i]];
+                const Vertex& nxt = original[verts[(i + 1) % verts.size()]];
+                n.x += (cur.y - nxt.y) * (cur.z + nxt.z);
+                n.y += (cur.z - nxt.z) * (cur.x + nxt.x);
+                n.z += (cur.x - nxt.x) * (cur.y + nxt.y);
+                fc.x += cur.x;
+                fc.y += cur.y;
+                fc.z += cur.z;
+            }
+
+            const Vertex toFace{fc.x / verts.size() - c.x, fc.y / verts.size() - c.y, fc.z / verts.size() - c.z};
+            float len = std::sqrt(dot(n, n));
+            if (convex && dot(n, toFace) < 0.0f) len = -len;
+            if (len == 0.0f) len = 1.0f;
+            faceNormals.x[pi] = n.x / len;
+            faceNormals.y[pi] = n.y / len;
+            faceNormals.z[pi] = n.z / len;
+        }
+    });
+    normalsValid = true;
+}
+
+void Object::updateFaceFacingEye() {
+    transformStream(normalMatrix(viewModel), faceNormals, viewNormals);
+    const size_t n = planes.size();
+    faceDots.resize(n);
+    facing.resize((n + 63) / 64);
+    const Vertex toEye{-viewDirection.x, -viewDirection.y, -viewDirection.z};
+    // Ranges of whole mask words, so no two threads write the same word.
+    forRange(facing.size(), kFaceGrain / 64, [&](size_t wb, size_t we) {
+        facingTest(viewNormals, toEye, faceDots, facing, wb * 64, std::min(we * 64, n));
+    });
+    topology.visibleEdges(facing, visibleEdges);
+    ++facingVersion;
+}
+
+void Object::computeCenter() {
+    requestWorld();
+    const bool soa = layout == VertexLayout::SoA;
+    const size_t n = soa ? worldSoA.size() : world.size();
+    std::vector<Vertex> partial((n + kCenterBlock - 1) / kCenterBlock, Vertex{0, 0, 0});
+    forRange(partial.size(), kVertexGrain / kCenterBlock, [&](size_t first, size_t last) {
+        for (size_t b = first; b < last; ++b) {
+            Vertex s{0, 0, 0};
+            for (size_t i = b * kCenterBlock, end = std::min(n, i + kCenterBlock); i < end; ++i) {
+                const Vertex v = soa ? Vertex{worldSoA.x[i], worldSoA.y[i], worldSoA.z[i]} : world[i];
+                s.x += v.x;
+                s.y += v.y;
+                s.z += v.z;
+            }
+            partial[b] = s;
+        }
+    });
+
+    center = {0, 0, 0};
+    for (const auto& s : partial) {
+        center.x += s.x;
+        center.y += s.y;
+        center.z += s.z;
+    }
+    if (n != 0) {
+        center.x /= n;
+        center.y /= n;
+        center.z /= n;
+    }
+}
+
+void Object::buildTopology() {
+    std::vector<std::vector<int>> faces;
+    faces.reserve(planes.size());
+    for (const auto& pl : planes) faces.push_back(pl.verts);
+    topology.build(edges, faces);
+    topologyDirty = false;
+}
+
+Object builtinCube() {
+    Object o;
+    o.original = {
+        make_vertex(-0.2f, -0.2f, -0.2f), make_vertex( 0.2f, -0.2f, -0.2f),
+        make_vertex( 0.2f,  0.2f, -0.2f), make_vertex(-0.2f,  0.2f, -0.2f),
+        make_vertex(-0.2f, -0.2f,  0.2f), make_vertex( 0.2f, -0.2f,  0.2f),
+        make_vertex( 0.2f,  0.2f,  0.2f), make_vertex(-0.2f,  0.2f,  0.2f)
+    };
+    o.edges = {
+        {0,1},{1,2},{2,3},{3,0},
+        {4,5},{5,6},{6,7},{7,4},
+        {0,4},{1,5},{2,6},{3,7}
+    };
+    o.planes = {{{0,1,2,3},{}}, {{4,7,6,5},{}}, {{0,4,5,1},{}}, {{2,6,7,3},{}}, {{0,3,7,4},{}}, {{1,5,6,2},{}}};
+    return o;
+}
+
+Object builtinAxes() {
+    Object a;
+    a.original = { make_vertex(0,0,0), make_vertex(2,0,0),
+                   make_vertex(0,2,0), make_vertex(0,0,2) };
+    a.edges = {{0,1},{0,2},{0,3}};
+    a.useRoberts = false;
+    return a;
+}
+
+void fitToBuiltinCube(Object& o) {
+    if (o.original.empty()) return;
+    Vertex lo { o.original[0] }, hi { o.original[0] };
+    for (const auto& v : o.original) {
+        lo.x = std::min(lo.x, v.x); lo.y = std::min(lo.y, v.y); lo.z = std::min(lo.z, v.z);
+        hi.x = std::max(hi.x, v.x); hi.y = std::max(hi.y, v.y); hi.z = std::max(hi.z, v.z);
+    }
+    const float extent { std::max({hi.x - lo.x, hi.y - lo.y, hi.z - lo.z}) };
+    const float s { extent > 0 ? 0.4f / extent : 1.0f };
+    for (auto& v : o.original) {
+        v.x = (v.x - (lo.x + hi.x) * 0.5f) * s;
+        v.y = (v.y - (lo.y + hi.y) * 0.5f) * s;
+        v.z = (v.z - (lo.z + hi.z) * 0.5f) * s;
+    }
+    o.invalidate();
+}
+
+}
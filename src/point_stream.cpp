@@ -0,0 +1,271 @@
+#include "point_stream.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "mapped_file.hpp"
+
+namespace math3d {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kBinaryPointBytes = 3 * sizeof(float);
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+struct Chunk {
+    std::vector<Vertex> points;  // sized to chunkPoints once; count of them are used
+    size_t count{};
+    std::string bytes;           // the formatted output, reused between trips
+};
+
+// Blocking handoff between two stages. After close(), pop() drains what is left and
+// then returns null.
+class ChunkQueue {
+public:
+    void push(Chunk* c) {
+        {
+            std::lock_guard lock(mutex);
+            items.push_back(c);
+        }
+        ready.notify_one();
+    }
+    Chunk* pop() {
+        std::unique_lock lock(mutex);
+        ready.wait(lock, [&] { return !items.empty() || closed; });
+        if (items.empty()) return nullptr;
+        Chunk* c = items.front();
+        items.pop_front();
+        return c;
+    }
+    void close() {
+        {
+            std::lock_guard lock(mutex);
+            closed = true;
+        }
+        ready.notify_all();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<Chunk*> items;
+    bool closed{false};
+};
+
+std::string_view nextToken(std::string_view& s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    size_t n = 0;
+    while (n < s.size() && s[n] != ' ' && s[n] != '\t') ++n;
+    const std::string_view tok = s.substr(0, n);
+    s.remove_prefix(n);
+    return tok;
+}
+
+class PointReader {
+public:
+    PointReader(const std::string& path, PointFormat format, size_t windowBytes)
+        : in(path, windowBytes), format(format) {
+        if (format == PointFormat::Binary && in.size() % kBinaryPointBytes != 0)
+            throw std::runtime_error("invalid binary point file: size is not a multiple of 12");
+    }
+
+    std::uint64_t size() const { return in.size(); }
+    // Upper bound on the points in the file; the shortest text point is "0 0 0\n".
+    std::uint64_t maxPoints() const { return in.size() / (format == PointFormat::Binary ? kBinaryPointBytes : 6) + 1; }
+
+    // Fills c with up to c.points.size() points; c.count == 0 at the end of the file.
+    void read(Chunk& c) {
+        c.count = 0;
+        if (format == PointFormat::Binary) {
+            const std::uint64_t left = (in.size() - in.position()) / kBinaryPointBytes;
+            const size_t n = static_cast<size_t>(std::min<std::uint64_t>(c.points.size(), left));
+            if (n == 0) return;
+            const char* p = in.ensure(n * kBinaryPointBytes);
+            for (size_t i = 0; i < n; ++i, p += kBinaryPointBytes) {
+                float xyz[3];
+                std::memcpy(xyz, p, kBinaryPointBytes);
+                c.points[i] = {xyz[0], xyz[1], xyz[2], 1.0f};
+            }
+            in.advance(n * kBinaryPointBytes);
+            c.count = n;
+            return;
+        }
+        std::string_view line;
+        while (c.count < c.points.size() && in.nextLine(line)) {
+            ++lineNumber;
+            std::string_view rest = line;
+            const std::string_view first = nextToken(rest);
+            if (first.empty() || first.front() == '#') continue;
+            Vertex& v = c.points[c.count++];
+            v = {number(first), number(nextToken(rest)), number(nextToken(rest)), 1.0f};
+        }
+    }
+
+private:
+    float number(std::string_view tok) const {
+        if (!tok.empty() && tok.front() == '+') tok.remove_prefix(1);
+        float v{};
+        auto [p, ec] = std::from_chars(tok.data(), tok.data() + tok.size(), v);
+        if (ec != std::errc{} || p != tok.data() + tok.size() || tok.empty())
+            throw std::runtime_error("invalid point at line " + std::to_string(lineNumber));
+        return v;
+    }
+
+    SequentialReader in;
+    PointFormat format;
+    std::uint64_t lineNumber{};
+};
+
+void format(Chunk& c, PointFormat fmt) {
+    if (fmt == PointFormat::Binary) {
+        c.bytes.resize(c.count * kBinaryPointBytes);
+        char* p = c.bytes.data();
+        for (size_t i = 0; i < c.count; ++i, p += kBinaryPointBytes) {
+            const float xyz[3] = {c.points[i].x, c.points[i].y, c.points[i].z};
+            std::memcpy(p, xyz, kBinaryPointBytes);
+        }
+        return;
+    }
+    // Shortest representation that reads back to the same float.
+    c.bytes.clear();
+    char buf[64];
+    for (size_t i = 0; i < c.count; ++i) {
+        const Vertex& v = c.points[i];
+        char* p = std::to_chars(buf, buf + 20, v.x).ptr;
+        *p++ = ' ';
+        p = std::to_chars(p, p + 20, v.y).ptr;
+        *p++ = ' ';
+        p = std::to_chars(p, p + 20, v.z).ptr;
+        *p++ = '\n';
+        c.bytes.append(buf, p);
+    }
+}
+
+}
+
+PointFormat pointFormatFor(const std::string& path) {
+    const size_t dot = path.find_last_of('.');
+    std::string ext = dot == std::string::npos ? std::string() : path.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (ext == "xyz" || ext == "txt" || ext == "asc" || ext == "pts") return PointFormat::Xyz;
+    if (ext == "bin" || ext == "f32") return PointFormat::Binary;
+    throw std::runtime_error("invalid point file extension '" + ext + "'");
+}
+
+PointStreamStats transformPointFile(const std::string& inPath, PointFormat inFormat, const std::string& outPath,
+                                    PointFormat outFormat, const Mat4& m, const PointStreamOptions& options) {
+    if (!isAffine(m)) throw std::runtime_error("invalid point transform: not affine");
+    if (options.chunkPoints == 0 || options.chunksInFlight == 0) throw std::runtime_error("invalid point stream options");
+    std::error_code ec;
+    if (std::filesystem::equivalent(inPath, outPath, ec))
+        throw std::runtime_error("invalid point output: same file as input");
+
+    const auto start = Clock::now();
+    PointReader reader(inPath, inFormat, options.windowBytes);
+    std::ofstream out(outPath, std::ios::binary);
+    if (!out) throw std::runtime_error("cannot write " + outPath);
+
+    // Small files get small buffers.
+    const size_t chunkPoints = static_cast<size_t>(std::min<std::uint64_t>(options.chunkPoints, reader.maxPoints()));
+    std::vector<Chunk> chunks(options.chunksInFlight);
+    ChunkQueue empty, parsed, transformed;
+    for (auto& c : chunks) {
+        c.points.resize(chunkPoints);
+        empty.push(&c);
+    }
+
+    PointStreamStats st;
+    st.bytesRead = reader.size();
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    auto fail = [&] {
+        {
+            std::lock_guard lock(errorMutex);
+            if (!error) error = std::current_exception();
+        }
+        empty.close();
+        parsed.close();
+        transformed.close();
+    };
+
+    // Chunks go round empty -> parsed -> transformed -> empty, so at most
+    // chunksInFlight of them exist and none is allocated after the first lap.
+    std::thread readThread([&] {
+        try {
+            while (Chunk* c = empty.pop()) {
+                const auto t = Clock::now();
+                reader.read(*c);
+                st.readSeconds += secondsSince(t);
+                if (c->count == 0) break;
+                parsed.push(c);
+            }
+            parsed.close();
+        } catch (...) {
+            fail();
+        }
+    });
+    std::thread writeThread([&] {
+        try {
+            while (Chunk* c = transformed.pop()) {
+                const auto t = Clock::now();
+                format(*c, outFormat);
+                out.write(c->bytes.data(), static_cast<std::streamsize>(c->bytes.size()));
+                if (!out) throw std::runtime_error("cannot write " + outPath);
+                st.bytesWritten += c->bytes.size();
+                st.points += c->count;
+                st.writeSeconds += secondsSince(t);
+                empty.push(c);
+            }
+        } catch (...) {
+            fail();
+        }
+    });
+
+    try {
+        while (Chunk* c = parsed.pop()) {
+            const auto t = Clock::now();
+            const std::span<Vertex> points(c->points.data(), c->count);
+            if (options.scheduler) {
+                options.scheduler->parallelFor(points.size(), 1u << 14, [&](size_t b, size_t e) {
+                    transformVertices(m, points.subspan(b, e - b), points.subspan(b, e - b));
+                });
+            } else {
+                transformVertices(m, points, points);
+            }
+            st.transformSeconds += secondsSince(t);
+            transformed.push(c);
+        }
+        transformed.close();
+    } catch (...) {
+        fail();
+    }
+    readThread.join();
+    writeThread.join();
+    if (error) std::rethrow_exception(error);
+
+    out.close();
+    if (!out) throw std::runtime_error("cannot write " + outPath);
+    st.seconds = secondsSince(start);
+    return st;
+}
+
+}
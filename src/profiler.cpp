@@ -0,0 +1,160 @@
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+namespace math3d {
+
+namespace {
+
+std::atomic<std::uint32_t> nextThreadId{0};
+thread_local std::uint32_t threadId = nextThreadId.fetch_add(1, std::memory_order_relaxed);
+thread_local std::uint32_t openScopes = 0;
+
+// Nearest-rank percentile of sorted values.
+double percentile(const std::vector<double>& sorted, double p) {
+    const size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+    return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+}
+
+Profiler::Profiler(size_t capacity)
+    : slots(std::make_unique<Slot[]>(std::bit_ceil(std::max<size_t>(capacity, 1)))),
+      mask(std::bit_ceil(std::max<size_t>(capacity, 1)) - 1),
+      epoch(std::chrono::steady_clock::now()) {}
+
+std::uint64_t Profiler::now() const {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+}
+
+void Profiler::record(const char* name, std::uint64_t beginNs, std::uint64_t endNs, std::uint32_t depth) {
+    // Seqlock per slot: odd while the fields are written, 2 * index + 2 when done.
+    // Index i may only take its slot over from index i - capacity(), once that one
+    // is complete; otherwise two writers a lap apart could interleave their fields
+    // and leave either sequence behind.
+    const std::uint64_t index = head.fetch_add(1, std::memory_order_relaxed);
+    Slot& s = slots[index & mask];
+    const std::uint64_t previous = index > mask ? 2 * (index - capacity()) + 2 : 0;
+    for (std::uint64_t seen = previous;
+         !s.sequence.compare_exchange_weak(seen, 2 * index + 1, std::memory_order_acquire, std::memory_order_relaxed);
+         seen = previous)
+        std::this_thread::yield();
+    std::atomic_thread_fence(std::memory_order_release);
+    s.name.store(name, std::memory_order_relaxed);
+    s.begin.store(beginNs, std::memory_order_relaxed);
+    s.end.store(endNs, std::memory_order_relaxed);
+    s.frame.store(frame(), std::memory_order_relaxed);
+    s.thread.store(threadId, std::memory_order_relaxed);
+    s.depth.store(depth, std::memory_order_relaxed);
+    s.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+void Profiler::snapshot(std::vector<ProfileEvent>& out) const {
+    out.clear();
+    const std::uint64_t end = head.load(std::memory_order_acquire);
+    const std::uint64_t first = end > capacity() ? end - capacity() : 0;
+    for (std::uint64_t index = first; index < end; ++index) {
+        const Slot& s = slots[index & mask];
+        const std::uint64_t expected = 2 * index + 2;
+        if (s.sequence.load(std::memory_order_acquire) != expected) continue;
+        ProfileEvent e;
+        e.name = s.name.load(std::memory_order_relaxed);
+        e.beginNs = s.begin.load(std::memory_order_relaxed);
+        e.endNs = s.end.load(std::memory_order_relaxed);
+        e.frame = s.frame.load(std::memory_order_relaxed);
+        e.thread = s.thread.load(std::memory_order_relaxed);
+        e.depth = s.depth.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // Overwritten while we copied it.
+        if (s.sequence.load(std::memory_order_relaxed) != expected) continue;
+        out.push_back(e);
+    }
+}
+
+Profiler& Profiler::global() {
+    static Profiler instance;
+    return instance;
+}
+
+void ProfileScope::start(const char* name) {
+    label = name;
+    depth = openScopes++;
+    begin = target->now();
+}
+
+void ProfileScope::stop() {
+    const std::uint64_t end = target->now();
+    --openScopes;
+    target->record(label, begin, end, depth);
+}
+
+void ProfileReport::build(std::span<const ProfileEvent> events, std::uint64_t firstFrame, std::uint64_t endFrame) {
+    count = 0;
+    const size_t frames = endFrame > firstFrame ? static_cast<size_t>(endFrame - firstFrame) : 0;
+    if (frames == 0) return;
+
+    // Stage of an event by name; names are compared by content, since the same
+    // literal may have several addresses across translation units.
+    const auto stageOf = [&](const char* name) {
+        for (size_t i = 0; i < count; ++i)
+            if (list[i].name == name || std::strcmp(list[i].name, name) == 0) return i;
+        if (list.size() == count) list.emplace_back();
+        list[count] = {name};
+        const size_t needed = (count + 1) * frames;
+        if (perFrame.size() < needed) {
+            perFrame.resize(needed);
+            ran.resize(needed);
+        }
+        std::fill_n(perFrame.begin() + count * frames, frames, 0.0);
+        std::fill_n(ran.begin() + count * frames, frames, std::uint8_t{0});
+        return count++;
+    };
+
+    for (const ProfileEvent& e : events) {
+        if (e.frame < firstFrame || e.frame >= endFrame) continue;
+        const size_t slot = stageOf(e.name) * frames + static_cast<size_t>(e.frame - firstFrame);
+        perFrame[slot] += e.ms();
+        ran[slot] = 1;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        scratch.clear();
+        for (size_t f = 0; f < frames; ++f)
+            if (ran[i * frames + f]) scratch.push_back(perFrame[i * frames + f]);
+        std::sort(scratch.begin(), scratch.end());
+        Stage& s = list[i];
+        s.frames = scratch.size();
+        s.p50 = percentile(scratch, 0.50);
+        s.p95 = percentile(scratch, 0.95);
+        s.p99 = percentile(scratch, 0.99);
+        s.max = scratch.back();
+    }
+}
+
+void writeChromeTrace(const std::string& path, std::span<const ProfileEvent> events) {
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) throw std::runtime_error("cannot write " + path);
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", f);
+    for (size_t i = 0; i < events.size(); ++i) {
+        const ProfileEvent& e = events[i];
+        std::fputs(i ? ",\n{\"name\":\"" : "\n{\"name\":\"", f);
+        for (const char* c = e.name; *c; ++c) {
+            if (*c == '"' || *c == '\\') std::fputc('\\', f);
+            if (static_cast<unsigned char>(*c) >= 0x20) std::fputc(*c, f);
+        }
+        std::fprintf(f, "\",\"cat\":\"math3d\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"frame\":%llu}}",
+                     e.beginNs * 1e-3, (e.endNs - e.beginNs) * 1e-3, e.thread, static_cast<unsigned long long>(e.frame));
+    }
+    std::fputs("\n]}\n", f);
+    const bool ok = std::ferror(f) == 0;
+    if (std::fclose(f) != 0 || !ok) throw std::runtime_error("cannot write " + path);
+}
+
+}
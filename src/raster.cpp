@@ -0,0 +1,420 @@
+#include "raster.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "profiler.hpp"
+#include "task_scheduler.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MATH3D_X86 1
+#include <emmintrin.h>
+#endif
+
+namespace math3d {
+
+namespace {
+
+// Edge i of a triangle as (a, d): w(p) = d.x * (p.y - a.y) - d.y * (p.x - a.x).
+// Written out the same way in the scalar and SSE2 paths so both round identically.
+float edgeAt(float ax, float ay, float dx, float dy, float px, float py) {
+    return dx * (py - ay) - dy * (px - ax);
+}
+
+// Liang-Barsky against [0, w] x [0, h]; false when nothing is left. Keeps the DDA
+// length bounded by the viewport no matter how far off screen the endpoints are.
+template <typename L>
+bool clipLine(L& l, float w, float h) {
+    const float dx = l.x1 - l.x0, dy = l.y1 - l.y0;
+    float t0 = 0.0f, t1 = 1.0f;
+    const float p[4] = {-dx, dx, -dy, dy};
+    const float q[4] = {l.x0, w - l.x0, l.y0, h - l.y0};
+    for (int i = 0; i < 4; ++i) {
+        if (p[i] == 0.0f) {
+            if (q[i] < 0.0f) return false;
+            continue;
+        }
+        const float r = q[i] / p[i];
+        if (p[i] < 0.0f) t0 = std::max(t0, r);
+        else t1 = std::min(t1, r);
+        if (t0 > t1) return false;
+    }
+    const float x0 = l.x0, y0 = l.y0;
+    l.x0 = x0 + t0 * dx;
+    l.y0 = y0 + t0 * dy;
+    l.x1 = x0 + t1 * dx;
+    l.y1 = y0 + t1 * dy;
+    return true;
+}
+
+std::uint8_t toByte(float c) {
+    return static_cast<std::uint8_t>(std::lround(std::clamp(c, 0.0f, 1.0f) * 255.0f));
+}
+
+}
+
+std::uint32_t packRgba(Rgb c) {
+    const std::uint8_t bytes[4] = {toByte(c.r), toByte(c.g), toByte(c.b), 255};
+    std::uint32_t v;
+    std::memcpy(&v, bytes, sizeof v);
+    return v;
+}
+
+SoftwareRasterizer::SoftwareRasterizer(const RasterOptions& options) : opts(options) {
+    if (opts.width <= 0 || opts.height <= 0 || opts.tileSize <= 0)
+        throw std::runtime_error("invalid raster size");
+    tilesX = (opts.width + opts.tileSize - 1) / opts.tileSize;
+    tilesY = (opts.height + opts.tileSize - 1) / opts.tileSize;
+    colorBuffer.resize(static_cast<size_t>(opts.width) * opts.height);
+    depthBuffer.resize(colorBuffer.size());
+    faceRgba = packRgba(opts.faceColor);
+    lineRgba = packRgba(opts.lineColor);
+    clear();
+}
+
+void SoftwareRasterizer::clear() {
+    std::fill(colorBuffer.begin(), colorBuffer.end(), packRgba(opts.clearColor));
+    std::fill(depthBuffer.begin(), depthBuffer.end(), 1.0f);
+}
+
+void SoftwareRasterizer::setupTriangle(std::vector<Triangle>& out, Vertex v0, Vertex v1, Vertex v2) const {
+    // Viewport transform; row 0 is the top of the image.
+    std::array<Vertex, 3> s{v0, v1, v2};
+    for (auto& v : s) {
+        if (v.w <= 0.0f) return;  // behind the eye; there is no near-plane clipping
+        const float iw = 1.0f / v.w;
+        v = {(v.x * iw + 1.0f) * 0.5f * opts.width, (1.0f - v.y * iw) * 0.5f * opts.height, (v.z * iw + 1.0f) * 0.5f};
+    }
+
+    float area = (s[1].x - s[0].x) * (s[2].y - s[0].y) - (s[1].y - s[0].y) * (s[2].x - s[0].x);
+    if (area == 0.0f || !std::isfinite(area)) return;
+    if (area < 0.0f) {  // GL draws both windings (no face culling), so normalize instead of culling
+        std::swap(s[1], s[2]);
+        area = -area;
+    }
+
+    const float minX = std::min({s[0].x, s[1].x, s[2].x}), maxX = std::max({s[0].x, s[1].x, s[2].x});
+    const float minY = std::min({s[0].y, s[1].y, s[2].y}), maxY = std::max({s[0].y, s[1].y, s[2].y});
+    Triangle t;
+    // Pixels whose centers (x + 0.5) can be inside.
+    t.minX = std::max(0, static_cast<int>(std::ceil(minX - 0.5f)));
+    t.minY = std::max(0, static_cast<int>(std::ceil(minY - 0.5f)));
+    t.maxX = std::min(opts.width - 1, static_cast<int>(std::floor(maxX - 0.5f)));
+    t.maxY = std::min(opts.height - 1, static_cast<int>(std::floor(maxY - 0.5f)));
+    if (t.minX > t.maxX || t.minY > t.maxY) return;
+
+    for (int i = 0; i < 3; ++i) {
+        const Vertex& a = s[(i + 1) % 3];
+        const Vertex& b = s[(i + 2) % 3];
+        t.ax[i] = a.x;
+        t.ay[i] = a.y;
+        t.dx[i] = b.x - a.x;
+        t.dy[i] = b.y - a.y;
+        t.z[i] = s[i].z / area;
+        // Top-left rule: a pixel center exactly on an edge shared by two triangles
+        // belongs to only one of them.
+        t.topLeft[i] = (t.dy[i] == 0.0f && t.dx[i] > 0.0f) || t.dy[i] < 0.0f;
+    }
+    out.push_back(t);
+}
+
+void SoftwareRasterizer::rasterizeTile(size_t tile) {
+    const int tx0 = static_cast<int>(tile % tilesX) * opts.tileSize;
+    const int ty0 = static_cast<int>(tile / tilesX) * opts.tileSize;
+    const int tx1 = std::min(tx0 + opts.tileSize, opts.width) - 1;
+    const int ty1 = std::min(ty0 + opts.tileSize, opts.height) - 1;
+    const int w = opts.width;
+
+    for (size_t ci = 0; ci < chunkCount; ++ci) {
+        const Chunk& c = chunks[ci];
+        for (std::uint32_t k = c.triangleStart[tile]; k < c.triangleStart[tile + 1]; ++k) {
+            const Triangle& t = c.triangles[c.triangleIndex[k]];
+            const int x0 = std::max(tx0, t.minX), x1 = std::min(tx1, t.maxX);
+            const int y0 = std::max(ty0, t.minY), y1 = std::min(ty1, t.maxY);
+
+            // One pixel: covered, inside the depth range and nearer than what is there.
+            const auto shade = [&](int x, int y) {
+                const float px = x + 0.5f, py = y + 0.5f;
+                float e[3];
+                for (int i = 0; i < 3; ++i) {
+                    e[i] = edgeAt(t.ax[i], t.ay[i], t.dx[i], t.dy[i], px, py);
+                    if (t.topLeft[i] ? e[i] < 0.0f : e[i] <= 0.0f) return;
+                }
+                const float z = e[0] * t.z[0] + e[1] * t.z[1] + e[2] * t.z[2];
+                const size_t p = static_cast<size_t>(y) * w + x;
+                if (z < 0.0f || z > 1.0f || !(z < depthBuffer[p])) return;
+                depthBuffer[p] = z;
+                colorBuffer[p] = faceRgba;
+            };
+
+            for (int y = y0; y <= y1; ++y) {
+                int x = x0;
+#if defined(MATH3D_X86)
+                const __m128 py = _mm_set1_ps(y + 0.5f);
+                const __m128 zero = _mm_setzero_ps();
+                const __m128 one = _mm_set1_ps(1.0f);
+                const __m128i color = _mm_set1_epi32(static_cast<int>(faceRgba));
+                __m128 ax[3], ay[3], dx[3], dy[3], tz[3];
+                bool tl[3];
+                for (int i = 0; i < 3; ++i) {
+                    ax[i] = _mm_set1_ps(t.ax[i]);
+                    ay[i] = _mm_set1_ps(t.ay[i]);
+                    dx[i] = _mm_set1_ps(t.dx[i]);
+                    dy[i] = _mm_set1_ps(t.dy[i]);
+                    tz[i] = _mm_set1_ps(t.z[i]);
+                    tl[i] = t.topLeft[i];
+                }
+                for (; x + 3 <= x1; x += 4) {
+                    const __m128 px = _mm_add_ps(_mm_cvtepi32_ps(_mm_setr_epi32(x, x + 1, x + 2, x + 3)), _mm_set1_ps(0.5f));
+                    __m128 e[3];
+                    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                    for (int i = 0; i < 3; ++i) {
+                        e[i] = _mm_sub_ps(_mm_mul_ps(dx[i], _mm_sub_ps(py, ay[i])), _mm_mul_ps(dy[i], _mm_sub_ps(px, ax[i])));
+                        inside = _mm_and_ps(inside, tl[i] ? _mm_cmpge_ps(e[i], zero) : _mm_cmpgt_ps(e[i], zero));
+                    }
+                    if (_mm_movemask_ps(inside) == 0) continue;
+
+                    __m128 z = _mm_mul_ps(e[0], tz[0]);
+                    z = _mm_add_ps(z, _mm_mul_ps(e[1], tz[1]));
+                    z = _mm_add_ps(z, _mm_mul_ps(e[2], tz[2]));
+                    const size_t p = static_cast<size_t>(y) * w + x;
+                    const __m128 depth = _mm_loadu_ps(&depthBuffer[p]);
+                    __m128 pass = _mm_and_ps(inside, _mm_cmplt_ps(z, depth));
+                    pass = _mm_and_ps(pass, _mm_and_ps(_mm_cmpge_ps(z, zero), _mm_cmple_ps(z, one)));
+                    _mm_storeu_ps(&depthBuffer[p], _mm_or_ps(_mm_and_ps(pass, z), _mm_andnot_ps(pass, depth)));
+                    const __m128i passi = _mm_castps_si128(pass);
+                    const __m128i old = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&colorBuffer[p]));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(&colorBuffer[p]),
+                                     _mm_or_si128(_mm_and_si128(passi, color), _mm_andnot_si128(passi, old)));
+                }
+#endif
+                for (; x <= x1; ++x) shade(x, y);
+            }
+        }
+    }
+
+    // Lines go on top without a depth test. A DDA step is pixel floor(p0 + i/n * d);
+    // each tile draws the steps that land inside it, so a line's pixels do not
+    // depend on which tiles it was binned to.
+    for (size_t ci = 0; ci < chunkCount; ++ci) {
+        const Chunk& c = chunks[ci];
+        for (std::uint32_t k = c.lineStart[tile]; k < c.lineStart[tile + 1]; ++k) {
+            const Line& l = c.lines[c.lineIndex[k]];
+            const float dx = l.x1 - l.x0, dy = l.y1 - l.y0;
+            const int steps = std::max(1, static_cast<int>(std::ceil(std::max(std::fabs(dx), std::fabs(dy)))));
+            for (int i = 0; i <= steps; ++i) {
+                const float s = static_cast<float>(i) / steps;
+                const int x = static_cast<int>(std::floor(l.x0 + s * dx));
+                const int y = static_cast<int>(std::floor(l.y0 + s * dy));
+                if (x < tx0 || x > tx1 || y < ty0 || y > ty1) continue;
+                colorBuffer[static_cast<size_t>(y) * w + x] = lineRgba;
+            }
+        }
+    }
+}
+
+void SoftwareRasterizer::setupChunk(const Object& o, Chunk& c, size_t faceBegin, size_t faceEnd,
+                                    size_t edgeBegin, size_t edgeEnd) const {
+    c.triangles.clear();
+    c.lines.clear();
+    for (size_t f = faceBegin; f < faceEnd; ++f) {
+        if (!o.isFacing(f)) continue;
+        const Plane& pl = o.planes[f];
+        if (!pl.tris.empty()) {
+            for (const auto& tri : pl.tris)
+                setupTriangle(c.triangles, o.projectedAt(tri[0]), o.projectedAt(tri[1]), o.projectedAt(tri[2]));
+        } else {
+            for (size_t i = 1; i + 1 < pl.verts.size(); ++i)
+                setupTriangle(c.triangles, o.projectedAt(pl.verts[0]), o.projectedAt(pl.verts[i]),
+                              o.projectedAt(pl.verts[i + 1]));
+        }
+    }
+    for (size_t i = edgeBegin; i < edgeEnd; ++i) {
+        const auto& e = o.edges[o.useRoberts ? o.visibleEdges[i] : i];
+        const Vertex p = o.projectedAt(e.first), q = o.projectedAt(e.second);
+        if (p.w <= 0.0f || q.w <= 0.0f) continue;
+        Line l{(p.x / p.w + 1.0f) * 0.5f * opts.width, (1.0f - p.y / p.w) * 0.5f * opts.height,
+               (q.x / q.w + 1.0f) * 0.5f * opts.width, (1.0f - q.y / q.w) * 0.5f * opts.height};
+        if (clipLine(l, static_cast<float>(opts.width), static_cast<float>(opts.height))) c.lines.push_back(l);
+    }
+}
+
+namespace {
+
+// Counting sort of (item, tile) pairs into CSR bins; `forTiles(i, fn)` calls fn(tile)
+// for every tile item i touches. Items stay in order inside each bin.
+template <typename ForTiles>
+void fillBins(std::vector<std::uint32_t>& start, std::vector<std::uint32_t>& index, size_t tiles, size_t items,
+              ForTiles forTiles) {
+    start.assign(tiles + 1, 0);
+    for (size_t i = 0; i < items; ++i) forTiles(i, [&](size_t t) { ++start[t + 1]; });
+    for (size_t t = 0; t < tiles; ++t) start[t + 1] += start[t];
+    index.resize(start[tiles]);
+    // Fill using start[t] as the cursor, which leaves it at the end of bin t...
+    for (size_t i = 0; i < items; ++i)
+        forTiles(i, [&](size_t t) { index[start[t]++] = static_cast<std::uint32_t>(i); });
+    // ...and shift back so that start[t] is the beginning again.
+    for (size_t t = tiles; t > 0; --t) start[t] = start[t - 1];
+    start[0] = 0;
+}
+
+}
+
+void SoftwareRasterizer::binChunk(Chunk& c) const {
+    const size_t tiles = static_cast<size_t>(tilesX) * tilesY;
+    const int ts = opts.tileSize;
+    fillBins(c.triangleStart, c.triangleIndex, tiles, c.triangles.size(), [&](size_t i, auto&& bin) {
+        const Triangle& t = c.triangles[i];
+        for (int ty = t.minY / ts; ty <= t.maxY / ts; ++ty)
+            for (int tx = t.minX / ts; tx <= t.maxX / ts; ++tx) bin(static_cast<size_t>(ty) * tilesX + tx);
+    });
+    const auto tileOf = [&](float v, int limit) { return std::clamp(static_cast<int>(std::floor(v)), 0, limit - 1) / ts; };
+    fillBins(c.lineStart, c.lineIndex, tiles, c.lines.size(), [&](size_t i, auto&& bin) {
+        const Line& l = c.lines[i];
+        const int tx0 = tileOf(std::min(l.x0, l.x1), opts.width), tx1 = tileOf(std::max(l.x0, l.x1), opts.width);
+        const int ty0 = tileOf(std::min(l.y0, l.y1), opts.height), ty1 = tileOf(std::max(l.y0, l.y1), opts.height);
+        for (int ty = ty0; ty <= ty1; ++ty)
+            for (int tx = tx0; tx <= tx1; ++tx) bin(static_cast<size_t>(ty) * tilesX + tx);
+    });
+}
+
+void SoftwareRasterizer::draw(const Object& o, TaskScheduler* scheduler) {
+    ProfileScope profile("rasterize");
+    if (!o.cpuProjection) throw std::runtime_error("invalid object: software rasterizer needs cpuProjection");
+    if (o.culled) {
+        lastStats = {};
+        return;
+    }
+
+    // Chunk boundaries depend only on the mesh, never on the thread count, and each
+    // chunk keeps submission order; tiles then walk the chunks in order. That is what
+    // makes the depth test resolve ties the same way as drawing in order.
+    constexpr size_t kChunkFaces = 8192, kChunkEdges = 16384;
+    const size_t faces = o.useRoberts ? o.planes.size() : 0;
+    const size_t edges = o.useRoberts ? o.visibleEdges.size() : o.edges.size();
+    chunkCount = std::max({size_t{1}, (faces + kChunkFaces - 1) / kChunkFaces, (edges + kChunkEdges - 1) / kChunkEdges});
+    if (chunks.size() < chunkCount) chunks.resize(chunkCount);
+
+    const auto setup = [&](size_t begin, size_t end) {
+        for (size_t ci = begin; ci < end; ++ci) {
+            setupChunk(o, chunks[ci], std::min(faces, ci * kChunkFaces), std::min(faces, (ci + 1) * kChunkFaces),
+                       std::min(edges, ci * kChunkEdges), std::min(edges, (ci + 1) * kChunkEdges));
+            binChunk(chunks[ci]);
+        }
+    };
+    const size_t tiles = static_cast<size_t>(tilesX) * tilesY;
+    const auto rasterize = [&](size_t begin, size_t end) {
+        for (size_t tile = begin; tile < end; ++tile) rasterizeTile(tile);
+    };
+    if (scheduler) {
+        scheduler->parallelFor(chunkCount, 1, setup);
+        scheduler->parallelFor(tiles, 1, rasterize);
+    } else {
+        setup(0, chunkCount);
+        rasterize(0, tiles);
+    }
+
+    lastStats = {};
+    for (size_t ci = 0; ci < chunkCount; ++ci) {
+        lastStats.triangles += chunks[ci].triangles.size();
+        lastStats.binEntries += chunks[ci].triangleIndex.size();
+        lastStats.lines += chunks[ci].lines.size();
+    }
+}
+
+void writePpm(const std::string& path, const SoftwareRasterizer& r) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) throw std::runtime_error("cannot write " + path);
+    out << "P6\n" << r.width() << ' ' << r.height() << "\n255\n";
+    std::vector<char> row(static_cast<size_t>(r.width()) * 3);
+    for (int y = 0; y < r.height(); ++y) {
+        for (int x = 0; x < r.width(); ++x) std::memcpy(&row[static_cast<size_t>(x) * 3], &r.color()[static_cast<size_t>(y) * r.width() + x], 3);
+        out.write(row.data(), static_cast<std::streamsize>(row.size()));
+    }
+    if (!out) throw std::runtime_error("cannot write " + path);
+}
+
+namespace {
+
+std::uint32_t crc32(const unsigned char* data, size_t n, std::uint32_t crc = 0) {
+    static const auto table = [] {
+        std::array<std::uint32_t, 256> t{};
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            std::uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < n; ++i) crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+void putBE32(std::vector<unsigned char>& out, std::uint32_t v) {
+    for (int s = 24; s >= 0; s -= 8) out.push_back(static_cast<unsigned char>(v >> s));
+}
+
+void writeChunk(std::ofstream& out, const char type[4], const std::vector<unsigned char>& data) {
+    std::vector<unsigned char> chunk;
+    putBE32(chunk, static_cast<std::uint32_t>(data.size()));
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    putBE32(chunk, crc32(chunk.data() + 4, chunk.size() - 4));
+    out.write(reinterpret_cast<const char*>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+}
+
+}
+
+void writePng(const std::string& path, const SoftwareRasterizer& r) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) throw std::runtime_error("cannot write " + path);
+    const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    out.write(reinterpret_cast<const char*>(signature), sizeof signature);
+
+    std::vector<unsigned char> ihdr;
+    putBE32(ihdr, static_cast<std::uint32_t>(r.width()));
+    putBE32(ihdr, static_cast<std::uint32_t>(r.height()));
+    ihdr.insert(ihdr.end(), {8, 2, 0, 0, 0});  // 8-bit RGB, deflate, no filter, no interlace
+    writeChunk(out, "IHDR", ihdr);
+
+    // Scanlines (filter byte 0 + RGB) in stored deflate blocks inside a zlib stream.
+    std::vector<unsigned char> raw;
+    raw.reserve(static_cast<size_t>(r.height()) * (1 + 3 * static_cast<size_t>(r.width())));
+    for (int y = 0; y < r.height(); ++y) {
+        raw.push_back(0);
+        for (int x = 0; x < r.width(); ++x) {
+            unsigned char rgba[4];
+            std::memcpy(rgba, &r.color()[static_cast<size_t>(y) * r.width() + x], 4);
+            raw.insert(raw.end(), rgba, rgba + 3);
+        }
+    }
+    std::vector<unsigned char> z{0x78, 0x01};
+    for (size_t pos = 0; pos < raw.size() || pos == 0; ) {
+        const size_t n = std::min<size_t>(65535, raw.size() - pos);
+        const bool last = pos + n == raw.size();
+        z.push_back(last ? 1 : 0);
+        z.push_back(static_cast<unsigned char>(n & 0xff));
+        z.push_back(static_cast<unsigned char>(n >> 8));
+        z.push_back(static_cast<unsigned char>(~n & 0xff));
+        z.push_back(static_cast<unsigned char>((~n >> 8) & 0xff));
+        z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + n);
+        pos += n;
+        if (last) break;
+    }
+    std::uint32_t s1 = 1, s2 = 0;
+    for (unsigned char c : raw) {
+        s1 = (s1 + c) % 65521;
+        s2 = (s2 + s1) % 65521;
+    }
+    putBE32(z, (s2 << 16) | s1);
+    writeChunk(out, "IDAT", z);
+    writeChunk(out, "IEND", {});
+    if (!out) throw std::runtime_error("cannot write " + path);
+}
+
+}
@@ -0,0 +1,221 @@
+#include "rotation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MATH3D_X86 1
+#include <emmintrin.h>
+#endif
+
+namespace math3d {
+
+namespace {
+
+// Cephes sinf/cosf polynomials. The angle is reduced by j * pi/4 with j even, in double
+// with pi/4 split in two (Cody-Waite): kPiOver4Hi has 38 bits, so y * kPiOver4Hi is
+// exact for |a| <= 8192 and angles close to a multiple of pi/2 keep their low bits.
+constexpr float kFourOverPi = 1.27323954473516f;
+constexpr double kPiOver4Hi = 0.7853981633961666;
+constexpr double kPiOver4Lo = 1.2816720757972595e-12;
+constexpr float kSin0 = -1.6666654611e-1f, kSin1 = 8.3321608736e-3f, kSin2 = -1.9515295891e-4f;
+constexpr float kCos0 = 4.166664568298827e-2f, kCos1 = -1.388731625493765e-3f, kCos2 = 2.443315711809948e-5f;
+
+// The scalar and SSE2 paths below perform the same operations in the same order.
+inline void sinCosScalar(float a, float& s, float& c) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &a, 4);
+    const std::uint32_t sign = bits & 0x80000000u;
+    const float ax = std::fabs(a);
+
+    const std::int32_t j = (static_cast<std::int32_t>(ax * kFourOverPi) + 1) & ~1;
+    const double y = j;
+    const float x = static_cast<float>((ax - y * kPiOver4Hi) - y * kPiOver4Lo);
+    const float z = x * x;
+    const float ps = ((kSin2 * z + kSin1) * z + kSin0) * z * x + x;
+    const float pc = (((kCos2 * z + kCos1) * z + kCos0) * z * z - 0.5f * z) + 1.0f;
+
+    // Quadrant q = j / 2: sin is ps, pc, -ps, -pc and cos is pc, -ps, -pc, ps.
+    const std::int32_t q = (j >> 1) & 3;
+    const bool swap = (q & 1) != 0;
+    float sv = swap ? pc : ps;
+    float cv = swap ? ps : pc;
+    std::uint32_t sb, cb;
+    std::memcpy(&sb, &sv, 4);
+    std::memcpy(&cb, &cv, 4);
+    sb ^= (static_cast<std::uint32_t>(q & 2) << 30) ^ sign;
+    cb ^= static_cast<std::uint32_t>((q + 1) & 2) << 30;
+    std::memcpy(&s, &sb, 4);
+    std::memcpy(&c, &cb, 4);
+}
+
+#if defined(MATH3D_X86)
+// Two lanes of the reduction; the results land in the low half.
+inline __m128 reduce2(__m128d ax, __m128d y) {
+    const __m128d x = _mm_sub_pd(ax, _mm_mul_pd(y, _mm_set1_pd(kPiOver4Hi)));
+    return _mm_cvtpd_ps(_mm_sub_pd(x, _mm_mul_pd(y, _mm_set1_pd(kPiOver4Lo))));
+}
+
+inline void sinCos4(const float* a, float* s, float* c) {
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(0x80000000u)));
+    const __m128 v = _mm_loadu_ps(a);
+    const __m128 sign = _mm_and_ps(v, signMask);
+    const __m128 ax = _mm_andnot_ps(signMask, v);
+
+    __m128i j = _mm_cvttps_epi32(_mm_mul_ps(ax, _mm_set1_ps(kFourOverPi)));
+    j = _mm_and_si128(_mm_add_epi32(j, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+    const __m128 x = _mm_movelh_ps(reduce2(_mm_cvtps_pd(ax), _mm_cvtepi32_pd(j)),
+                                   reduce2(_mm_cvtps_pd(_mm_movehl_ps(ax, ax)),
+                                           _mm_cvtepi32_pd(_mm_shuffle_epi32(j, _MM_SHUFFLE(1, 0, 3, 2)))));
+    const __m128 z = _mm_mul_ps(x, x);
+
+    __m128 ps = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(kSin2), z), _mm_set1_ps(kSin1));
+    ps = _mm_add_ps(_mm_mul_ps(ps, z), _mm_set1_ps(kSin0));
+    ps = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(ps, z), x), x);
+    __m128 pc = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(kCos2), z), _mm_set1_ps(kCos1));
+    pc = _mm_add_ps(_mm_mul_ps(pc, z), _mm_set1_ps(kCos0));
+    pc = _mm_mul_ps(_mm_mul_ps(pc, z), z);
+    pc = _mm_add_ps(_mm_sub_ps(pc, _mm_mul_ps(_mm_set1_ps(0.5f), z)), _mm_set1_ps(1.0f));
+
+    const __m128i q = _mm_and_si128(_mm_srli_epi32(j, 1), _mm_set1_epi32(3));
+    const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+    const __m128 sv = _mm_or_ps(_mm_and_ps(swap, pc), _mm_andnot_ps(swap, ps));
+    const __m128 cv = _mm_or_ps(_mm_and_ps(swap, ps), _mm_andnot_ps(swap, pc));
+    const __m128 sinFlip = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, _mm_set1_epi32(2)), 30));
+    const __m128 cosFlip = _mm_castsi128_ps(
+        _mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+    _mm_storeu_ps(s, _mm_xor_ps(_mm_xor_ps(sv, sinFlip), sign));
+    _mm_storeu_ps(c, _mm_xor_ps(cv, cosFlip));
+}
+#endif
+
+// The closed form of rotX * rotY * rotZ; same products as the matrix chain, fewer of them.
+inline void eulerFromSinCos(float sx, float cx, float sy, float cy, float sz, float cz, Affine3x4& r) {
+    r = Affine3x4{{cy * cz, cy * sz, -sy, 0,
+                   sx * sy * cz - cx * sz, sx * sy * sz + cx * cz, sx * cy, 0,
+                   cx * sy * cz + sx * sz, cx * sy * sz - sx * cz, cx * cy, 0}};
+}
+
+// Repo rotations turn by -a about their axis (see rotX), hence the negated half-sine.
+inline Quat axisQuat(float a, int axis) {
+    float s, c;
+    sinCos(0.5f * a, s, c);
+    Quat q{c, 0, 0, 0};
+    (axis == 0 ? q.x : axis == 1 ? q.y : q.z) = -s;
+    return q;
+}
+
+}
+
+void sinCos(float a, float& s, float& c) {
+    sinCosScalar(a, s, c);
+}
+
+void sinCos(std::span<const float> a, std::span<float> s, std::span<float> c) {
+    if (s.size() != a.size() || c.size() != a.size()) throw std::runtime_error("invalid rotation span size");
+    size_t i = 0;
+#if defined(MATH3D_X86)
+    for (; i + 4 <= a.size(); i += 4) sinCos4(a.data() + i, s.data() + i, c.data() + i);
+#endif
+    for (; i < a.size(); ++i) sinCosScalar(a[i], s[i], c[i]);
+}
+
+Affine3x4 eulerXYZ(float x, float y, float z) {
+    float sx, cx, sy, cy, sz, cz;
+    sinCos(x, sx, cx);
+    sinCos(y, sy, cy);
+    sinCos(z, sz, cz);
+    Affine3x4 r;
+    eulerFromSinCos(sx, cx, sy, cy, sz, cz, r);
+    return r;
+}
+
+void eulerXYZ(std::span<const float> x, std::span<const float> y, std::span<const float> z, std::span<Affine3x4> out) {
+    if (y.size() != x.size() || z.size() != x.size() || out.size() != x.size())
+        throw std::runtime_error("invalid rotation span size");
+    // Sines and cosines a block at a time on the vector path, then the closed form.
+    constexpr size_t kBlock = 64;
+    float sx[kBlock], cx[kBlock], sy[kBlock], cy[kBlock], sz[kBlock], cz[kBlock];
+    for (size_t base = 0; base < x.size(); base += kBlock) {
+        const size_t n = std::min(kBlock, x.size() - base);
+        sinCos(x.subspan(base, n), std::span(sx, n), std::span(cx, n));
+        sinCos(y.subspan(base, n), std::span(sy, n), std::span(cy, n));
+        sinCos(z.subspan(base, n), std::span(sz, n), std::span(cz, n));
+        for (size_t i = 0; i < n; ++i) eulerFromSinCos(sx[i], cx[i], sy[i], cy[i], sz[i], cz[i], out[base + i]);
+    }
+}
+
+void EulerXYZ::applyTo(Affine3x4& acc) const {
+    const Affine3x4 r { affine() };
+    for (int i = 0; i < 3; ++i) {
+        const float a = acc(i, 0), b = acc(i, 1), c = acc(i, 2);
+        for (int j = 0; j < 3; ++j) acc(i, j) = a * r(0, j) + b * r(1, j) + c * r(2, j);
+    }
+}
+
+Quat quatX(float a) { return axisQuat(a, 0); }
+Quat quatY(float a) { return axisQuat(a, 1); }
+Quat quatZ(float a) { return axisQuat(a, 2); }
+
+Quat quatEulerXYZ(float x, float y, float z) {
+    return quatX(x) * quatY(y) * quatZ(z);
+}
+
+Quat operator*(const Quat& a, const Quat& b) {
+    return {a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+            a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+            a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+            a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w};
+}
+
+float dot(const Quat& a, const Quat& b) {
+    return a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+Quat normalize(const Quat& q) {
+    const float n = std::sqrt(dot(q, q));
+    if (n == 0.0f || !std::isfinite(n)) return {};
+    return {q.w / n, q.x / n, q.y / n, q.z / n};
+}
+
+Quat slerp(const Quat& a, const Quat& b, float t) {
+    float d = dot(a, b);
+    Quat e { b };
+    if (d < 0.0f) {
+        d = -d;
+        e = {-b.w, -b.x, -b.y, -b.z};
+    }
+    float wa = 1.0f - t, wb = t;
+    // Close quaternions: sin(theta) loses precision, and lerp is already accurate.
+    if (d < 0.9995f) {
+        const float theta = std::acos(d);
+        const float inv = 1.0f / std::sin(theta);
+        wa = std::sin((1.0f - t) * theta) * inv;
+        wb = std::sin(t * theta) * inv;
+    }
+    return normalize({wa * a.w + wb * e.w, wa * a.x + wb * e.x, wa * a.y + wb * e.y, wa * a.z + wb * e.z});
+}
+
+Affine3x4 toAffine(const Quat& q) {
+    const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    const float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+    return {{1 - 2 * (yy + zz), 2 * (xy - wz), 2 * (xz + wy), 0,
+             2 * (xy + wz), 1 - 2 * (xx + zz), 2 * (yz - wx), 0,
+             2 * (xz - wy), 2 * (yz + wx), 1 - 2 * (xx + yy), 0}};
+}
+
+void toAffine(std::span<const Quat> q, std::span<Affine3x4> out) {
+    if (out.size() != q.size()) throw std::runtime_error("invalid rotation span size");
+    for (size_t i = 0; i < q.size(); ++i) out[i] = toAffine(q[i]);
+}
+
+void slerp(std::span<const Quat> a, std::span<const Quat> b, float t, std::span<Affine3x4> out) {
+    if (b.size() != a.size() || out.size() != a.size()) throw std::runtime_error("invalid rotation span size");
+    for (size_t i = 0; i < a.size(); ++i) out[i] = toAffine(slerp(a[i], b[i], t));
+}
+
+}
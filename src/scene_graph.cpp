@@ -0,0 +1,198 @@
+#include "scene_graph.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "object.hpp"
+#include "profiler.hpp"
+#include "task_scheduler.hpp"
+
+namespace math3d {
+
+namespace {
+
+// Dirty subtrees handed out per parallel piece; most are a handful of nodes.
+constexpr size_t kRangeGrain = 256;
+
+}
+
+SceneGraph::NodeId SceneGraph::addNode(NodeId parent, const Mat4& local, Object* object) {
+    if (parent != kNone && parent >= size()) throw std::runtime_error("invalid parent node");
+    const auto slot = static_cast<std::uint32_t>(idAt.size());
+    const NodeId id = static_cast<NodeId>(slotOf.size());
+    const std::uint32_t ps = parent == kNone ? kNone : slotOf[parent];
+    idAt.push_back(id);
+    parentSlot.push_back(ps);
+    subtreeEnd.push_back(slot + 1);
+    locals.push_back(local);
+    worlds.push_back(local);
+    objects.push_back(object);
+    slotOf.push_back(slot);
+
+    // Appending stays depth-first when the parent's subtree ends at the end of the
+    // arrays; then so do all of its ancestors', and they simply grow by one.
+    if (ps != kNone) {
+        if (orderValid && subtreeEnd[ps] == slot) {
+            for (std::uint32_t s = ps; s != kNone; s = parentSlot[s]) subtreeEnd[s] = slot + 1;
+        } else {
+            orderValid = false;
+        }
+    }
+    if (object) {
+        object->setView(viewMatrix);
+        object->setProjection(projectionMatrix);
+    }
+    markDirty(id);
+    return id;
+}
+
+void SceneGraph::setParent(NodeId node, NodeId parent) {
+    const std::uint32_t s = slotOf.at(node);
+    if (parent != kNone && parent >= size()) throw std::runtime_error("invalid parent node");
+    const std::uint32_t ps = parent == kNone ? kNone : slotOf[parent];
+    for (std::uint32_t a = ps; a != kNone; a = parentSlot[a])
+        if (a == s) throw std::runtime_error("invalid parent node: would create a cycle");
+    if (parentSlot[s] == ps) return;
+    parentSlot[s] = ps;
+    orderValid = false;
+    markDirty(node);
+}
+
+void SceneGraph::setLocal(NodeId node, const Mat4& local) {
+    const std::uint32_t s = slotOf.at(node);
+    if (local == locals[s]) return;
+    locals[s] = local;
+    markDirty(node);
+}
+
+void SceneGraph::setObject(NodeId node, Object* object) {
+    objects[slotOf.at(node)] = object;
+    if (!object) return;
+    object->setView(viewMatrix);
+    object->setProjection(projectionMatrix);
+    markDirty(node);
+}
+
+void SceneGraph::setView(const Mat4& v) {
+    if (v == viewMatrix) return;
+    viewMatrix = v;
+    cameraDirty = true;
+}
+
+void SceneGraph::setProjection(const Mat4& p) {
+    if (p == projectionMatrix) return;
+    projectionMatrix = p;
+    cameraDirty = true;
+}
+
+SceneGraph::NodeId SceneGraph::parent(NodeId node) const {
+    const std::uint32_t ps = parentSlot[slotOf.at(node)];
+    return ps == kNone ? kNone : idAt[ps];
+}
+
+void SceneGraph::reorder() {
+    const size_t n = idAt.size();
+    // Children per slot as CSR, keeping their current relative order.
+    std::vector<std::uint32_t> childStart(n + 1, 0), children(n), roots;
+    for (size_t s = 0; s < n; ++s) {
+        if (parentSlot[s] == kNone) roots.push_back(static_cast<std::uint32_t>(s));
+        else ++childStart[parentSlot[s] + 1];
+    }
+    for (size_t s = 0; s < n; ++s) childStart[s + 1] += childStart[s];
+    std::vector<std::uint32_t> cursor(childStart.begin(), childStart.end() - 1);
+    for (size_t s = 0; s < n; ++s)
+        if (parentSlot[s] != kNone) children[cursor[parentSlot[s]]++] = static_cast<std::uint32_t>(s);
+
+    std::vector<std::uint32_t> order, stack(roots.rbegin(), roots.rend());
+    order.reserve(n);
+    while (!stack.empty()) {
+        const std::uint32_t s = stack.back();
+        stack.pop_back();
+        order.push_back(s);
+        for (std::uint32_t c = childStart[s + 1]; c > childStart[s]; --c) stack.push_back(children[c - 1]);
+    }
+
+    std::vector<std::uint32_t> newSlot(n);
+    for (size_t i = 0; i < n; ++i) newSlot[order[i]] = static_cast<std::uint32_t>(i);
+    std::vector<NodeId> ids(n);
+    std::vector<std::uint32_t> parents(n);
+    std::vector<Mat4> ls(n), ws(n);
+    std::vector<Object*> os(n);
+    for (size_t i = 0; i < n; ++i) {
+        const std::uint32_t old = order[i];
+        ids[i] = idAt[old];
+        parents[i] = parentSlot[old] == kNone ? kNone : newSlot[parentSlot[old]];
+        ls[i] = locals[old];
+        ws[i] = worlds[old];
+        os[i] = objects[old];
+        slotOf[ids[i]] = static_cast<std::uint32_t>(i);
+    }
+    idAt.swap(ids);
+    parentSlot.swap(parents);
+    locals.swap(ls);
+    worlds.swap(ws);
+    objects.swap(os);
+
+    // Children come after their parent, so one backwards pass closes every subtree.
+    for (size_t s = 0; s < n; ++s) subtreeEnd[s] = static_cast<std::uint32_t>(s + 1);
+    for (size_t s = n; s-- > 0;)
+        if (parentSlot[s] != kNone) subtreeEnd[parentSlot[s]] = std::max(subtreeEnd[parentSlot[s]], subtreeEnd[s]);
+    orderValid = true;
+    ++stats.reorders;
+}
+
+size_t SceneGraph::update(TaskScheduler* scheduler) {
+    ProfileScope profile("scene graph");
+    ++stats.updates;
+    rangeBegin.clear();
+    if (!orderValid) {
+        // Rare (structural edits); recompute everything in the new order.
+        reorder();
+        for (std::uint32_t s = 0; s < idAt.size(); s = subtreeEnd[s]) rangeBegin.push_back(s);
+    } else {
+        // Dirty nodes in slot order; any that sit inside an earlier dirty subtree are
+        // covered by it.
+        for (NodeId id : dirty) rangeBegin.push_back(slotOf[id]);
+        std::sort(rangeBegin.begin(), rangeBegin.end());
+        size_t kept = 0;
+        std::uint32_t coveredEnd = 0;
+        for (std::uint32_t s : rangeBegin) {
+            if (s < coveredEnd) continue;
+            rangeBegin[kept++] = s;
+            coveredEnd = subtreeEnd[s];
+        }
+        rangeBegin.resize(kept);
+    }
+    dirty.clear();
+
+    // Parents precede children inside a range, and a range's root reads only its
+    // parent's world, which is outside every dirty range. Ranges are disjoint.
+    const auto recompute = [&](size_t first, size_t last) {
+        for (size_t r = first; r < last; ++r) {
+            for (std::uint32_t s = rangeBegin[r], end = subtreeEnd[s]; s < end; ++s) {
+                const std::uint32_t p = parentSlot[s];
+                worlds[s] = p == kNone ? locals[s] : matMul(worlds[p], locals[s]);
+                if (objects[s]) objects[s]->setModel(worlds[s]);
+            }
+        }
+    };
+    if (scheduler) scheduler->parallelFor(rangeBegin.size(), kRangeGrain, recompute);
+    else recompute(0, rangeBegin.size());
+
+    size_t count = 0;
+    for (std::uint32_t s : rangeBegin) count += subtreeEnd[s] - s;
+
+    if (cameraDirty) {
+        for (Object* o : objects) {
+            if (!o) continue;
+            o->setView(viewMatrix);
+            o->setProjection(projectionMatrix);
+        }
+        cameraDirty = false;
+    }
+    stats.recomputed += count;
+    stats.subtrees += rangeBegin.size();
+    return count;
+}
+
+}
@@ -0,0 +1,133 @@
+#include "task_scheduler.hpp"
+
+#include <algorithm>
+
+namespace math3d {
+
+namespace {
+
+thread_local const void* currentPool = nullptr;
+thread_local size_t currentQueue = 0;
+
+}
+
+TaskScheduler::TaskScheduler(unsigned threads) {
+    const unsigned total = std::max(1u, threads);
+    for (unsigned i = 0; i < total; ++i) queues.push_back(std::make_unique<Queue>());
+    workers.reserve(total - 1);
+    for (unsigned i = 0; i + 1 < total; ++i) workers.emplace_back([this, i] { workerMain(i); });
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& t : workers) t.join();
+}
+
+TaskScheduler& TaskScheduler::global() {
+    static TaskScheduler pool;
+    return pool;
+}
+
+size_t TaskScheduler::grainFor(size_t n, size_t minGrain) const {
+    const size_t pieces = size_t{8} * threadCount();
+    return std::max<size_t>({minGrain, (n + pieces - 1) / pieces, 1});
+}
+
+size_t TaskScheduler::queueIndex() const {
+    return currentPool == this ? currentQueue : queues.size() - 1;
+}
+
+void TaskScheduler::push(size_t q, Range r) {
+    {
+        std::lock_guard lock(queues[q]->mutex);
+        queues[q]->ranges.push_back(r);
+        queued.fetch_add(1, std::memory_order_release);
+    }
+    // Taking the sleep mutex orders this push against a worker that is between
+    // checking `queued` and blocking, so the wake-up cannot be lost.
+    { std::lock_guard lock(sleepMutex); }
+    wake.notify_one();
+}
+
+bool TaskScheduler::pop(size_t q, Range& r) {
+    std::lock_guard lock(queues[q]->mutex);
+    auto& ranges = queues[q]->ranges;
+    if (ranges.empty()) return false;
+    r = ranges.back();
+    ranges.pop_back();
+    queued.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool TaskScheduler::steal(size_t q, Range& r) {
+    for (size_t k = 1; k < queues.size(); ++k) {
+        Queue& victim = *queues[(q + k) % queues.size()];
+        std::lock_guard lock(victim.mutex);
+        if (victim.ranges.empty()) continue;
+        r = victim.ranges.front();
+        victim.ranges.pop_front();
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void TaskScheduler::run(size_t q, Range r) {
+    Loop& loop = *r.loop;
+    // Split lazily: only ranges that are actually executed get halved, so the number
+    // of pieces adapts to how many threads are free to steal them.
+    while (r.end - r.begin > loop.grain) {
+        const size_t mid = r.begin + (r.end - r.begin) / 2;
+        push(q, {r.loop, mid, r.end});
+        r.end = mid;
+    }
+    if (!loop.failed.load(std::memory_order_relaxed)) {
+        try {
+            loop.body(r.begin, r.end);
+        } catch (...) {
+            if (!loop.failed.exchange(true)) loop.error = std::current_exception();
+        }
+    }
+    loop.remaining.fetch_sub(r.end - r.begin, std::memory_order_acq_rel);
+}
+
+void TaskScheduler::workerMain(size_t q) {
+    currentPool = this;
+    currentQueue = q;
+    for (;;) {
+        Range r;
+        if (pop(q, r) || steal(q, r)) {
+            run(q, r);
+            continue;
+        }
+        std::unique_lock lock(sleepMutex);
+        wake.wait(lock, [this] { return stopping || queued.load(std::memory_order_acquire) > 0; });
+        if (stopping) return;
+    }
+}
+
+void TaskScheduler::parallelFor(size_t n, size_t minGrain, RangeBody body) {
+    if (n == 0) return;
+    if (workers.empty() || n <= minGrain) {
+        body(0, n);
+        return;
+    }
+
+    Loop loop{body, grainFor(n, minGrain), {n}, {false}, {}};
+    const size_t q = queueIndex();
+    run(q, {&loop, 0, n});
+
+    // Help with whatever is queued (possibly other loops) until ours has drained.
+    while (loop.remaining.load(std::memory_order_acquire) != 0) {
+        Range r;
+        if (pop(q, r) || steal(q, r)) run(q, r);
+        else std::this_thread::yield();
+    }
+    if (loop.error) std::rethrow_exception(loop.error);
+}
+
+}
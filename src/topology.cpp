@@ -0,0 +1,136 @@
+#include "topology.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace math3d {
+
+void Topology::build(std::span<const Edge> edges, std::span<const std::vector<int>> faces) {
+    clear();
+
+    // Open addressing with linear probing at load factor <= 1/2. try-insert keeps the
+    // first occurrence of a duplicated edge.
+    const size_t capacity = std::bit_ceil(std::max<size_t>(16, edges.size() * 2));
+    edgeKeys.assign(capacity, kEmptySlot);
+    edgeKeyIds.assign(capacity, -1);
+    for (size_t ei = 0; ei < edges.size(); ++ei) {
+        const std::uint64_t k = key(edges[ei].first, edges[ei].second);
+        for (size_t slot = hashSlot(k);; slot = (slot + 1) & (capacity - 1)) {
+            if (edgeKeys[slot] == k) break;
+            if (edgeKeys[slot] == kEmptySlot) {
+                edgeKeys[slot] = k;
+                edgeKeyIds[slot] = static_cast<int>(ei);
+                break;
+            }
+        }
+    }
+
+    // Face -> edge lists; an edge index per polygon side that exists in `edges`.
+    faceEdgeOffsets.reserve(faces.size() + 1);
+    faceEdgeOffsets.push_back(0);
+    for (const auto& verts : faces) {
+        for (size_t i = 0; i < verts.size(); ++i) {
+            const int ei = findEdge(verts[i], verts[(i + 1) % verts.size()]);
+            if (ei >= 0) faceEdges.push_back(ei);
+        }
+        faceEdgeOffsets.push_back(static_cast<int>(faceEdges.size()));
+    }
+
+    // Edge -> face adjacency by counting sort, which keeps faces in ascending order per edge.
+    edgeFaceOffsets.assign(edges.size() + 1, 0);
+    for (int ei : faceEdges) ++edgeFaceOffsets[ei + 1];
+    for (size_t ei = 0; ei < edges.size(); ++ei) edgeFaceOffsets[ei + 1] += edgeFaceOffsets[ei];
+
+    edgeFaces.resize(faceEdges.size());
+    std::vector<int> cursor(edgeFaceOffsets.begin(), edgeFaceOffsets.end() - 1);
+    for (size_t f = 0; f < faces.size(); ++f) {
+        for (int ei : edgesOfFace(f)) edgeFaces[cursor[ei]++] = static_cast<int>(f);
+    }
+
+    for (size_t ei = 0; ei < edges.size(); ++ei) {
+        const auto adj = facesOfEdge(ei);
+        if (adj.size() > 2) {
+            nonManifoldEdges.push_back(static_cast<int>(ei));
+        } else if (!adj.empty()) {
+            pairEdge.push_back(static_cast<int>(ei));
+            pairFaceA.push_back(adj.front());
+            pairFaceB.push_back(adj.back());
+        }
+    }
+}
+
+void Topology::clear() {
+    edgeKeys.clear();
+    edgeKeyIds.clear();
+    edgeFaceOffsets.clear();
+    edgeFaces.clear();
+    faceEdgeOffsets.clear();
+    faceEdges.clear();
+    pairEdge.clear();
+    pairFaceA.clear();
+    pairFaceB.clear();
+    nonManifoldEdges.clear();
+}
+
+void Topology::visibleEdges(std::span<const std::uint64_t> facing, std::vector<int>& visible) const {
+    const auto bit = [&](int f) -> std::uint64_t { return (facing[f >> 6] >> (f & 63)) & 1; };
+
+    visible.clear();
+    const size_t n = pairEdge.size();
+    for (size_t base = 0; base < n; base += 64) {
+        const size_t count = std::min<size_t>(64, n - base);
+        std::uint64_t word = 0;
+        for (size_t j = 0; j < count; ++j)
+            word |= (bit(pairFaceA[base + j]) | bit(pairFaceB[base + j])) << j;
+
+        while (word) {
+            visible.push_back(pairEdge[base + std::countr_zero(word)]);
+            word &= word - 1;
+        }
+    }
+
+    for (int ei : nonManifoldEdges) {
+        for (int f : facesOfEdge(ei)) {
+            if (bit(f)) { visible.push_back(ei); break; }
+        }
+    }
+}
+
+size_t Topology::hashSlot(std::uint64_t k) const {
+    return static_cast<size_t>((k * 0x9E3779B97F4A7C15ull) >> (64 - std::countr_zero(edgeKeys.size())));
+}
+
+bool Topology::validEdgeKeys(std::span<const std::uint64_t> keys) {
+    if (keys.empty()) return true;
+    return keys.size() >= 2 && std::has_single_bit(keys.size()) &&
+           std::find(keys.begin(), keys.end(), kEmptySlot) != keys.end();
+}
+
+int Topology::findEdge(int a, int b) const {
+    if (edgeKeys.empty()) return -1;
+    const std::uint64_t k = key(a, b);
+    for (size_t slot = hashSlot(k);; slot = (slot + 1) & (edgeKeys.size() - 1)) {
+        if (edgeKeys[slot] == k) return edgeKeyIds[slot];
+        if (edgeKeys[slot] == kEmptySlot) return -1;
+    }
+}
+
+Topology::Arrays Topology::arrays() const {
+    return {edgeKeys, edgeKeyIds, edgeFaceOffsets, edgeFaces, faceEdgeOffsets, faceEdges,
+            pairEdge, pairFaceA, pairFaceB, nonManifoldEdges};
+}
+
+void Topology::assign(const Arrays& a) {
+    edgeKeys.assign(a.edgeKeys.begin(), a.edgeKeys.end());
+    edgeKeyIds.assign(a.edgeKeyIds.begin(), a.edgeKeyIds.end());
+    edgeFaceOffsets.assign(a.edgeFaceOffsets.begin(), a.edgeFaceOffsets.end());
+    edgeFaces.assign(a.edgeFaces.begin(), a.edgeFaces.end());
+    faceEdgeOffsets.assign(a.faceEdgeOffsets.begin(), a.faceEdgeOffsets.end());
+    faceEdges.assign(a.faceEdges.begin(), a.faceEdges.end());
+    pairEdge.assign(a.pairEdge.begin(), a.pairEdge.end());
+    pairFaceA.assign(a.pairFaceA.begin(), a.pairFaceA.end());
+    pairFaceB.assign(a.pairFaceB.begin(), a.pairFaceB.end());
+    nonManifoldEdges.assign(a.nonManifoldEdges.begin(), a.nonManifoldEdges.end());
+}
+
+}
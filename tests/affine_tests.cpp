@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "affine.hpp"
+
+using namespace math3d;
+
+namespace {
+
+Affine3x4 Trs(float t) {
+    Affine3x4 m { Affine3x4::translate(0.3f * t, -0.2f, 1.0f + t) };
+    m = matMul(m, Affine3x4::rotX(0.7f * t));
+    m = matMul(m, Affine3x4::rotY(-1.3f * t));
+    m = matMul(m, Affine3x4::rotZ(0.4f + t));
+    return matMul(m, Affine3x4::scale(1.5f, 0.25f + t, -2.0f));
+}
+
+Mat4 TrsMat4(float t) {
+    Mat4 m { translate(0.3f * t, -0.2f, 1.0f + t) };
+    m = matMul(m, rotX(0.7f * t));
+    m = matMul(m, rotY(-1.3f * t));
+    m = matMul(m, rotZ(0.4f + t));
+    return matMul(m, scaleMat(1.5f, 0.25f + t, -2.0f));
+}
+
+}
+
+TEST(Affine, BuildersMatchMat4) {
+    EXPECT_TRUE(Affine3x4::identity().toMat4() == Mat4::identity());
+    EXPECT_TRUE(Affine3x4::translate(1, -2, 3).toMat4() == translate(1, -2, 3));
+    EXPECT_TRUE(Affine3x4::scale(2, 0.5f, -1).toMat4() == scaleMat(2, 0.5f, -1));
+    EXPECT_TRUE(Affine3x4::rotX(0.3f).toMat4() == rotX(0.3f));
+    EXPECT_TRUE(Affine3x4::rotY(-1.1f).toMat4() == rotY(-1.1f));
+    EXPECT_TRUE(Affine3x4::rotZ(2.5f).toMat4() == rotZ(2.5f));
+    EXPECT_TRUE(Affine3x4::reflect(true, false, true).toMat4() == reflect(true, false, true));
+    EXPECT_TRUE(Affine3x4::fromMat4(rotY(0.2f)) == Affine3x4::rotY(0.2f));
+}
+
+TEST(Affine, FromMat4RejectsProjections) {
+    Mat4 perspective { Mat4::identity() };
+    perspective(3, 2) = -1.0f;
+    perspective(3, 3) = 0.0f;
+    EXPECT_THROW(Affine3x4::fromMat4(perspective), std::runtime_error);
+    EXPECT_NO_THROW(Affine3x4::fromMat4(ortho(-1, 1, -1, 1, 0.1f, 100.0f)));
+}
+
+TEST(Affine, CompositionMatchesMat4Exactly) {
+    for (float t : {0.0f, 0.1f, 0.77f, 2.3f}) {
+        EXPECT_TRUE(Trs(t).toMat4() == TrsMat4(t)) << t;
+        const Mat4 projection { ortho(-2, 1, -1, 3, 0.1f, 50.0f) };
+        EXPECT_TRUE(matMul(projection, Trs(t)) == matMul(projection, TrsMat4(t))) << t;
+    }
+}
+
+TEST(Affine, VertexTransformMatchesMat4AndKeepsW) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> d(-5.0f, 5.0f);
+    std::vector<Vertex> in(1000);
+    for (auto& v : in) v = {d(rng), d(rng), d(rng), d(rng)};
+    std::vector<Vertex> a(in.size()), b(in.size());
+    transformVertices(Trs(0.5f), in, a);
+    transformVertices(TrsMat4(0.5f), in, b);
+    for (size_t i = 0; i < in.size(); ++i) {
+        EXPECT_EQ(a[i].x, b[i].x);
+        EXPECT_EQ(a[i].y, b[i].y);
+        EXPECT_EQ(a[i].z, b[i].z);
+        EXPECT_EQ(a[i].w, in[i].w);
+    }
+    transformVertices(Trs(0.5f), a, a);  // in place
+    EXPECT_EQ(a[3].x, mulMatVec(Trs(0.5f), mulMatVec(Trs(0.5f), in[3])).x);
+    EXPECT_THROW(transformVertices(Trs(0.5f), in, std::span<Vertex>(a).first(3)), std::runtime_error);
+}
+
+TEST(Affine, InverseUndoesTheTransform) {
+    for (float t : {0.1f, 0.77f, 2.3f}) {
+        const Affine3x4 m { Trs(t) };
+        const Affine3x4 round { matMul(m, inverse(m)) };
+        for (int r = 0; r < 3; ++r)
+            for (int c = 0; c < 4; ++c) EXPECT_NEAR(round(r, c), Affine3x4::identity()(r, c), 1e-5f) << r << "," << c;
+        const Vertex p { make_vertex(0.4f, -1.2f, 3.0f) };
+        const Vertex back { mulMatVec(inverse(m), mulMatVec(m, p)) };
+        EXPECT_NEAR(back.x, p.x, 1e-5f);
+        EXPECT_NEAR(back.y, p.y, 1e-5f);
+        EXPECT_NEAR(back.z, p.z, 1e-5f);
+    }
+    EXPECT_THROW(inverse(Affine3x4::scale(1, 0, 1)), std::runtime_error);
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "bounds.hpp"
+#include "object.hpp"
+#include "raster.hpp"
+#include "test_meshes.hpp"
+
+using namespace math3d;
+
+namespace {
+
+const Mat4 kProjection { ortho(-1.0f, 1.0f, -1.0f, 1.0f, 0.1f, 100.0f) };
+const Mat4 kView { translate(0.0f, 0.0f, -3.0f) };
+
+}
+
+TEST(Bounds, BoxAndSphereEncloseTheVertices) {
+    const std::vector<Vertex> vs { make_vertex(1, 2, 3), make_vertex(-1, 0, 5), make_vertex(3, 2, 4) };
+    const Bounds b = Bounds::of(vs);
+    EXPECT_FALSE(b.empty);
+    EXPECT_EQ(b.box.min.x, -1.0f); EXPECT_EQ(b.box.min.y, 0.0f); EXPECT_EQ(b.box.min.z, 3.0f);
+    EXPECT_EQ(b.box.max.x, 3.0f); EXPECT_EQ(b.box.max.y, 2.0f); EXPECT_EQ(b.box.max.z, 5.0f);
+    EXPECT_EQ(b.sphere.center.x, 1.0f); EXPECT_EQ(b.sphere.center.y, 1.0f); EXPECT_EQ(b.sphere.center.z, 4.0f);
+    for (const auto& v : vs) {
+        const Vertex d { v.x - b.sphere.center.x, v.y - b.sphere.center.y, v.z - b.sphere.center.z };
+        EXPECT_LE(std::sqrt(dot(d, d)), b.sphere.radius + 1e-6f);
+    }
+    EXPECT_TRUE(Bounds::of({}).empty);
+}
+
+TEST(Bounds, FrustumRejectsOnlyVolumesEntirelyOutside) {
+    const Frustum f { matMul(kProjection, kView) };
+    const Bounds unit = Bounds::of(std::vector<Vertex>{ make_vertex(-0.5f, -0.5f, -0.5f), make_vertex(0.5f, 0.5f, 0.5f) });
+    const auto at = [&](float x, float y, float z) {
+        Bounds b = unit;
+        b.box.min = { b.box.min.x + x, b.box.min.y + y, b.box.min.z + z };
+        b.box.max = { b.box.max.x + x, b.box.max.y + y, b.box.max.z + z };
+        b.sphere.center = { x, y, z };
+        return b;
+    };
+    EXPECT_FALSE(f.outside(at(0, 0, 0)));
+    EXPECT_FALSE(f.outside(at(1.2f, 0, 0))) << "straddles the right plane";
+    EXPECT_TRUE(f.outside(at(1.6f, 0, 0)));
+    EXPECT_TRUE(f.outside(at(0, -2.0f, 0)));
+    EXPECT_TRUE(f.outside(at(0, 0, 5.0f))) << "behind the eye";
+    EXPECT_TRUE(f.outside(at(0, 0, -200.0f))) << "beyond the far plane";
+    EXPECT_FALSE(f.outside(Bounds{})) << "empty bounds are never culled";
+
+    // Near a corner the sphere reaches into the volume but the box does not.
+    Bounds corner = at(1.55f, 1.55f, 0);
+    EXPECT_FALSE(f.outside(corner.sphere));
+    EXPECT_TRUE(f.outside(corner.box));
+    EXPECT_TRUE(f.outside(corner));
+}
+
+TEST(Bounds, CulledObjectSkipsPerVertexWork) {
+    Object o = MakeCube();
+    o.setView(kView);
+    o.setProjection(kProjection);
+    o.update();
+    EXPECT_FALSE(o.culled);
+    const auto transformed = o.stats.transformedVertices;
+    const auto edges = o.visibleEdges;
+    EXPECT_GT(transformed, 0u);
+
+    o.setModel(translate(4.0f, 0.0f, 0.0f));
+    o.update();
+    EXPECT_TRUE(o.culled);
+    EXPECT_EQ(o.stats.culled, 1u);
+    EXPECT_EQ(o.stats.transformedVertices, transformed) << "no vertex was projected";
+    EXPECT_FALSE(o.isDirty()) << "stale projected data is not a reason to update again";
+
+    RasterOptions opt;
+    opt.width = opt.height = 64;
+    SoftwareRasterizer r(opt);
+    r.clear();
+    r.draw(o);
+    EXPECT_EQ(r.stats().triangles + r.stats().lines, 0u);
+
+    o.setModel(Mat4::identity());
+    o.update();
+    EXPECT_FALSE(o.culled);
+    EXPECT_GT(o.stats.transformedVertices, transformed);
+    EXPECT_EQ(o.visibleEdges, edges) << "facing is rebuilt once back in view";
+
+    o.frustumCulling = false;
+    o.setModel(translate(4.0f, 0.0f, 0.0f));
+    o.update();
+    EXPECT_FALSE(o.culled);
+}
+
+TEST(Bounds, CullStatsCountEveryCandidate) {
+    CullStats s;
+    s.add(true);
+    s.add(false);
+    s.add(false);
+    CullStats t;
+    t.add(true);
+    s += t;
+    EXPECT_EQ(s.tested, 4u);
+    EXPECT_EQ(s.culled, 2u);
+    EXPECT_EQ(s.drawn, 2u);
+}
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include "alloc_counter.hpp"
+#include "frame_arena.hpp"
+#include "instancing.hpp"
+#include "object.hpp"
+#include "profiler.hpp"
+#include "rotation.hpp"
+#include "scene_graph.hpp"
+#include "task_scheduler.hpp"
+#include "test_meshes.hpp"
+#include "transform_expr.hpp"
+
+using namespace math3d;
+
+namespace {
+
+// The work of one frame of the app, minus the GL and ImGui calls: animate the model
+// chain, update the scene graph, the cube and the instances, build the profiler
+// overlay, and format the UI text into the frame arena.
+struct HeadlessFrame {
+    Object cube { MakeCube() };
+    SceneGraph scene;
+    SceneGraph::NodeId node{};
+    Object instanceMesh { MakeCube() };
+    InstancedObject instances { instanceMesh };
+    Profiler profiler;
+    std::vector<ProfileEvent> events;
+    ProfileReport report;
+    FrameArena arena { 64 * 1024 };
+    float t{};
+
+    explicit HeadlessFrame(TaskScheduler* pool) : scheduler(pool) {
+        scene.setView((Translation{0.0f, 0.0f, -3.0f} * RotationX(deg2rad(30.0f)) * RotationY(deg2rad(-40.0f)) *
+                       Scaling{1.0f, 1.0f, -1.0f}).affine().toMat4());
+        scene.setProjection(ortho(-1.0f, 1.0f, -1.0f, 1.0f, 0.1f, 100.0f));
+        node = scene.addNode(SceneGraph::kNone, Mat4::identity(), &cube);
+        cube.scheduler = pool;
+        instances.resize(1000);
+        for (size_t i = 0; i < instances.size(); ++i)
+            instances.setModel(i, matMul(translate(-1.0f + 0.002f * i, 0.0f, -1.0f), scaleMat(0.05f, 0.05f, 0.05f)));
+        profiler.setEnabled(true);
+        events.reserve(profiler.capacity());
+    }
+
+    void run() {
+        arena.reset();
+        profiler.beginFrame();
+        {
+            ProfileScope stage("matrices", profiler);
+            t += 0.01f;
+            const Affine3x4 model = (Translation{0.3f * t, 0.0f, 0.0f} * EulerXYZ{t, 0.5f * t, 0.25f * t} *
+                                     Scaling{1.0f, 1.0f, 1.0f}).affine();
+            scene.setLocal(node, model.toMat4());
+            scene.update(scheduler);
+        }
+        {
+            ProfileScope stage("update", profiler);
+            cube.update();
+            instances.setView(scene.view());
+            instances.setProjection(scene.projection());
+            instances.setModel(0, translate(t, 0.0f, -1.0f));
+            instances.update(scheduler);
+        }
+        profiler.snapshot(events);
+        report.build(events, profiler.frame() > 60 ? profiler.frame() - 60 : 0, profiler.frame());
+
+        std::pmr::vector<std::pmr::string> lines(&arena);
+        char buf[64];
+        for (size_t i = 0; i < cube.faceDots.size(); ++i) {
+            std::snprintf(buf, sizeof buf, "Face %zu dot = %g", i, cube.faceDots[i]);
+            lines.emplace_back(buf);
+        }
+        for (const auto& s : report.stages()) {
+            std::snprintf(buf, sizeof buf, "%-14s %8.3f %8.3f", s.name, s.p50, s.p95);
+            lines.emplace_back(buf);
+        }
+    }
+
+    TaskScheduler* scheduler;
+};
+
+}
+
+TEST(FrameArena, BumpsAndResets) {
+    FrameArena arena(1024);
+    void* a = arena.allocate(10, 1);
+    void* b = arena.allocate(16, 16);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(b) % 16, 0u);
+    EXPECT_GE(static_cast<char*>(b), static_cast<char*>(a) + 10);
+    EXPECT_EQ(arena.used(), 26u);
+    arena.reset();
+    EXPECT_EQ(arena.used(), 0u);
+    EXPECT_EQ(arena.allocate(10, 1), a) << "reset must rewind to the start of the block";
+    EXPECT_EQ(arena.upstreamAllocations(), 1u);
+}
+
+TEST(FrameArena, OverflowGrowsToOneBlockForTheFrame) {
+    FrameArena arena(256);
+    for (int frame = 0; frame < 3; ++frame) {
+        arena.reset();
+        std::pmr::vector<int> v(&arena);
+        for (int i = 0; i < 1000; ++i) v.push_back(i);
+        EXPECT_EQ(v[999], 999);
+    }
+    const auto calls { arena.upstreamAllocations() };
+    EXPECT_GE(arena.highWater(), 4000u);
+    for (int frame = 0; frame < 10; ++frame) {
+        arena.reset();
+        std::pmr::vector<int> v(&arena);
+        for (int i = 0; i < 1000; ++i) v.push_back(i);
+    }
+    EXPECT_EQ(arena.upstreamAllocations(), calls) << "steady-state frames must stay in one block";
+    EXPECT_GE(arena.capacity(), arena.highWater());
+}
+
+TEST(FrameArena, SteadyStateFramesDoNotTouchTheHeap) {
+    ASSERT_TRUE(heapCountingEnabled()) << "unit_tests must link the math3d_alloc_hook objects";
+    TaskScheduler pool(4);
+    for (TaskScheduler* scheduler : {static_cast<TaskScheduler*>(nullptr), &pool}) {
+        HeadlessFrame frame(scheduler);
+        // Until the 60-frame profiler window has filled, its buffers still grow.
+        for (int i = 0; i < 120; ++i) frame.run();
+
+        const HeapAllocationScope scope;
+        for (int i = 0; i < 100; ++i) frame.run();
+        EXPECT_EQ(scope.allocations(), 0u) << (scheduler ? "with" : "without") << " a scheduler, "
+                                           << scope.bytes() << " bytes";
+    }
+}
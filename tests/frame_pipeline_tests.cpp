@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "frame_pipeline.hpp"
+#include "test_meshes.hpp"
+
+using namespace math3d;
+
+namespace {
+
+FrameInputs Inputs(float angle) {
+    FrameInputs in;
+    in.model = rotY(angle);
+    in.view = translate(0.0f, 0.0f, -3.0f);
+    in.projection = ortho(-1.0f, 1.0f, -1.0f, 1.0f, 0.1f, 100.0f);
+    return in;
+}
+
+}
+
+TEST(TripleBuffer, ConsumerSeesOnlyTheNewestPublishedValue) {
+    TripleBuffer<int> b;
+    EXPECT_FALSE(b.update());
+
+    b.back() = 1;
+    b.publish();
+    b.back() = 2;
+    b.publish();
+    ASSERT_TRUE(b.update());
+    EXPECT_EQ(b.front(), 2) << "an unconsumed value is replaced, not queued";
+    EXPECT_FALSE(b.update());
+    EXPECT_EQ(b.front(), 2);
+
+    b.back() = 3;
+    b.publish();
+    ASSERT_TRUE(b.update());
+    EXPECT_EQ(b.front(), 3);
+}
+
+TEST(TripleBuffer, ValuesSurviveConcurrentHandoff) {
+    TripleBuffer<std::pair<int, int>> b;
+    constexpr int n { 100'000 };
+    std::thread producer([&] {
+        for (int i = 1; i <= n; ++i) {
+            b.back() = {i, -i};
+            b.publish();
+        }
+    });
+    int last { 0 };
+    while (last < n) {
+        if (!b.update()) continue;
+        const auto [a, c] { b.front() };
+        ASSERT_EQ(a, -c) << "torn value";
+        ASSERT_GT(a, last) << "values must arrive in order";
+        last = a;
+    }
+    producer.join();
+}
+
+TEST(FramePipeline, SnapshotMatchesSequentialUpdate) {
+    Object sequential { MakeCube() };
+    Object pipelined { MakeCube() };
+
+    FramePipeline pipeline(pipelined);
+    EXPECT_EQ(pipeline.acquire(), nullptr);
+
+    for (float angle : { 0.1f, 0.7f, 2.0f }) {
+        const FrameInputs in { Inputs(angle) };
+        pipeline.submit(in);
+        pipeline.flush();
+        const FrameSnapshot* f { pipeline.acquire() };
+        ASSERT_NE(f, nullptr);
+        EXPECT_EQ(f->frame, pipeline.framesSubmitted());
+        pipeline.frameDrawn();
+        EXPECT_EQ(pipeline.acquire(), f) << "no new frame";
+        pipeline.frameDrawn();
+
+        sequential.setModel(in.model);
+        sequential.setView(in.view);
+        sequential.setProjection(in.projection);
+        sequential.update();
+
+        EXPECT_EQ(f->facing, sequential.facing);
+        EXPECT_EQ(f->visibleEdges, sequential.visibleEdges);
+        EXPECT_TRUE(f->projViewModel == sequential.projViewModel);
+        for (size_t i = 0; i < sequential.projected.size(); ++i) {
+            EXPECT_EQ(f->projected[i].x, sequential.projected[i].x);
+            EXPECT_EQ(f->projected[i].y, sequential.projected[i].y);
+        }
+    }
+    EXPECT_EQ(pipeline.metrics().frames(), 3u);
+    EXPECT_EQ(pipeline.framesDropped(), 0u);
+}
+
+TEST(FramePipeline, RenderThreadNeverWaitsAndCountsDroppedFrames) {
+    Object o { MakeCube() };
+    FramePipeline pipeline(o);
+    for (int i = 0; i < 50; ++i) pipeline.submit(Inputs(0.01f * i));
+    pipeline.flush();
+
+    const FrameSnapshot* f { pipeline.acquire() };
+    ASSERT_NE(f, nullptr);
+    EXPECT_EQ(f->frame, 50u) << "the newest inputs always win";
+    EXPECT_EQ(pipeline.framesDropped(), 49u);
+    EXPECT_GE(pipeline.framesProduced(), 1u);
+    EXPECT_EQ(pipeline.metrics().frames(), 0u) << "recorded once drawn";
+    pipeline.frameDrawn();
+    EXPECT_EQ(pipeline.metrics().frames(), 1u);
+    EXPECT_GE(pipeline.metrics().meanLatencyMs(), 0.0);
+}
+
+TEST(FrameMetrics, RollingWindow) {
+    FrameMetrics m(4);
+    const auto t0 { FrameClock::now() };
+    for (int i = 0; i < 10; ++i)
+        m.record(t0 + std::chrono::milliseconds(10 * i), t0 + std::chrono::milliseconds(10 * i + (i < 6 ? 50 : 2)));
+    EXPECT_EQ(m.frames(), 10u);
+    EXPECT_NEAR(m.maxLatencyMs(), 2.0, 1e-9) << "old frames leave the window";
+    EXPECT_NEAR(m.meanLatencyMs(), 2.0, 1e-9);
+    EXPECT_NEAR(m.framesPerSecond(), 100.0, 1e-6);
+}
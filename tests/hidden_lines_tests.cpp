@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include "hidden_lines.hpp"
+#include "task_scheduler.hpp"
+
+using namespace math3d;
+
+namespace {
+
+// Identity view and an orthographic box, so NDC x/y equal object x/y and larger z is nearer the eye.
+void Place(Object& o) {
+    o.setProjection(ortho(-1.0f, 1.0f, -1.0f, 1.0f, -10.0f, 10.0f));
+    o.update();
+}
+
+Object MakeBox(float cx, float cy, float cz, float half = 0.2f) {
+    Object o;
+    for (int i = 0; i < 8; ++i) {
+        const float x = (i == 1 || i == 2 || i == 5 || i == 6) ? half : -half;
+        const float y = (i == 2 || i == 3 || i == 6 || i == 7) ? half : -half;
+        const float z = i < 4 ? -half : half;
+        o.original.push_back(make_vertex(cx + x, cy + y, cz + z));
+    }
+    o.edges = {
+        {0,1},{1,2},{2,3},{3,0},
+        {4,5},{5,6},{6,7},{7,4},
+        {0,4},{1,5},{2,6},{3,7}
+    };
+    o.planes = {{{0,1,2,3},{}}, {{4,7,6,5},{}}, {{0,4,5,1},{}}, {{2,6,7,3},{}}, {{0,3,7,4},{}}, {{1,5,6,2},{}}};
+    Place(o);
+    return o;
+}
+
+Object MakeLine(Vertex a, Vertex b) {
+    Object o;
+    o.original = {a, b};
+    o.edges = {{0, 1}};
+    o.useRoberts = false;
+    Place(o);
+    return o;
+}
+
+float Length(const VisibleSegment& s) { return std::hypot(s.x1 - s.x0, s.y1 - s.y0); }
+
+float BodyLength(std::span<const VisibleSegment> segments, std::uint32_t body) {
+    float sum = 0.0f;
+    for (const auto& s : segments)
+        if (s.body == body) sum += Length(s);
+    return sum;
+}
+
+}
+
+TEST(HiddenLines, LoneBoxKeepsItsFrontEdges) {
+    const Object box { MakeBox(0, 0, 0) };
+    const Object* scene[] = { &box };
+    HiddenLineRemover hlr;
+    const auto& segs = hlr.compute(scene);
+    ASSERT_EQ(segs.size(), 4u) << "only the front face faces the eye";
+    EXPECT_NEAR(BodyLength(segs, 0), 1.6f, 1e-5f);
+    EXPECT_EQ(hlr.stats().candidates, 0u) << "a body never occludes itself";
+}
+
+TEST(HiddenLines, LineBehindBoxIsSplit) {
+    const Object box { MakeBox(0, 0, 0) };
+    const Object line { MakeLine(make_vertex(-0.8f, 0.0f, -1.0f), make_vertex(0.8f, 0.0f, -1.0f)) };
+    const Object* scene[] = { &box, &line };
+    HiddenLineRemover hlr;
+    const auto& segs = hlr.compute(scene);
+
+    std::vector<VisibleSegment> pieces;
+    for (const auto& s : segs)
+        if (s.body == 1) pieces.push_back(s);
+    ASSERT_EQ(pieces.size(), 2u);
+    EXPECT_NEAR(pieces[0].x0, -0.8f, 1e-5f);
+    EXPECT_NEAR(pieces[0].x1, -0.2f, 1e-4f);
+    EXPECT_NEAR(pieces[1].x0, 0.2f, 1e-4f);
+    EXPECT_NEAR(pieces[1].x1, 0.8f, 1e-5f);
+    EXPECT_EQ(pieces[0].edge, 0u);
+    EXPECT_NEAR(BodyLength(segs, 0), 1.6f, 1e-5f) << "the line does not occlude";
+}
+
+TEST(HiddenLines, LineInFrontOfBoxStaysWhole) {
+    const Object box { MakeBox(0, 0, 0) };
+    const Object line { MakeLine(make_vertex(-0.8f, 0.0f, 1.0f), make_vertex(0.8f, 0.0f, 1.0f)) };
+    const Object* scene[] = { &box, &line };
+    HiddenLineRemover hlr;
+    const auto& segs = hlr.compute(scene);
+    EXPECT_NEAR(BodyLength(segs, 1), 1.6f, 1e-5f);
+    EXPECT_EQ(hlr.stats().occluded, 0u);
+}
+
+TEST(HiddenLines, LinePiercingBoxIsHiddenOnlyInside) {
+    // Along a line of sight the edge collapses to a point on screen.
+    const Object box { MakeBox(0, 0, 0) };
+    const Object line { MakeLine(make_vertex(0.1f, 0.0f, 1.0f), make_vertex(0.1f, 0.0f, -1.0f)) };
+    const Object* scene[] = { &box, &line };
+    HiddenLineRemover hlr;
+    hlr.compute(scene);
+    EXPECT_NEAR(BodyLength(hlr.segments(), 1), 0.0f, 1e-6f) << "degenerate on screen, nothing to draw";
+
+    const Object slanted { MakeLine(make_vertex(0.1f, -0.1f, 1.0f), make_vertex(0.1f, 0.1f, -1.0f)) };
+    const Object* scene2[] = { &box, &slanted };
+    hlr.compute(scene2);
+    // y = -0.1 + 0.2t, z = 1 - 2t: enters the front face z = 0.2 at y = -0.02 and is
+    // inside or behind the box from there on.
+    ASSERT_EQ(hlr.segments().size(), 5u);
+    const VisibleSegment& s = hlr.segments().back();
+    EXPECT_NEAR(s.y0, -0.1f, 1e-5f);
+    EXPECT_NEAR(s.y1, -0.02f, 1e-4f);
+}
+
+TEST(HiddenLines, OverlappingBoxes) {
+    // The far box is shifted right and up: its left and bottom edges run behind the
+    // near box until they leave its silhouette at x = 0.2 and y = 0.2.
+    const Object near { MakeBox(0, 0, 0) };
+    const Object far { MakeBox(0.1f, 0.05f, -1.0f) };
+    const Object* scene[] = { &near, &far };
+    HiddenLineRemover hlr;
+    const auto& segs = hlr.compute(scene);
+    EXPECT_NEAR(BodyLength(segs, 0), 1.6f, 1e-5f);
+    EXPECT_NEAR(BodyLength(segs, 1), 0.4f + 0.4f + 0.1f + 0.05f, 1e-4f);
+    EXPECT_EQ(hlr.stats().occluded, 2u);
+}
+
+TEST(HiddenLines, SeparatedBodiesAreNeverPaired) {
+    std::vector<Object> boxes;
+    for (int y = 0; y < 20; ++y)
+        for (int x = 0; x < 20; ++x) boxes.push_back(MakeBox(-0.95f + 0.1f * x, -0.95f + 0.1f * y, 0.0f, 0.03f));
+    std::vector<const Object*> scene;
+    for (const auto& b : boxes) scene.push_back(&b);
+    HiddenLineRemover hlr;
+    hlr.compute(scene);
+    EXPECT_EQ(hlr.stats().bodies, 400u);
+    EXPECT_EQ(hlr.stats().candidates, 0u);
+    EXPECT_EQ(hlr.stats().segments, 1600u);
+}
+
+TEST(HiddenLines, ResultDoesNotDependOnThreads) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> pos(-0.9f, 0.9f);
+    std::vector<Object> boxes;
+    for (int i = 0; i < 300; ++i) boxes.push_back(MakeBox(pos(rng), pos(rng), pos(rng), 0.05f));
+    std::vector<const Object*> scene;
+    for (const auto& b : boxes) scene.push_back(&b);
+
+    HiddenLineRemover serial, threaded;
+    TaskScheduler pool(3);
+    serial.compute(scene);
+    threaded.compute(scene, &pool);
+    ASSERT_EQ(serial.segments().size(), threaded.segments().size());
+    EXPECT_GT(serial.stats().occluded, 0u);
+    for (size_t i = 0; i < serial.segments().size(); ++i) {
+        const auto& a = serial.segments()[i];
+        const auto& b = threaded.segments()[i];
+        EXPECT_TRUE(a.x0 == b.x0 && a.y0 == b.y0 && a.x1 == b.x1 && a.y1 == b.y1 && a.body == b.body && a.edge == b.edge);
+    }
+}
+
+TEST(HiddenLines, WritesSvg) {
+    const Object box { MakeBox(0, 0, 0) };
+    const Object line { MakeLine(make_vertex(-0.8f, 0.0f, -1.0f), make_vertex(0.8f, 0.0f, -1.0f)) };
+    const Object* scene[] = { &box, &line };
+    HiddenLineRemover hlr;
+    hlr.compute(scene);
+
+    const std::string path { (std::filesystem::temp_directory_path() / "math3d_hidden_lines.svg").string() };
+    writeSvg(path, hlr.segments(), 1000, 500);
+    std::ifstream in(path);
+    const std::string svg { std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+    size_t lines = 0;
+    for (size_t p = svg.find("<line"); p != std::string::npos; p = svg.find("<line", p + 1)) ++lines;
+    EXPECT_EQ(lines, 6u);
+    EXPECT_NE(svg.find("viewBox=\"0 0 1000 500\""), std::string::npos);
+    EXPECT_NE(svg.find("x1=\"100.000\" y1=\"250.000\""), std::string::npos) << "left end of the line";
+    std::remove(path.c_str());
+}
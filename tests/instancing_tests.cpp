@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "instancing.hpp"
+#include "task_scheduler.hpp"
+#include "test_meshes.hpp"
+
+using namespace math3d;
+
+namespace {
+
+Mat4 InstanceModel(int i) {
+    return matMul(translate(0.1f * (i % 7) - 0.3f, 0.1f * (i % 5) - 0.2f, 0.0f),
+                  matMul(rotY(0.37f * i), matMul(rotX(0.21f * i), scaleMat(1.0f, i % 3 ? 1.0f : -0.5f, 1.0f))));
+}
+
+}
+
+TEST(Instancing, MatchesSeparateObjects) {
+    Object mesh { MakeCube() };
+    InstancedObject batch(mesh);
+    batch.setView(AppView());
+    batch.setProjection(AppProjection());
+    for (int i = 0; i < 50; ++i) batch.add(InstanceModel(i));
+    ASSERT_TRUE(batch.update());
+    ASSERT_EQ(batch.visible().size(), 50u);
+
+    std::vector<int> edges;
+    for (int i = 0; i < 50; ++i) {
+        Object o { MakeCube() };
+        o.setModel(InstanceModel(i));
+        o.setView(AppView());
+        o.setProjection(AppProjection());
+        o.update();
+        EXPECT_TRUE(batch.projViewModel(i) == o.projViewModel) << "instance " << i;
+        for (size_t f = 0; f < o.planes.size(); ++f)
+            EXPECT_EQ(batch.isFacing(i, f), o.isFacing(f)) << "instance " << i << " face " << f;
+        batch.visibleEdges(i, edges);
+        EXPECT_EQ(edges, o.visibleEdges);
+    }
+}
+
+TEST(Instancing, SharesTheMesh) {
+    Object mesh { MakeCube() };
+    InstancedObject batch(mesh);
+    batch.resize(1000);
+    EXPECT_EQ(&batch.mesh(), &mesh);
+    EXPECT_EQ(batch.facingWords(), 1u);
+    EXPECT_NEAR(batch.bounds().sphere.radius, 0.2f * std::sqrt(3.0f), 1e-6f);
+}
+
+TEST(Instancing, CullsInstancesOutsideTheViewVolume) {
+    Object mesh { MakeCube() };
+    InstancedObject batch(mesh);
+    batch.setProjection(AppProjection());
+    batch.setView(translate(0.0f, 0.0f, -3.0f));
+    batch.add(Mat4::identity());
+    batch.add(translate(5.0f, 0.0f, 0.0f));                        // right of the volume
+    batch.add(translate(1.1f, 0.0f, 0.0f));                        // straddles the right plane
+    batch.add(matMul(translate(1.6f, 0.0f, 0.0f), scaleMat(4, 4, 4)));  // center outside, scaled into view
+    batch.add(translate(0.0f, 0.0f, 10.0f));                       // behind the eye
+    batch.update();
+    const std::vector<std::uint32_t> visible(batch.visible().begin(), batch.visible().end());
+    EXPECT_EQ(visible, (std::vector<std::uint32_t>{0, 2, 3}));
+    EXPECT_EQ(batch.cullStats().culled, 2u);
+    EXPECT_EQ(batch.facing(1)[0], 0u) << "culled instances face nothing";
+}
+
+TEST(Instancing, IdleUpdateDoesNoWork) {
+    Object mesh { MakeCube() };
+    InstancedObject batch(mesh);
+    batch.resize(10);
+    EXPECT_TRUE(batch.update());
+    EXPECT_FALSE(batch.update());
+    batch.setModel(3, Mat4::identity());
+    EXPECT_FALSE(batch.update()) << "same matrix";
+    batch.setView(rotY(0.1f));
+    EXPECT_TRUE(batch.update());
+    EXPECT_EQ(batch.stats.instancesUpdated, 20u);
+
+    mesh.original[0].x = -0.3f;
+    mesh.invalidate();
+    EXPECT_TRUE(batch.update()) << "mesh edits reach the batch";
+    EXPECT_GT(batch.bounds().sphere.radius, 0.2f * std::sqrt(3.0f));
+}
+
+TEST(Instancing, ParallelUpdateMatchesSerial) {
+    Object mesh { MakeCube() };
+    InstancedObject serial(mesh), threaded(mesh);
+    for (InstancedObject* b : {&serial, &threaded}) {
+        b->setView(AppView());
+        b->setProjection(AppProjection());
+        for (int i = 0; i < 20000; ++i) b->add(matMul(translate(0.002f * (i % 1000) - 1.0f, 0.1f * (i / 1000) - 1.0f, 0.0f), rotY(0.01f * i)));
+    }
+    TaskScheduler pool(3);
+    serial.update();
+    threaded.update(&pool);
+    ASSERT_TRUE(std::equal(serial.visible().begin(), serial.visible().end(), threaded.visible().begin(), threaded.visible().end()));
+    for (size_t i = 0; i < serial.size(); ++i) {
+        ASSERT_TRUE(serial.projViewModel(i) == threaded.projViewModel(i));
+        ASSERT_EQ(serial.facing(i)[0], threaded.facing(i)[0]);
+    }
+}
@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "math3d.hpp"
+
+using namespace math3d;
+
+namespace {
+
+std::vector<Vertex> RandomVertices(size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+    std::vector<Vertex> v(n);
+    for (auto& p : v) p = Vertex{dist(rng), dist(rng), dist(rng), 1.0f};
+    return v;
+}
+
+Mat4 SampleMatrix() {
+    Mat4 m { matMul(translate(0.3f, -0.2f, -3.0f), rotX(deg2rad(30.0f))) };
+    m = matMul(m, rotY(deg2rad(-40.0f)));
+    m = matMul(m, scaleMat(1.5f, 0.5f, -1.0f));
+    return matMul(ortho(-1.0f, 1.0f, -1.0f, 1.0f, 0.1f, 100.0f), m);
+}
+
+const SimdPath allPaths[] { SimdPath::Scalar, SimdPath::SSE2, SimdPath::AVX2, SimdPath::NEON };
+
+}
+
+TEST(TransformVertices, MatchesMulMatVec) {
+    const Mat4 m { SampleMatrix() };
+    const auto in { RandomVertices(37, 1) };
+    std::vector<Vertex> out(in.size());
+
+    transformVertices(m, in, out);
+    for (size_t i = 0; i < in.size(); ++i) {
+        const Vertex expected { mulMatVec(m, in[i]) };
+        EXPECT_EQ(std::memcmp(&out[i], &expected, sizeof(Vertex)), 0)
+            << "vertex " << i << " differs from mulMatVec using path " << simdPathName(bestSimdPath());
+    }
+}
+
+TEST(TransformVertices, AllSupportedPathsAreBitIdentical) {
+    const Mat4 m { SampleMatrix() };
+    // Odd length exercises the tails of the unrolled kernels.
+    const auto in { RandomVertices(1027, 2) };
+    std::vector<Vertex> reference(in.size());
+    transformVertices(m, in, reference, SimdPath::Scalar);
+
+    for (SimdPath path : allPaths) {
+        if (!simdPathSupported(path)) continue;
+        std::vector<Vertex> out(in.size());
+        transformVertices(m, in, out, path);
+        EXPECT_EQ(std::memcmp(out.data(), reference.data(), out.size() * sizeof(Vertex)), 0)
+            << simdPathName(path) << " path differs from the scalar fallback";
+    }
+}
+
+TEST(TransformVertices, SupportsInPlaceTransform) {
+    const Mat4 m { SampleMatrix() };
+    const auto in { RandomVertices(19, 3) };
+    std::vector<Vertex> expected(in.size());
+    transformVertices(m, in, expected, SimdPath::Scalar);
+
+    for (SimdPath path : allPaths) {
+        if (!simdPathSupported(path)) continue;
+        auto data { in };
+        transformVertices(m, data, data, path);
+        EXPECT_EQ(std::memcmp(data.data(), expected.data(), data.size() * sizeof(Vertex)), 0)
+            << simdPathName(path) << " path is wrong when input and output alias";
+    }
+}
+
+TEST(TransformVertices, ThrowsOnSizeMismatch) {
+    const std::vector<Vertex> in(4);
+    std::vector<Vertex> out(3);
+    EXPECT_THROW(transformVertices(Mat4::identity(), in, out), std::runtime_error);
+}
+
+TEST(TransformVerticesSoA, MatchesAoSOnAllSupportedPaths) {
+    const Mat4 m { SampleMatrix() };
+    const auto aos { RandomVertices(1029, 4) };
+    std::vector<Vertex> expected(aos.size());
+    transformVertices(m, aos, expected, SimdPath::Scalar);
+
+    VertexSoA in;
+    in.assign(aos);
+    ASSERT_FALSE(in.hasW()) << "vertices with w == 1 must not allocate a w lane";
+
+    for (SimdPath path : allPaths) {
+        if (!simdPathSupported(path)) continue;
+        VertexSoA out;
+        transformVertices(m, in, out, path);
+        ASSERT_EQ(out.size(), aos.size());
+        for (size_t i = 0; i < aos.size(); ++i) {
+            const Vertex actual { out.at(i) };
+            EXPECT_EQ(std::memcmp(&actual, &expected[i], sizeof(Vertex)), 0)
+                << simdPathName(path) << " SoA path differs from AoS at vertex " << i;
+        }
+    }
+}
+
+TEST(TransformVerticesSoA, SkipsWLaneForAffineMatrices) {
+    VertexSoA in;
+    in.assign(RandomVertices(10, 5));
+
+    VertexSoA out;
+    transformVertices(matMul(translate(1.0f, 2.0f, 3.0f), rotY(0.3f)), in, out);
+    EXPECT_FALSE(out.hasW()) << "affine transform of w == 1 vertices must not write w";
+
+    Mat4 projective { Mat4::identity() };
+    projective(3, 2) = -1.0f;
+    transformVertices(projective, in, out);
+    ASSERT_TRUE(out.hasW()) << "non-affine transform must produce a w lane";
+    EXPECT_EQ(out.w[0], -in.z[0] + 1.0f);
+}
+
+TEST(TransformVerticesSoA, SupportsInPlaceTransform) {
+    const Mat4 m { SampleMatrix() };
+    const auto aos { RandomVertices(21, 6) };
+    std::vector<Vertex> expected(aos.size());
+    transformVertices(m, aos, expected, SimdPath::Scalar);
+
+    for (SimdPath path : allPaths) {
+        if (!simdPathSupported(path)) continue;
+        VertexSoA data;
+        data.assign(aos);
+        transformVertices(m, data, data, path);
+        for (size_t i = 0; i < aos.size(); ++i) {
+            const Vertex actual { data.at(i) };
+            EXPECT_EQ(std::memcmp(&actual, &expected[i], sizeof(Vertex)), 0)
+                << simdPathName(path) << " in-place SoA path differs at vertex " << i;
+        }
+    }
+}
+
+TEST(FacingTest, PacksPositiveDotsIntoBitmask) {
+    VertexSoA normals;
+    normals.resize(70, false);
+    for (size_t i = 0; i < normals.size(); ++i) {
+        normals.x[i] = 0.0f;
+        normals.y[i] = 0.0f;
+        normals.z[i] = (i % 3 == 0) ? 1.0f : -1.0f;
+    }
+
+    std::vector<float> dots(normals.size());
+    std::vector<std::uint64_t> mask(2, ~std::uint64_t{0});
+    facingTest(normals, Vertex{0.0f, 0.0f, 2.0f, 0.0f}, dots, mask);
+
+    for (size_t i = 0; i < normals.size(); ++i) {
+        const bool bit = (mask[i >> 6] >> (i & 63)) & 1;
+        EXPECT_EQ(bit, i % 3 == 0) << "facing bit " << i;
+        EXPECT_EQ(dots[i], (i % 3 == 0) ? 2.0f : -2.0f) << "dot " << i;
+    }
+    EXPECT_EQ(mask[1] >> 6, 0u) << "bits past the last face must be cleared";
+}
+
+TEST(FacingTest, ThrowsOnShortMask) {
+    VertexSoA normals;
+    normals.resize(65, false);
+    std::vector<float> dots(65);
+    std::vector<std::uint64_t> mask(1);
+    EXPECT_THROW(facingTest(normals, Vertex{}, dots, mask), std::runtime_error);
+}
@@ -170,3 +170,69 @@ TEST(Deg2Rad, IsLinearForScaledAngles) {
     ASSERT_NEAR(result, expected, eps)
         << "deg2rad(2a) must equal 2*deg2rad(a)";
 }
+
+TEST(Mat4, IsRowMajorAndContiguous) {
+    const Mat4 T { translate(1.0f, 2.0f, 3.0f) };
+    ASSERT_EQ(sizeof(Mat4), 16 * sizeof(float)) << "Mat4 must not carry any padding or indirection";
+    EXPECT_EQ(T.m[3], 1.0f) << "translation x must be stored at row 0, column 3";
+    EXPECT_EQ(T.m[7], 2.0f) << "translation y must be stored at row 1, column 3";
+    EXPECT_EQ(T.m[11], 3.0f) << "translation z must be stored at row 2, column 3";
+}
+
+TEST(Mat4, MatMulMatchesLegacyImplementation) {
+    const Mat4 A { matMul(translate(0.5f, -1.0f, 2.0f), rotX(deg2rad(30.0f))) };
+    const Mat4 B { matMul(rotY(deg2rad(-40.0f)), scaleMat(1.0f, 2.0f, -1.0f)) };
+
+    const std::vector<std::vector<float>> legacyA { A };
+    const std::vector<std::vector<float>> legacyB { B };
+    const std::vector<std::vector<float>> actual { matMul(A, B) };
+    ExpectMatrixEq(legacyA, legacyB, actual, matMul(legacyA, legacyB), "Mat4 product must match the legacy product");
+}
+
+TEST(Mat4, MulMatVecMatchesLegacyImplementation) {
+    const Mat4 M { matMul(ortho(-1.0f, 1.0f, -1.0f, 1.0f, 0.1f, 100.0f), translate(0.0f, 0.0f, -3.0f)) };
+    const std::vector<std::vector<float>> legacy { M };
+    const Vertex v { make_vertex(0.2f, -0.7f, 1.5f) };
+
+    const Vertex expected { mulMatVec(legacy, v) };
+    const Vertex actual { mulMatVec(M, v) };
+    EXPECT_NEAR(actual.x, expected.x, eps);
+    EXPECT_NEAR(actual.y, expected.y, eps);
+    EXPECT_NEAR(actual.z, expected.z, eps);
+    EXPECT_NEAR(actual.w, expected.w, eps);
+}
+
+TEST(Mat4, FromRowsRoundTrips) {
+    const Mat4 R { rotZ(deg2rad(75.0f)) };
+    EXPECT_EQ(Mat4::fromRows(R), R) << "conversion to rows and back must be lossless";
+}
+
+TEST(Mat4, FromRowsThrowsOnNon4x4) {
+    const std::vector<std::vector<float>> A{{1, 2, 3}, {4, 5, 6}, {7, 8, 9}};
+    EXPECT_THROW((void)Mat4::fromRows(A), std::runtime_error);
+}
+
+TEST(NormalMatrix, InvertsNonUniformScale) {
+    const Mat4 N { normalMatrix(matMul(translate(5.0f, 6.0f, 7.0f), scaleMat(2.0f, 4.0f, 8.0f))) };
+    const std::vector<std::vector<float>> expected {
+        {0.5f, 0, 0, 0}, {0, 0.25f, 0, 0}, {0, 0, 0.125f, 0}, {0, 0, 0, 1}
+    };
+    ExpectMatrixEq(Mat4::identity(), Mat4::identity(), N, expected, "normal matrix must drop translation and invert scale");
+}
+
+TEST(NormalMatrix, KeepsNormalsPerpendicularToTransformedSurface) {
+    const Mat4 M { matMul(rotX(deg2rad(30.0f)), matMul(scaleMat(3.0f, 0.5f, -1.0f), rotZ(deg2rad(45.0f)))) };
+    const Vertex tangent { 1.0f, -1.0f, 2.0f, 0.0f };
+    const Vertex normal { 1.0f, 1.0f, 0.0f, 0.0f };
+    ASSERT_NEAR(dot(tangent, normal), 0.0f, eps);
+
+    const Vertex t { mulMatVec(M, tangent) };
+    const Vertex n { mulMatVec(normalMatrix(M), normal) };
+    EXPECT_NEAR(dot(t, n), 0.0f, eps) << "transformed normal must stay perpendicular to the surface";
+}
+
+TEST(NormalMatrix, PreservesOrientationUnderReflection) {
+    const Vertex outward { 0.0f, 0.0f, 1.0f, 0.0f };
+    const Vertex n { mulMatVec(normalMatrix(reflect(false, false, true)), outward) };
+    EXPECT_NEAR(n.z, -1.0f, eps) << "reflected outward normal must point along the reflected surface's outside";
+}
@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "mesh_cache.hpp"
+
+using namespace math3d;
+
+namespace {
+
+const char* kPyramidObj =
+    "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv 0.5 0.5 1\n"
+    "f 1 4 3 2\nf 1 2 5\nf 2 3 5\nf 3 4 5\nf 4 1 5\n";
+
+struct TempMesh {
+    std::string path, cache;
+
+    explicit TempMesh(const std::string& name, const std::string& contents)
+        : path((std::filesystem::temp_directory_path() / ("math3d_" + name)).string()), cache(path + ".m3dc") {
+        std::remove(cache.c_str());
+        std::ofstream(path, std::ios::binary) << contents;
+    }
+    ~TempMesh() {
+        std::remove(path.c_str());
+        std::remove(cache.c_str());
+    }
+};
+
+}
+
+TEST(MeshCache, SecondLoadComesFromCacheWithIdenticalMesh) {
+    TempMesh mesh("pyramid.obj", kPyramidObj);
+
+    Object parsed;
+    const MeshLoadStats first { loadMeshCached(mesh.path, parsed) };
+    EXPECT_FALSE(first.fromCache);
+    ASSERT_TRUE(std::filesystem::exists(mesh.cache));
+
+    Object cached;
+    const MeshLoadStats second { loadMeshCached(mesh.path, cached) };
+    EXPECT_TRUE(second.fromCache);
+    EXPECT_EQ(second.vertices, 5u);
+    EXPECT_EQ(second.faces, 5u);
+    EXPECT_EQ(second.edges, 8u);
+
+    ASSERT_EQ(cached.original.size(), parsed.original.size());
+    for (size_t i = 0; i < parsed.original.size(); ++i) {
+        EXPECT_EQ(cached.original[i].x, parsed.original[i].x);
+        EXPECT_EQ(cached.original[i].y, parsed.original[i].y);
+        EXPECT_EQ(cached.original[i].z, parsed.original[i].z);
+    }
+    EXPECT_EQ(cached.edges, parsed.edges);
+    for (size_t f = 0; f < parsed.planes.size(); ++f) {
+        EXPECT_EQ(cached.planes[f].verts, parsed.planes[f].verts);
+        EXPECT_EQ(cached.planes[f].tris, parsed.planes[f].tris);
+    }
+
+    EXPECT_FALSE(cached.topologyDirty) << "adjacency must come from the cache";
+    EXPECT_EQ(cached.topology.findEdge(4, 0), parsed.topology.findEdge(0, 4));
+    for (size_t e = 0; e < parsed.edges.size(); ++e) {
+        const auto a { parsed.topology.facesOfEdge(e) }, b { cached.topology.facesOfEdge(e) };
+        EXPECT_TRUE(std::equal(a.begin(), a.end(), b.begin(), b.end()));
+    }
+
+    cached.update();
+    EXPECT_EQ(cached.topology.edgeCount(), 8u);
+}
+
+TEST(MeshCache, RebuildsWhenTheSourceChanges) {
+    TempMesh mesh("changing.obj", kPyramidObj);
+    Object o;
+    loadMeshCached(mesh.path, o);
+
+    std::ofstream(mesh.path, std::ios::binary | std::ios::app) << "v 2 2 2\n";
+    std::filesystem::last_write_time(mesh.path, std::filesystem::last_write_time(mesh.path) + std::chrono::seconds(1));
+
+    const MeshLoadStats st { loadMeshCached(mesh.path, o) };
+    EXPECT_FALSE(st.fromCache);
+    EXPECT_EQ(st.vertices, 6u);
+    EXPECT_TRUE(loadMeshCached(mesh.path, o).fromCache);
+}
+
+TEST(MeshCache, CorruptCacheIsRebuilt) {
+    TempMesh mesh("corrupt.obj", kPyramidObj);
+    std::ofstream(mesh.cache, std::ios::binary) << "M3DMESH but not really";
+
+    EXPECT_THROW(MeshCache { mesh.cache }, std::runtime_error);
+    Object o;
+    EXPECT_FALSE(loadMeshCached(mesh.path, o).fromCache);
+    EXPECT_NO_THROW(MeshCache { mesh.cache });
+}
+
+TEST(MeshCache, OutOfRangeIndicesAreRejected) {
+    TempMesh mesh("ranges.obj", kPyramidObj);
+    Object o;
+    loadMeshCached(mesh.path, o);
+
+    // Overwrites element `i` of section `kind`, found through the section table that
+    // follows the 40-byte header: {u32 kind, u32 elemSize, u64 offset, u64 count}.
+    const auto patch = [&](std::uint32_t kind, size_t i, std::int32_t value) {
+        std::fstream f(mesh.cache, std::ios::binary | std::ios::in | std::ios::out);
+        std::uint64_t offset {};
+        f.seekg(40 + kind * 24 + 8);
+        f.read(reinterpret_cast<char*>(&offset), sizeof offset);
+        std::int32_t old {};
+        f.seekg(static_cast<std::streamoff>(offset + i * sizeof old));
+        f.read(reinterpret_cast<char*>(&old), sizeof old);
+        f.seekp(static_cast<std::streamoff>(offset + i * sizeof value));
+        f.write(reinterpret_cast<const char*>(&value), sizeof value);
+        return old;
+    };
+    constexpr std::uint32_t kTriOffsets { 4 }, kFaceEdges { 11 }, kPairFaceA { 13 };
+
+    for (const auto& [kind, i, value] : { std::tuple { kPairFaceA, size_t { 0 }, std::int32_t { 5 } },
+                                          std::tuple { kFaceEdges, size_t { 3 }, std::int32_t { -1 } },
+                                          std::tuple { kTriOffsets, size_t { 1 }, std::int32_t { 5 } } }) {
+        ASSERT_NO_THROW(MeshCache { mesh.cache });
+        const std::int32_t old { patch(kind, i, value) };
+        EXPECT_THROW(MeshCache { mesh.cache }, std::runtime_error) << "section " << kind;
+        patch(kind, i, old);
+    }
+    EXPECT_TRUE(loadMeshCached(mesh.path, o).fromCache);
+
+    patch(kPairFaceA, 0, 1000);
+    EXPECT_FALSE(loadMeshCached(mesh.path, o).fromCache) << "a corrupt cache falls back to the source";
+    o.update();
+    EXPECT_EQ(o.topology.faceCount(), 5u);
+}
+
+TEST(MeshCache, EdgeKeyTablesThatCannotEndAProbeAreRejected) {
+    TempMesh mesh("edgekeys.obj", kPyramidObj);
+    Object o;
+    loadMeshCached(mesh.path, o);
+    ASSERT_NO_THROW(MeshCache { mesh.cache });
+    constexpr std::uint32_t kEdgeKeys { 6 }, kEdgeKeyIds { 7 };
+    const auto entry = [](std::uint32_t kind, std::uint32_t field) { return 40 + kind * 24 + field; };
+
+    std::fstream f(mesh.cache, std::ios::binary | std::ios::in | std::ios::out);
+    std::uint64_t offset {}, count {};
+    f.seekg(entry(kEdgeKeys, 8));
+    f.read(reinterpret_cast<char*>(&offset), sizeof offset);
+    f.read(reinterpret_cast<char*>(&count), sizeof count);
+    ASSERT_GE(count, 2u);
+
+    // No free slot left: a lookup of a missing edge would probe forever.
+    const std::vector<std::uint64_t> full(count, 0);
+    f.seekp(static_cast<std::streamoff>(offset));
+    f.write(reinterpret_cast<const char*>(full.data()), static_cast<std::streamsize>(count * sizeof(std::uint64_t)));
+    f.flush();
+    EXPECT_THROW(MeshCache { mesh.cache }, std::runtime_error);
+
+    // One slot, free: the hash would shift by 64 bits.
+    const std::uint64_t one { 1 }, empty { ~std::uint64_t { 0 } };
+    f.seekp(static_cast<std::streamoff>(offset));
+    f.write(reinterpret_cast<const char*>(&empty), sizeof empty);
+    for (std::uint32_t kind : { kEdgeKeys, kEdgeKeyIds }) {
+        f.seekp(entry(kind, 16));
+        f.write(reinterpret_cast<const char*>(&one), sizeof one);
+    }
+    f.flush();
+    EXPECT_THROW(MeshCache { mesh.cache }, std::runtime_error);
+}
+
+TEST(MeshCache, FailedWriteLeavesNoTemporary) {
+    TempMesh mesh("tmpfile.obj", kPyramidObj);
+    Object o;
+    loadMeshCached(mesh.path, o);
+    // A directory in the cache's place makes the final rename fail.
+    const auto target { std::filesystem::temp_directory_path() / "math3d_cache_dir.m3dc" };
+    std::filesystem::create_directories(target / "occupied");
+    EXPECT_THROW(writeMeshCache(target.string(), o, {}), std::runtime_error);
+    EXPECT_FALSE(std::filesystem::exists(target.string() + ".tmp"));
+    std::filesystem::remove_all(target);
+}
+
+TEST(MeshCache, SectionsPointIntoTheMapping) {
+    TempMesh mesh("sections.obj", kPyramidObj);
+    Object o;
+    loadMeshCached(mesh.path, o);
+
+    const MeshCache cache(mesh.cache);
+    EXPECT_EQ(cache.vertices().size(), 5u);
+    EXPECT_EQ(cache.faceOffsets().size(), 6u);
+    EXPECT_EQ(cache.triIndices().size(), 6u) << "only the quad base is triangulated";
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(cache.vertices().data()) % 64, 0u);
+    EXPECT_EQ(cache.source(), MeshSourceStamp::of(mesh.path));
+}
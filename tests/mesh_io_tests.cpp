@@ -0,0 +1,244 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "mapped_file.hpp"
+#include "mesh_io.hpp"
+
+using namespace math3d;
+
+namespace {
+
+std::string TempPath(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / ("math3d_" + name)).string();
+}
+
+std::string WriteFile(const std::string& name, const std::string& contents) {
+    const std::string path { TempPath(name) };
+    std::ofstream(path, std::ios::binary) << contents;
+    return path;
+}
+
+const char* kCubeObj =
+    "# unit cube\n"
+    "v -1 -1 -1\nv 1 -1 -1\nv 1 1 -1\nv -1 1 -1\n"
+    "v -1 -1 1\nv 1 -1 1\nv 1 1 1\nv -1 1 1\n"
+    "vn 0 0 1\n"
+    "f 1 2 3 4\n"
+    "f 5/1/1 8/1/1 7/1/1 6/1/1\n"
+    "f 1//1 5//1 6//1 2//1\n"
+    "f 3 7 8 4\n"
+    "f -8 -5 -1 -4\r\n"
+    "f 2 6 7 3\n";
+
+template <typename T>
+void Put(std::string& out, T v, bool bigEndian) {
+    unsigned char b[sizeof(T)];
+    std::memcpy(b, &v, sizeof(T));
+    if (bigEndian == (std::endian::native == std::endian::little)) std::reverse(b, b + sizeof(T));
+    out.append(reinterpret_cast<const char*>(b), sizeof(T));
+}
+
+std::string BinaryTetraPly(bool bigEndian) {
+    std::string s { "ply\nformat " };
+    s += bigEndian ? "binary_big_endian" : "binary_little_endian";
+    s += " 1.0\ncomment tetrahedron\n"
+         "element vertex 4\nproperty float x\nproperty float y\nproperty float z\nproperty uchar red\n"
+         "element face 4\nproperty list uchar int vertex_indices\n"
+         "end_header\n";
+    const float v[4][3] { {0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1} };
+    for (const auto& p : v) {
+        for (float c : p) Put(s, c, bigEndian);
+        Put<std::uint8_t>(s, 200, bigEndian);
+    }
+    const int f[4][3] { {0, 2, 1}, {0, 1, 3}, {0, 3, 2}, {1, 2, 3} };
+    for (const auto& t : f) {
+        Put<std::uint8_t>(s, 3, bigEndian);
+        for (int i : t) Put<std::int32_t>(s, i, bigEndian);
+    }
+    return s;
+}
+
+}
+
+TEST(MeshIO, LoadsObjPolygonsAndIndexForms) {
+    const std::string path { WriteFile("cube.obj", kCubeObj) };
+    Object o;
+    const MeshLoadStats st { loadObj(path, o) };
+    std::remove(path.c_str());
+
+    EXPECT_EQ(st.vertices, 8u);
+    EXPECT_EQ(st.faces, 6u);
+    EXPECT_EQ(st.edges, 12u) << "shared sides must be deduplicated";
+    ASSERT_EQ(o.planes.size(), 6u);
+    EXPECT_EQ(o.planes[1].verts, (std::vector<int>{4, 7, 6, 5}));
+    EXPECT_EQ(o.planes[1].tris, (std::vector<std::vector<int>>{{4, 7, 6}, {4, 6, 5}}));
+    EXPECT_EQ(o.planes[4].verts, (std::vector<int>{0, 3, 7, 4})) << "negative indices count back from the end";
+    EXPECT_EQ(o.original[6].x, 1.0f);
+    EXPECT_TRUE(o.topologyDirty);
+
+    o.update();
+    EXPECT_EQ(o.topology.edgeCount(), 12u);
+}
+
+TEST(MeshIO, LoadsAsciiPly) {
+    const std::string path { WriteFile("quad.ply",
+        "ply\nformat ascii 1.0\n"
+        "element vertex 4\nproperty double x\nproperty double y\nproperty double z\nproperty float nx\n"
+        "element face 1\nproperty list uchar uint vertex_index\n"
+        "element edge 1\nproperty int vertex1\nproperty int vertex2\n"
+        "end_header\n"
+        "0 0 0 1\n1 0 0 1\n1 1 0 1\n0 1 0.5 1\n"
+        "4 0 1 2 3\n"
+        "0 2\n") };
+    Object o;
+    const MeshLoadStats st { loadMesh(path, o) };
+    std::remove(path.c_str());
+
+    EXPECT_EQ(st.vertices, 4u);
+    EXPECT_EQ(st.faces, 1u);
+    EXPECT_EQ(st.edges, 4u);
+    EXPECT_EQ(o.original[3].z, 0.5f);
+}
+
+TEST(MeshIO, LoadsBinaryPlyInBothByteOrders) {
+    for (bool bigEndian : { false, true }) {
+        const std::string path { WriteFile(bigEndian ? "tetra_be.PLY" : "tetra_le.ply", BinaryTetraPly(bigEndian)) };
+        Object o;
+        const MeshLoadStats st { loadMesh(path, o) };
+        std::remove(path.c_str());
+
+        EXPECT_EQ(st.vertices, 4u);
+        EXPECT_EQ(st.faces, 4u);
+        EXPECT_EQ(st.edges, 6u);
+        EXPECT_EQ(o.original[3].z, 1.0f);
+        EXPECT_EQ(o.planes[3].verts, (std::vector<int>{1, 2, 3}));
+        EXPECT_TRUE(o.planes[3].tris.empty());
+    }
+}
+
+TEST(MeshIO, ConcaveMeshKeepsItsWinding) {
+    // An L-shaped prism: the two faces inside the corner point towards the centroid,
+    // so orienting them away from it would invert them.
+    const float l[6][2] { {0, 0}, {3, 0}, {3, 1}, {1, 1}, {1, 3}, {0, 3} };
+    std::string s;
+    for (float z : { 0.0f, 1.0f })
+        for (const auto& p : l) s += "v " + std::to_string(p[0]) + " " + std::to_string(p[1]) + " " + std::to_string(z) + "\n";
+    s += "f 6 5 4 3 2 1\nf 7 8 9 10 11 12\n";
+    for (int i = 0; i < 6; ++i) {
+        const int a { i + 1 }, b { (i + 1) % 6 + 1 };
+        s += "f " + std::to_string(a) + " " + std::to_string(b) + " " + std::to_string(b + 6) + " " +
+             std::to_string(a + 6) + "\n";
+    }
+    const std::string path { WriteFile("ell.obj", s) };
+    Object o;
+    loadObj(path, o);
+    std::remove(path.c_str());
+    EXPECT_FALSE(o.convex);
+
+    o.computeFaceNormals();
+    EXPECT_EQ(o.faceNormals.z[0], -1.0f);
+    EXPECT_EQ(o.faceNormals.z[1], 1.0f);
+    for (int i = 0; i < 6; ++i) {
+        // Outward side normal of the counter-clockwise outline edge i -> i+1.
+        const float* a { l[i] };
+        const float* b { l[(i + 1) % 6] };
+        const float len { std::hypot(b[0] - a[0], b[1] - a[1]) };
+        EXPECT_FLOAT_EQ(o.faceNormals.x[2 + i], (b[1] - a[1]) / len) << "side " << i;
+        EXPECT_FLOAT_EQ(o.faceNormals.y[2 + i], (a[0] - b[0]) / len) << "side " << i;
+    }
+}
+
+TEST(MeshIO, SmallWindowStreamsLargeFile) {
+    // A strip of quads well past the window size, so the reader has to slide many times.
+    const int n { 20000 };
+    std::string s;
+    for (int i = 0; i <= n; ++i) {
+        s += "v " + std::to_string(i) + " 0 0\n";
+        s += "v " + std::to_string(i) + " 1 0\n";
+    }
+    for (int i = 0; i < n; ++i) {
+        const int a { 2 * i + 1 };
+        s += "f " + std::to_string(a) + " " + std::to_string(a + 2) + " " + std::to_string(a + 3) + " " +
+             std::to_string(a + 1) + "\n";
+    }
+    ASSERT_GT(s.size(), 100'000u);
+    const std::string path { WriteFile("strip.obj", s) };
+
+    Object o;
+    MeshLoadOptions options;
+    options.windowBytes = 4096;
+    const MeshLoadStats st { loadObj(path, o, options) };
+    std::remove(path.c_str());
+
+    EXPECT_EQ(st.bytes, s.size());
+    EXPECT_EQ(st.vertices, static_cast<size_t>(2 * (n + 1)));
+    EXPECT_EQ(st.faces, static_cast<size_t>(n));
+    EXPECT_EQ(st.edges, static_cast<size_t>(3 * n + 1));
+    EXPECT_EQ(o.original.back().x, static_cast<float>(n));
+    EXPECT_EQ(o.planes.back().verts, (std::vector<int>{2 * n - 2, 2 * n, 2 * n + 1, 2 * n - 1}));
+}
+
+TEST(MeshIO, SequentialReaderHandlesLinesLongerThanTheWindow) {
+    const std::string longLine(3 * MappedFile::granularity() + 17, 'x');
+    const std::string path { WriteFile("long.txt", "a\n" + longLine + "\nb") };
+    SequentialReader in(path, 1);
+    std::string_view line;
+    ASSERT_TRUE(in.nextLine(line));
+    EXPECT_EQ(line, "a");
+    ASSERT_TRUE(in.nextLine(line));
+    EXPECT_EQ(line, longLine);
+    ASSERT_TRUE(in.nextLine(line));
+    EXPECT_EQ(line, "b");
+    EXPECT_FALSE(in.nextLine(line));
+    std::remove(path.c_str());
+}
+
+TEST(MeshIO, RejectsBadInput) {
+    Object o;
+    EXPECT_THROW(loadMesh(TempPath("does_not_exist.obj"), o), std::runtime_error);
+    EXPECT_THROW(loadMesh(TempPath("mesh.stl"), o), std::runtime_error);
+
+    const std::string bad { WriteFile("bad.obj", "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 4\n") };
+    EXPECT_THROW(loadObj(bad, o), std::runtime_error);
+    std::remove(bad.c_str());
+
+    const std::string truncated { WriteFile("truncated.ply", BinaryTetraPly(false).substr(0, 200)) };
+    EXPECT_THROW(loadPly(truncated, o), std::runtime_error);
+    std::remove(truncated.c_str());
+}
+
+TEST(MeshIO, RejectsPlyCountsTheFileCannotHold) {
+    Object o;
+    const auto rejects = [&](const std::string& name, const std::string& contents) {
+        const std::string path { WriteFile(name, contents) };
+        EXPECT_THROW(loadPly(path, o), std::runtime_error) << name;
+        std::remove(path.c_str());
+    };
+    const std::string header { "element face 0\nproperty list uchar int vertex_indices\nend_header\n" };
+    rejects("huge_ascii.ply", "ply\nformat ascii 1.0\nelement vertex 4000000000000000000\n"
+                              "property float x\nproperty float y\nproperty float z\n" + header + "0 0 0\n");
+    rejects("huge_binary.ply", "ply\nformat binary_little_endian 1.0\nelement vertex 1000000000\n"
+                               "property float x\nproperty float y\nproperty float z\n" + header +
+                               std::string(12, '\0'));
+
+    std::string faces { BinaryTetraPly(false) };
+    faces.replace(faces.find("element face 4"), 14, "element face 1000000000");
+    rejects("huge_faces.ply", faces);
+
+    // A last ASCII line without its line break still fits.
+    const std::string exact { WriteFile("exact.ply", "ply\nformat ascii 1.0\nelement vertex 1\nproperty float x\n"
+                                                     "property float y\nproperty float z\nend_header\n1 2 3") };
+    EXPECT_NO_THROW(loadPly(exact, o));
+    EXPECT_EQ(o.original.size(), 1u);
+    std::remove(exact.c_str());
+}
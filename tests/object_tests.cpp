@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+
+#include "object.hpp"
+#include "test_meshes.hpp"
+
+using namespace math3d;
+
+TEST(Object, IdleUpdateDoesNoWork) {
+    Object o { MakeViewedCube() };
+    ASSERT_TRUE(o.update());
+    const auto transformed { o.stats.transformedVertices };
+
+    o.setModel(Mat4::identity());
+    EXPECT_FALSE(o.update()) << "setting an identical matrix must not trigger a recompute";
+    EXPECT_EQ(o.stats.transformedVertices, transformed);
+    EXPECT_EQ(o.stats.skipped, 1u);
+}
+
+TEST(Object, WireframeProjectsInOneFusedPass) {
+    Object o { MakeViewedCube() };
+    o.useRoberts = false;
+    o.update();
+    EXPECT_EQ(o.stats.worldPasses, 0u) << "wireframe objects must not produce world space";
+    EXPECT_EQ(o.stats.projectedPasses, 1u);
+
+    const Vertex expected { mulMatVec(o.projection, mulMatVec(o.view, o.original[6])) };
+    EXPECT_NEAR(o.projected[6].x, expected.x, 1e-5f);
+    EXPECT_NEAR(o.projected[6].y, expected.y, 1e-5f);
+    EXPECT_NEAR(o.projected[6].z, expected.z, 1e-5f);
+}
+
+TEST(Object, FacingSelectsFacesNearestTheEye) {
+    Object o { MakeViewedCube() };
+    o.update();
+
+    // Faces nearer the eye have the smaller projected depth than their opposite face.
+    const int opposite[] {1, 0, 3, 2, 5, 4};
+    for (size_t f = 0; f < o.planes.size(); ++f) {
+        float depth = 0.0f, oppositeDepth = 0.0f;
+        for (int v : o.planes[f].verts) depth += o.projected[v].z;
+        for (int v : o.planes[opposite[f]].verts) oppositeDepth += o.projected[v].z;
+        EXPECT_EQ(o.isFacing(f), depth < oppositeDepth) << "face " << f;
+    }
+    EXPECT_EQ(o.visibleEdges.size(), 9u) << "three facing cube faces share nine edges";
+}
+
+TEST(Object, SoALayoutMatchesAoS) {
+    Object aos { MakeViewedCube() };
+    Object soa { MakeViewedCube() };
+    soa.setLayout(VertexLayout::SoA);
+    aos.setModel(rotZ(0.4f));
+    soa.setModel(rotZ(0.4f));
+    aos.update();
+    soa.update();
+
+    for (size_t i = 0; i < aos.original.size(); ++i) {
+        const Vertex a { aos.projectedAt(i) };
+        const Vertex b { soa.projectedAt(i) };
+        EXPECT_EQ(a.x, b.x);
+        EXPECT_EQ(a.y, b.y);
+        EXPECT_EQ(a.z, b.z);
+    }
+    EXPECT_EQ(aos.facing, soa.facing);
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "point_stream.hpp"
+
+using namespace math3d;
+
+namespace {
+
+std::string TempPath(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / ("math3d_" + name)).string();
+}
+
+std::string WriteFile(const std::string& name, const std::string& contents) {
+    const std::string path { TempPath(name) };
+    std::ofstream(path, std::ios::binary) << contents;
+    return path;
+}
+
+std::string ReadFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream s;
+    s << in.rdbuf();
+    return s.str();
+}
+
+std::vector<Vertex> Points(size_t n) {
+    std::vector<Vertex> p(n);
+    for (size_t i = 0; i < n; ++i) p[i] = make_vertex(0.5f * i, -0.25f * i, 1.0f + i);
+    return p;
+}
+
+std::string Binary(const std::vector<Vertex>& points) {
+    std::string s;
+    for (const auto& v : points) {
+        const float xyz[3] = {v.x, v.y, v.z};
+        s.append(reinterpret_cast<const char*>(xyz), sizeof(xyz));
+    }
+    return s;
+}
+
+std::vector<Vertex> ParseBinary(const std::string& bytes) {
+    std::vector<Vertex> p(bytes.size() / 12);
+    for (size_t i = 0; i < p.size(); ++i) {
+        float xyz[3];
+        std::memcpy(xyz, bytes.data() + i * 12, 12);
+        p[i] = make_vertex(xyz[0], xyz[1], xyz[2]);
+    }
+    return p;
+}
+
+}
+
+TEST(PointStream, TransformsTextInOrderAcrossManySmallChunks) {
+    const std::string in { WriteFile("points.xyz", "# header\n1 2 3\n\n-1.5 0 4 255 255 255\r\n+2e1\t1 -1\n") };
+    const std::string out { TempPath("points_out.xyz") };
+    PointStreamOptions opt;
+    opt.chunkPoints = 1;
+    opt.chunksInFlight = 2;
+    const PointStreamStats st { transformPointFile(in, PointFormat::Xyz, out, PointFormat::Xyz, translate(1, 0, -1), opt) };
+    EXPECT_EQ(st.points, 3u);
+    EXPECT_EQ(ReadFile(out), "2 2 2\n-0.5 0 3\n21 1 -2\n");
+}
+
+TEST(PointStream, BinaryRoundTripMatchesTheKernel) {
+    const auto points { Points(10'007) };
+    const std::string in { WriteFile("points.bin", Binary(points)) };
+    const std::string out { TempPath("points_out.bin") };
+    const Mat4 m { matMul(ortho(-10, 10, -10, 10, 0.1f, 100), matMul(rotY(0.3f), scaleMat(2, 2, 2))) };
+    TaskScheduler pool(3);
+    PointStreamOptions opt;
+    opt.chunkPoints = 1000;
+    opt.scheduler = &pool;
+    const PointStreamStats st { transformPointFile(in, PointFormat::Binary, out, PointFormat::Binary, m, opt) };
+    EXPECT_EQ(st.points, points.size());
+    EXPECT_EQ(st.bytesRead, points.size() * 12);
+    EXPECT_EQ(st.bytesWritten, points.size() * 12);
+
+    std::vector<Vertex> expected(points.size());
+    transformVertices(m, points, expected);
+    const auto got { ParseBinary(ReadFile(out)) };
+    ASSERT_EQ(got.size(), expected.size());
+    for (size_t i = 0; i < got.size(); ++i) {
+        EXPECT_EQ(got[i].x, expected[i].x) << i;
+        EXPECT_EQ(got[i].y, expected[i].y) << i;
+        EXPECT_EQ(got[i].z, expected[i].z) << i;
+    }
+}
+
+TEST(PointStream, TextOutputReadsBackExactly) {
+    const auto points { Points(500) };
+    const std::string in { WriteFile("points_rt.bin", Binary(points)) };
+    const std::string text { TempPath("points_rt.xyz") };
+    const std::string back { TempPath("points_rt_back.bin") };
+    const Mat4 m { rotZ(1.1f) };
+    transformPointFile(in, PointFormat::Binary, text, PointFormat::Xyz, m);
+    transformPointFile(text, PointFormat::Xyz, back, PointFormat::Binary, Mat4::identity());
+    std::vector<Vertex> expected(points.size());
+    transformVertices(m, points, expected);
+    const auto got { ParseBinary(ReadFile(back)) };
+    ASSERT_EQ(got.size(), expected.size());
+    for (size_t i = 0; i < got.size(); ++i) EXPECT_EQ(got[i].y, expected[i].y) << i;
+}
+
+TEST(PointStream, RejectsBadInput) {
+    const std::string out { TempPath("points_bad_out.xyz") };
+    const std::string bad { WriteFile("points_bad.xyz", "1 2 3\n4 five 6\n") };
+    EXPECT_THROW(transformPointFile(bad, PointFormat::Xyz, out, PointFormat::Xyz, Mat4::identity()), std::runtime_error);
+    const std::string shortLine { WriteFile("points_short.xyz", "1 2\n") };
+    EXPECT_THROW(transformPointFile(shortLine, PointFormat::Xyz, out, PointFormat::Xyz, Mat4::identity()), std::runtime_error);
+    const std::string torn { WriteFile("points_torn.bin", std::string(13, '\0')) };
+    EXPECT_THROW(transformPointFile(torn, PointFormat::Binary, out, PointFormat::Xyz, Mat4::identity()), std::runtime_error);
+
+    Mat4 perspective { Mat4::identity() };
+    perspective(3, 2) = -1.0f;
+    const std::string good { WriteFile("points_good.xyz", "1 2 3\n") };
+    EXPECT_THROW(transformPointFile(good, PointFormat::Xyz, out, PointFormat::Xyz, perspective), std::runtime_error);
+    EXPECT_THROW(transformPointFile(good, PointFormat::Xyz, good, PointFormat::Xyz, Mat4::identity()), std::runtime_error);
+
+    EXPECT_EQ(pointFormatFor("scan.XYZ"), PointFormat::Xyz);
+    EXPECT_EQ(pointFormatFor("scan.f32"), PointFormat::Binary);
+    EXPECT_THROW(pointFormatFor("scan.las"), std::runtime_error);
+}
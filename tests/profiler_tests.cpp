@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+#include "profiler.hpp"
+#include "task_scheduler.hpp"
+
+using namespace math3d;
+
+TEST(Profiler, DisabledRecordsNothing) {
+    Profiler p(16);
+    { ProfileScope scope("idle", p); }
+    std::vector<ProfileEvent> events;
+    p.snapshot(events);
+    EXPECT_TRUE(events.empty());
+}
+
+TEST(Profiler, NestedScopesCarryDepthAndFrame) {
+    Profiler p(16);
+    p.setEnabled(true);
+    p.beginFrame();
+    {
+        ProfileScope outer("outer", p);
+        ProfileScope inner("inner", p);
+    }
+    std::vector<ProfileEvent> events;
+    p.snapshot(events);
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_STREQ(events[0].name, "inner");
+    EXPECT_EQ(events[0].depth, 1u);
+    EXPECT_STREQ(events[1].name, "outer");
+    EXPECT_EQ(events[1].depth, 0u);
+    EXPECT_LE(events[1].beginNs, events[0].beginNs);
+    EXPECT_GE(events[1].endNs, events[0].endNs);
+    EXPECT_EQ(events[0].frame, 1u);
+    EXPECT_EQ(events[0].thread, events[1].thread);
+}
+
+TEST(Profiler, RingKeepsTheNewestEvents) {
+    Profiler p(5);
+    EXPECT_EQ(p.capacity(), 8u);
+    for (std::uint64_t i = 0; i < 20; ++i) p.record("e", i, i + 1, 0);
+    std::vector<ProfileEvent> events;
+    p.snapshot(events);
+    ASSERT_EQ(events.size(), 8u);
+    EXPECT_EQ(events.front().beginNs, 12u);
+    EXPECT_EQ(events.back().beginNs, 19u);
+}
+
+TEST(Profiler, ConcurrentWritersNeverTearEvents) {
+    // Every writer stores end = begin + its own id, so a mixed-up slot shows.
+    Profiler p(1024);
+    TaskScheduler pool(4);
+    std::atomic<bool> done{false};
+    std::thread reader([&] {
+        std::vector<ProfileEvent> events;
+        while (!done.load()) {
+            p.snapshot(events);
+            for (const auto& e : events) ASSERT_EQ(e.endNs - e.beginNs, e.depth);
+        }
+    });
+    pool.parallelFor(64, 1, [&](size_t b, size_t e) {
+        for (size_t w = b; w < e; ++w)
+            for (std::uint64_t i = 0; i < 2000; ++i) p.record("w", i, i + w, static_cast<std::uint32_t>(w));
+    });
+    done = true;
+    reader.join();
+    std::vector<ProfileEvent> events;
+    p.snapshot(events);
+    EXPECT_EQ(events.size(), 1024u);
+}
+
+TEST(Profiler, ReportPercentilesPerStage) {
+    std::vector<ProfileEvent> events;
+    // Stage "a" takes f+1 ms in frame f, twice in frame 3; "b" runs in even frames only.
+    for (std::uint64_t f = 0; f < 100; ++f) {
+        events.push_back({"a", 0, (f + 1) * 1'000'000, f});
+        if (f == 3) events.push_back({"a", 0, 1'000'000, f});
+        if (f % 2 == 0) events.push_back({"b", 0, 500'000, f});
+    }
+    events.push_back({"a", 0, 999'000'000, 100});  // outside the range
+
+    ProfileReport r;
+    r.build(events, 0, 100);
+    ASSERT_EQ(r.stages().size(), 2u);
+    const auto& a = r.stages()[0];
+    EXPECT_STREQ(a.name, "a");
+    EXPECT_EQ(a.frames, 100u);
+    EXPECT_DOUBLE_EQ(a.p50, 50.0);
+    EXPECT_DOUBLE_EQ(a.p95, 95.0);
+    EXPECT_DOUBLE_EQ(a.p99, 99.0);
+    EXPECT_DOUBLE_EQ(a.max, 100.0);
+    const auto& b = r.stages()[1];
+    EXPECT_EQ(b.frames, 50u);
+    EXPECT_DOUBLE_EQ(b.max, 0.5);
+
+    r.build(events, 90, 100);
+    EXPECT_DOUBLE_EQ(r.stages()[0].p50, 95.0);
+    r.build(events, 5, 5);
+    EXPECT_TRUE(r.stages().empty());
+}
+
+TEST(Profiler, WritesChromeTrace) {
+    const std::vector<ProfileEvent> events {
+        {"draw", 1000, 3500, 7, 0, 0},
+        {"say \"hi\"", 2000, 2500, 7, 2, 1},
+    };
+    const auto path = (std::filesystem::temp_directory_path() / "math3d_trace_test.json").string();
+    writeChromeTrace(path, events);
+    std::ifstream in(path);
+    const std::string text { std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+    std::remove(path.c_str());
+    EXPECT_EQ(text.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0), 0u);
+    EXPECT_NE(text.find("{\"name\":\"draw\",\"cat\":\"math3d\",\"ph\":\"X\",\"ts\":1.000,\"dur\":2.500,\"pid\":1,\"tid\":0,\"args\":{\"frame\":7}}"),
+              std::string::npos);
+    EXPECT_NE(text.find("\"name\":\"say \\\"hi\\\"\""), std::string::npos);
+    EXPECT_NE(text.find("\"tid\":2"), std::string::npos);
+    EXPECT_EQ(std::count(text.begin(), text.end(), '\n'), 4);
+    EXPECT_THROW(writeChromeTrace("/nonexistent/dir/trace.json", events), std::runtime_error);
+}
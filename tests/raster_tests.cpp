@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "raster.hpp"
+#include "task_scheduler.hpp"
+#include "test_meshes.hpp"
+
+using namespace math3d;
+
+namespace {
+
+Object UpdatedCube() {
+    Object o { MakeViewedCube() };
+    o.update();
+    return o;
+}
+
+// Object with hand-set projected vertices and every face facing.
+Object MakeFlat(std::vector<Vertex> projected, std::vector<Plane> planes) {
+    Object o;
+    o.original = projected;
+    o.projected = std::move(projected);
+    o.planes = std::move(planes);
+    o.facing.assign((o.planes.size() + 63) / 64, ~std::uint64_t{0});
+    return o;
+}
+
+int ScreenX(float ndc, int width) { return static_cast<int>((ndc + 1.0f) * 0.5f * width); }
+int ScreenY(float ndc, int height) { return static_cast<int>((1.0f - ndc) * 0.5f * height); }
+
+}
+
+TEST(Raster, CubeFacesEdgesAndBackground) {
+    const Object cube { UpdatedCube() };
+    RasterOptions opt;
+    opt.width = opt.height = 200;
+    SoftwareRasterizer r(opt);
+    r.draw(cube);
+
+    EXPECT_EQ(r.pixel(0, 0), packRgba(opt.clearColor));
+    EXPECT_EQ(r.stats().triangles, 6u) << "three facing quads, two triangles each";
+    EXPECT_EQ(r.stats().lines, cube.visibleEdges.size());
+
+    for (size_t f = 0; f < cube.planes.size(); ++f) {
+        if (!cube.isFacing(f)) continue;
+        Vertex c {0, 0, 0};
+        for (int i : cube.planes[f].verts) {
+            c.x += cube.projected[i].x / 4;
+            c.y += cube.projected[i].y / 4;
+        }
+        EXPECT_EQ(r.pixel(ScreenX(c.x, 200), ScreenY(c.y, 200)), packRgba(opt.faceColor)) << "face " << f;
+    }
+    const Vertex corner { cube.projected[cube.edges[cube.visibleEdges[0]].first] };
+    EXPECT_EQ(r.pixel(std::min(ScreenX(corner.x, 200), 199), std::min(ScreenY(corner.y, 200), 199)),
+              packRgba(opt.lineColor));
+}
+
+TEST(Raster, ImageDoesNotDependOnTilesOrThreads) {
+    const Object cube { UpdatedCube() };
+    RasterOptions opt;
+    opt.width = 333;
+    opt.height = 257;
+    opt.tileSize = 64;
+    SoftwareRasterizer reference(opt);
+    reference.draw(cube);
+
+    TaskScheduler pool(3);
+    for (int tile : { 7, 16, 128 }) {
+        opt.tileSize = tile;
+        SoftwareRasterizer r(opt);
+        r.draw(cube, &pool);
+        EXPECT_EQ(r.color(), reference.color()) << "tile " << tile;
+        EXPECT_EQ(r.depth(), reference.depth()) << "tile " << tile;
+    }
+}
+
+TEST(Raster, NearerTriangleWinsInEitherOrder) {
+    // Two overlapping screen-filling triangles at NDC z = 0.5 and z = -0.5.
+    const std::vector<Vertex> far { {-1, -1, 0.5f}, {3, -1, 0.5f}, {-1, 3, 0.5f} };
+    const std::vector<Vertex> near { {-1, -1, -0.5f}, {3, -1, -0.5f}, {-1, 3, -0.5f} };
+    for (bool nearFirst : { false, true }) {
+        std::vector<Vertex> v { nearFirst ? near : far };
+        const auto& second { nearFirst ? far : near };
+        v.insert(v.end(), second.begin(), second.end());
+        Object o { MakeFlat(v, {{{0, 1, 2}, {}}, {{3, 4, 5}, {}}}) };
+
+        RasterOptions opt;
+        opt.width = opt.height = 32;
+        SoftwareRasterizer r(opt);
+        r.draw(o);
+        EXPECT_FLOAT_EQ(r.depth()[16 * 32 + 16], 0.25f);
+        EXPECT_EQ(r.pixel(16, 16), packRgba(opt.faceColor));
+    }
+}
+
+TEST(Raster, SplitQuadCoversExactlyItsPixelCenters) {
+    // A quad split along its diagonal: no gap along the shared edge and, thanks to the
+    // top-left rule, nothing on the right/bottom border of the quad.
+    Object o { MakeFlat({ {-0.5f, -0.5f, 0}, {0.5f, -0.5f, 0}, {0.5f, 0.5f, 0}, {-0.5f, 0.5f, 0} },
+                        {{{0, 1, 2}, {}}, {{0, 2, 3}, {}}}) };
+    RasterOptions opt;
+    opt.width = opt.height = 64;
+    SoftwareRasterizer r(opt);
+    r.draw(o);
+    size_t covered { 0 };
+    for (float d : r.depth()) covered += d < 1.0f;
+    EXPECT_EQ(covered, 32u * 32u) << "no gaps and no pixel outside the quad";
+}
+
+TEST(Raster, WritesPpmAndPng) {
+    RasterOptions opt;
+    opt.width = 300;
+    opt.height = 250;
+    SoftwareRasterizer r(opt);
+    r.draw(UpdatedCube());
+
+    const std::string ppm { (std::filesystem::temp_directory_path() / "math3d_raster.ppm").string() };
+    const std::string png { (std::filesystem::temp_directory_path() / "math3d_raster.png").string() };
+    writePpm(ppm, r);
+    writePng(png, r);
+
+    const std::string header { "P6\n300 250\n255\n" };
+    EXPECT_EQ(std::filesystem::file_size(ppm), header.size() + 300u * 250u * 3u);
+    std::ifstream in(png, std::ios::binary);
+    char sig[8];
+    in.read(sig, 8);
+    EXPECT_EQ(std::string(sig + 1, 3), "PNG");
+    const size_t raw { 250u * (1u + 300u * 3u) };
+    const size_t blocks { (raw + 65534) / 65535 };
+    EXPECT_EQ(std::filesystem::file_size(png), 8 + (12 + 13) + (12 + 2 + 5 * blocks + raw + 4) + 12);
+    std::remove(ppm.c_str());
+    std::remove(png.c_str());
+}
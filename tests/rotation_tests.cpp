@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "rotation.hpp"
+#include "transform_expr.hpp"
+
+using namespace math3d;
+
+namespace {
+
+std::int64_t Ulps(float a, float b) {
+    std::int32_t ia, ib;
+    std::memcpy(&ia, &a, 4);
+    std::memcpy(&ib, &b, 4);
+    // Map the sign-magnitude bits onto a monotonic integer line so +0 and -0 meet.
+    const std::int64_t la = ia < 0 ? -static_cast<std::int64_t>(ia & 0x7fffffff) : ia;
+    const std::int64_t lb = ib < 0 ? -static_cast<std::int64_t>(ib & 0x7fffffff) : ib;
+    return la > lb ? la - lb : lb - la;
+}
+
+Affine3x4 MatrixChain(float x, float y, float z) {
+    return matMul(matMul(Affine3x4::rotX(x), Affine3x4::rotY(y)), Affine3x4::rotZ(z));
+}
+
+void ExpectNear(const Affine3x4& a, const Affine3x4& b, float eps) {
+    for (int i = 0; i < 12; ++i) EXPECT_NEAR(a.m[i], b.m[i], eps) << i;
+}
+
+}
+
+TEST(Rotation, SinCosWithinTwoUlps) {
+    // Dense near zero, then the whole documented range; scalar and batch must agree bitwise.
+    std::vector<float> angles;
+    for (int i = -200000; i <= 200000; ++i) angles.push_back(i * 1e-4f);
+    for (int i = -200000; i <= 200000; ++i) angles.push_back(i * 0.04096f);
+    std::vector<float> s(angles.size()), c(angles.size());
+    sinCos(angles, s, c);
+    std::int64_t worst = 0;
+    for (size_t i = 0; i < angles.size(); ++i) {
+        const double a = angles[i];
+        const std::int64_t es = Ulps(s[i], static_cast<float>(std::sin(a)));
+        const std::int64_t ec = Ulps(c[i], static_cast<float>(std::cos(a)));
+        worst = std::max({worst, es, ec});
+        float ss, cs;
+        sinCos(angles[i], ss, cs);
+        ASSERT_EQ(ss, s[i]) << a;
+        ASSERT_EQ(cs, c[i]) << a;
+    }
+    EXPECT_LE(worst, 2);
+}
+
+TEST(Rotation, EulerMatchesTheMatrixChain) {
+    for (float t : {0.0f, 0.1f, 0.77f, 2.3f, -5.0f}) {
+        const Affine3x4 e { eulerXYZ(0.7f * t, -1.3f * t, 0.4f + t) };
+        ExpectNear(e, MatrixChain(0.7f * t, -1.3f * t, 0.4f + t), 1e-6f);
+        ExpectNear(e, toAffine(quatEulerXYZ(0.7f * t, -1.3f * t, 0.4f + t)), 1e-6f);
+    }
+    ExpectNear(toAffine(quatX(0.5f)), Affine3x4::rotX(0.5f), 1e-6f);
+    ExpectNear(toAffine(quatY(0.5f)), Affine3x4::rotY(0.5f), 1e-6f);
+    ExpectNear(toAffine(quatZ(0.5f)), Affine3x4::rotZ(0.5f), 1e-6f);
+}
+
+TEST(Rotation, EulerFactorComposes) {
+    const auto e = Translation{1, -2, 0.5f} * EulerXYZ{0.3f, -0.8f, 1.9f} * Scaling{2, 1, 0.5f};
+    const auto chain = Translation{1, -2, 0.5f} * RotationX(0.3f) * RotationY(-0.8f) * RotationZ(1.9f) *
+                       Scaling{2, 1, 0.5f};
+    ExpectNear(e.affine(), chain.affine(), 1e-5f);
+}
+
+TEST(Rotation, SlerpInterpolatesAlongTheShortArc) {
+    const Quat a { quatY(0.2f) };
+    const Quat b { quatY(1.4f) };
+    ExpectNear(toAffine(slerp(a, b, 0.0f)), toAffine(a), 1e-6f);
+    ExpectNear(toAffine(slerp(a, b, 1.0f)), toAffine(b), 1e-6f);
+    ExpectNear(toAffine(slerp(a, b, 0.25f)), Affine3x4::rotY(0.5f), 1e-6f);
+    // -b is the same rotation: the result must not take the long way round.
+    const Quat nb { -b.w, -b.x, -b.y, -b.z };
+    ExpectNear(toAffine(slerp(a, nb, 0.5f)), Affine3x4::rotY(0.8f), 1e-6f);
+    // Nearly equal inputs take the lerp fallback and stay unit length.
+    const Quat m { slerp(a, quatY(0.2001f), 0.5f) };
+    EXPECT_NEAR(dot(m, m), 1.0f, 1e-6f);
+}
+
+TEST(Rotation, BatchesMatchTheScalarForms) {
+    const size_t n = 1001;
+    std::vector<float> x(n), y(n), z(n);
+    std::vector<Quat> qa(n), qb(n);
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = 0.01f * i;
+        y[i] = -0.02f * i;
+        z[i] = 1.0f - 0.003f * i;
+        qa[i] = quatEulerXYZ(x[i], y[i], z[i]);
+        qb[i] = quatEulerXYZ(z[i], x[i], y[i]);
+    }
+    std::vector<Affine3x4> e(n), q(n), s(n);
+    eulerXYZ(x, y, z, e);
+    toAffine(qa, q);
+    slerp(qa, qb, 0.3f, s);
+    for (size_t i = 0; i < n; ++i) {
+        EXPECT_TRUE(e[i] == eulerXYZ(x[i], y[i], z[i])) << i;
+        EXPECT_TRUE(q[i] == toAffine(qa[i])) << i;
+        EXPECT_TRUE(s[i] == toAffine(slerp(qa[i], qb[i], 0.3f))) << i;
+    }
+    EXPECT_THROW(eulerXYZ(x, y, std::span<const float>(z).first(3), e), std::runtime_error);
+}
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <stdexcept>
+
+#include "object.hpp"
+#include "scene_graph.hpp"
+#include "task_scheduler.hpp"
+
+using namespace math3d;
+
+namespace {
+
+bool Near(const Mat4& a, const Mat4& b) {
+    for (int i = 0; i < 16; ++i)
+        if (std::abs(a.m[i] - b.m[i]) > 1e-5f) return false;
+    return true;
+}
+
+}
+
+TEST(SceneGraph, WorldIsParentWorldTimesLocal) {
+    SceneGraph g;
+    const auto root = g.addNode(SceneGraph::kNone, translate(1, 0, 0));
+    const auto arm = g.addNode(root, rotZ(deg2rad(90.0f)));
+    const auto hand = g.addNode(arm, translate(0, 2, 0));
+    EXPECT_EQ(g.update(), 3u);
+
+    EXPECT_TRUE(Near(g.world(hand), matMul(matMul(translate(1, 0, 0), rotZ(deg2rad(90.0f))), translate(0, 2, 0))));
+    const Vertex tip = mulMatVec(g.world(hand), make_vertex(0, 0, 0));
+    const Vertex expected = mulMatVec(translate(1, 0, 0), mulMatVec(rotZ(deg2rad(90.0f)), make_vertex(0, 2, 0)));
+    EXPECT_NEAR(tip.x, expected.x, 1e-5f);
+    EXPECT_NEAR(tip.y, expected.y, 1e-5f);
+    EXPECT_EQ(g.parent(hand), arm);
+    EXPECT_EQ(g.parent(root), SceneGraph::kNone);
+}
+
+TEST(SceneGraph, OnlyDirtySubtreesAreRecomputed) {
+    SceneGraph g;
+    const auto root = g.addNode();
+    const auto left = g.addNode(root);
+    const auto leftChild = g.addNode(left);
+    const auto right = g.addNode(root);
+    g.addNode(right);
+    g.addNode(right);
+    g.update();
+
+    EXPECT_EQ(g.update(), 0u) << "idle";
+    g.setLocal(left, translate(0, 1, 0));
+    EXPECT_EQ(g.update(), 2u);
+    EXPECT_TRUE(Near(g.world(leftChild), translate(0, 1, 0)));
+
+    g.setLocal(right, translate(1, 0, 0));
+    g.setLocal(right + 1, translate(1, 0, 0));  // inside right's subtree, not counted twice
+    EXPECT_EQ(g.update(), 3u);
+    EXPECT_TRUE(Near(g.world(right + 1), translate(2, 0, 0)));
+
+    g.setLocal(right, translate(1, 0, 0));  // unchanged
+    EXPECT_EQ(g.update(), 0u);
+    g.setLocal(root, translate(0, 0, 1));
+    EXPECT_EQ(g.update(), 6u);
+    EXPECT_EQ(g.stats.reorders, 0u) << "built depth-first";
+}
+
+TEST(SceneGraph, OutOfOrderInsertionAndReparenting) {
+    SceneGraph g;
+    const auto a = g.addNode(SceneGraph::kNone, translate(1, 0, 0));
+    const auto b = g.addNode(SceneGraph::kNone, translate(0, 1, 0));
+    const auto a1 = g.addNode(a, translate(0, 0, 1));  // a's subtree is no longer at the end
+    const auto b1 = g.addNode(b, translate(0, 0, 2));
+    g.update();
+    EXPECT_EQ(g.stats.reorders, 1u);
+    EXPECT_TRUE(Near(g.world(a1), translate(1, 0, 1)));
+    EXPECT_TRUE(Near(g.world(b1), translate(0, 1, 2)));
+
+    g.setParent(b, a);
+    g.update();
+    EXPECT_TRUE(Near(g.world(b1), translate(1, 1, 2)));
+    g.setLocal(a, Mat4::identity());
+    EXPECT_EQ(g.update(), 4u) << "b and b1 are now part of a's subtree";
+
+    EXPECT_THROW(g.setParent(a, b1), std::runtime_error);
+    EXPECT_THROW(g.setParent(a, a), std::runtime_error);
+    EXPECT_THROW(g.addNode(42), std::runtime_error);
+}
+
+TEST(SceneGraph, ObjectsShareTheCamera) {
+    Object cube, axes;
+    cube.original = axes.original = {make_vertex(0, 0, 0)};
+    cube.useRoberts = axes.useRoberts = false;
+
+    SceneGraph g;
+    const Mat4 view { translate(0, 0, -3) }, proj { ortho(-1, 1, -1, 1, 0.1f, 100) };
+    g.setView(view);
+    g.setProjection(proj);
+    const auto root = g.addNode(SceneGraph::kNone, translate(0.5f, 0, 0));
+    const auto c = g.addNode(root, rotY(0.3f), &cube);
+    g.addNode(root, Mat4::identity(), &axes);
+    g.update();
+    cube.update();
+    axes.update();
+    EXPECT_TRUE(cube.view == view && axes.view == view && cube.projection == proj);
+    EXPECT_TRUE(Near(cube.model, matMul(translate(0.5f, 0, 0), rotY(0.3f))));
+    EXPECT_TRUE(Near(axes.model, translate(0.5f, 0, 0)));
+
+    g.update();
+    EXPECT_FALSE(cube.isDirty()) << "an idle graph leaves objects alone";
+
+    g.setView(translate(0, 0, -4));
+    g.update();
+    EXPECT_TRUE(cube.viewDirty && axes.viewDirty);
+
+    g.setObject(c, nullptr);
+    g.setLocal(c, Mat4::identity());
+    g.update();
+    EXPECT_TRUE(Near(cube.model, matMul(translate(0.5f, 0, 0), rotY(0.3f)))) << "detached";
+    g.setObject(c, &cube);
+    g.update();
+    EXPECT_TRUE(Near(cube.model, translate(0.5f, 0, 0)));
+}
+
+TEST(SceneGraph, ParallelUpdateMatchesSerial) {
+    std::mt19937 rng(3);
+    SceneGraph serial, threaded;
+    for (SceneGraph* g : {&serial, &threaded}) {
+        std::mt19937 shape(5);
+        g->addNode();
+        for (SceneGraph::NodeId i = 1; i < 20000; ++i)
+            g->addNode(std::uniform_int_distribution<SceneGraph::NodeId>(0, i - 1)(shape), rotY(0.001f * i));
+    }
+    TaskScheduler pool(3);
+    serial.update();
+    threaded.update(&pool);
+    for (int frame = 0; frame < 3; ++frame) {
+        for (int k = 0; k < 200; ++k) {
+            const auto n = std::uniform_int_distribution<SceneGraph::NodeId>(0, 19999)(rng);
+            const Mat4 m { translate(0.01f * frame, 0, 0) };
+            serial.setLocal(n, m);
+            threaded.setLocal(n, m);
+        }
+        EXPECT_EQ(serial.update(), threaded.update(&pool));
+    }
+    for (SceneGraph::NodeId i = 0; i < 20000; ++i) ASSERT_TRUE(serial.world(i) == threaded.world(i));
+}
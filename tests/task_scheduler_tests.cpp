@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+#include <stdexcept>
+#include <vector>
+
+#include "object.hpp"
+#include "task_scheduler.hpp"
+
+using namespace math3d;
+
+namespace {
+
+// Ring of quads around the y axis, big enough to be split into many pieces.
+Object MakeBand(int segments) {
+    Object o;
+    for (int s = 0; s < segments; ++s) {
+        const float a { 2.0f * std::numbers::pi_v<float> * s / segments };
+        o.original.push_back(make_vertex(std::cos(a), -0.5f, std::sin(a)));
+        o.original.push_back(make_vertex(std::cos(a), 0.5f, std::sin(a)));
+    }
+    for (int s = 0; s < segments; ++s) {
+        const int a { 2 * s }, b { 2 * ((s + 1) % segments) };
+        o.edges.push_back({a, b});
+        o.edges.push_back({a, a + 1});
+        o.edges.push_back({a + 1, b + 1});
+        o.planes.push_back({{a, b, b + 1, a + 1}, {}});
+    }
+    o.setView(translate(0.0f, 0.0f, -3.0f));
+    o.setProjection(ortho(-2.0f, 2.0f, -2.0f, 2.0f, 0.1f, 100.0f));
+    o.setModel(rotX(deg2rad(20.0f)));
+    return o;
+}
+
+}
+
+TEST(TaskScheduler, CoversEveryIndexExactlyOnce) {
+    TaskScheduler pool(4);
+    std::vector<std::atomic<int>> hits(100'000);
+    pool.parallelFor(hits.size(), 100, [&](size_t b, size_t e) {
+        EXPECT_LE(b, e);
+        for (size_t i = b; i < e; ++i) hits[i].fetch_add(1);
+    });
+    for (const auto& h : hits) ASSERT_EQ(h.load(), 1);
+}
+
+TEST(TaskScheduler, SmallLoopsRunInlineInOnePiece) {
+    TaskScheduler pool(4);
+    int calls { 0 };
+    pool.parallelFor(8, 64, [&](size_t b, size_t e) {
+        ++calls;
+        EXPECT_EQ(b, 0u);
+        EXPECT_EQ(e, 8u);
+    });
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(pool.grainFor(1'000'000, 16), 1'000'000u / 32);
+    EXPECT_EQ(pool.grainFor(100, 16), 16u);
+}
+
+TEST(TaskScheduler, NestedLoopsAndExceptions) {
+    TaskScheduler pool(3);
+    std::atomic<size_t> total { 0 };
+    pool.parallelFor(64, 1, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i)
+            pool.parallelFor(1000, 10, [&](size_t ib, size_t ie) { total += ie - ib; });
+    });
+    EXPECT_EQ(total.load(), 64'000u);
+
+    EXPECT_THROW(pool.parallelFor(10'000, 10, [](size_t b, size_t) {
+        if (b == 0) throw std::runtime_error("invalid piece");
+    }), std::runtime_error);
+}
+
+TEST(TaskScheduler, ParallelObjectMatchesSerialBitForBit) {
+    Object serial { MakeBand(50'000) };
+    serial.update();
+    serial.computeCenter();
+
+    for (unsigned threads : { 1u, 2u, 4u }) {
+        TaskScheduler pool(threads);
+        for (VertexLayout layout : { VertexLayout::AoS, VertexLayout::SoA }) {
+            Object o { MakeBand(50'000) };
+            o.scheduler = &pool;
+            o.setLayout(layout);
+            o.update();
+            o.computeCenter();
+
+            ASSERT_EQ(o.facing, serial.facing) << threads << " threads";
+            EXPECT_EQ(o.visibleEdges, serial.visibleEdges);
+            for (size_t i = 0; i < serial.projected.size(); i += 997) {
+                EXPECT_EQ(o.projectedAt(i).x, serial.projected[i].x);
+                EXPECT_EQ(o.projectedAt(i).y, serial.projected[i].y);
+            }
+            EXPECT_EQ(std::memcmp(&o.center, &serial.center, sizeof(Vertex)), 0)
+                << "the centroid must not depend on the thread count";
+        }
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "math3d.hpp"
+#include "object.hpp"
+
+// Meshes and the camera shared by the unit tests.
+
+// The app's built-in cube, side 0.4 around the origin, with no camera set.
+inline math3d::Object MakeCube() { return math3d::builtinCube(); }
+
+// The app's fixed camera.
+inline math3d::Mat4 AppView() {
+    using namespace math3d;
+    Mat4 view { translate(0.0f, 0.0f, -3.0f) };
+    view = matMul(view, rotX(deg2rad(30.0f)));
+    view = matMul(view, rotY(deg2rad(-40.0f)));
+    return matMul(view, scaleMat(1.0f, 1.0f, -1.0f));
+}
+
+inline math3d::Mat4 AppProjection() { return math3d::ortho(-1.0f, 1.0f, -1.0f, 1.0f, 0.1f, 100.0f); }
+
+// The cube under the app's camera, not yet updated.
+inline math3d::Object MakeViewedCube() {
+    math3d::Object o { MakeCube() };
+    o.setView(AppView());
+    o.setProjection(AppProjection());
+    return o;
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "topology.hpp"
+
+using namespace math3d;
+
+namespace {
+
+const std::vector<Edge> cubeEdges {
+    {0,1},{1,2},{2,3},{3,0},
+    {4,5},{5,6},{6,7},{7,4},
+    {0,4},{1,5},{2,6},{3,7}
+};
+
+const std::vector<std::vector<int>> cubeFaces {
+    {0,1,2,3}, {4,7,6,5}, {0,4,5,1}, {2,6,7,3}, {0,3,7,4}, {1,5,6,2}
+};
+
+}
+
+TEST(Topology, FindsEdgesInEitherDirection) {
+    Topology t;
+    t.build(cubeEdges, cubeFaces);
+
+    EXPECT_EQ(t.findEdge(0, 1), 0);
+    EXPECT_EQ(t.findEdge(1, 0), 0);
+    EXPECT_EQ(t.findEdge(7, 3), 11);
+    EXPECT_EQ(t.findEdge(0, 6), -1) << "a face diagonal is not an edge";
+}
+
+TEST(Topology, EveryCubeEdgeJoinsTwoFaces) {
+    Topology t;
+    t.build(cubeEdges, cubeFaces);
+
+    ASSERT_EQ(t.edgeCount(), cubeEdges.size());
+    ASSERT_EQ(t.faceCount(), cubeFaces.size());
+    for (size_t e = 0; e < t.edgeCount(); ++e)
+        EXPECT_EQ(t.facesOfEdge(e).size(), 2u) << "edge " << e << " of a closed cube must have two faces";
+
+    const auto faces { t.facesOfEdge(0) };
+    EXPECT_EQ(faces[0], 0) << "faces of an edge must be listed in ascending order";
+    EXPECT_EQ(faces[1], 2);
+}
+
+TEST(Topology, ListsEdgesOfFaceInPolygonOrder) {
+    Topology t;
+    t.build(cubeEdges, cubeFaces);
+
+    const auto edges { t.edgesOfFace(1) };
+    const std::vector<int> expected {7, 6, 5, 4};
+    EXPECT_EQ(std::vector<int>(edges.begin(), edges.end()), expected);
+}
+
+TEST(Topology, SkipsPolygonSidesWithoutEdges) {
+    const std::vector<Edge> edges {{0, 1}, {1, 2}};
+    const std::vector<std::vector<int>> faces {{0, 1, 2}};
+
+    Topology t;
+    t.build(edges, faces);
+    EXPECT_EQ(t.edgesOfFace(0).size(), 2u) << "the missing side (2, 0) must be ignored";
+    EXPECT_EQ(t.facesOfEdge(1).size(), 1u);
+}
+
+TEST(Topology, VisibleEdgesBorderAFacingFace) {
+    Topology t;
+    t.build(cubeEdges, cubeFaces);
+
+    // Only the bottom face {0,1,2,3} faces the eye: its four edges are visible.
+    std::vector<int> visible;
+    t.visibleEdges(std::vector<std::uint64_t>{0b000001}, visible);
+    EXPECT_EQ(visible, (std::vector<int>{0, 1, 2, 3}));
+
+    // Faces 0, 2 and 4 meet at vertex 0: everything except the three edges at vertex 6.
+    t.visibleEdges(std::vector<std::uint64_t>{0b010101}, visible);
+    EXPECT_EQ(visible, (std::vector<int>{0, 1, 2, 3, 4, 7, 8, 9, 11}));
+
+    t.visibleEdges(std::vector<std::uint64_t>{0}, visible);
+    EXPECT_TRUE(visible.empty());
+}
+
+TEST(Topology, VisibleEdgesHandlesBoundaryAndNonManifoldEdges) {
+    // Three triangles fanned around the shared edge (0, 1), plus an edge with no face.
+    const std::vector<Edge> edges {{0, 1}, {1, 2}, {2, 0}, {1, 3}, {3, 0}, {1, 4}, {4, 0}, {5, 6}};
+    const std::vector<std::vector<int>> faces {{0, 1, 2}, {0, 1, 3}, {0, 1, 4}};
+
+    Topology t;
+    t.build(edges, faces);
+    ASSERT_EQ(t.facesOfEdge(0).size(), 3u);
+
+    std::vector<int> visible;
+    t.visibleEdges(std::vector<std::uint64_t>{0b100}, visible);
+    EXPECT_EQ(visible, (std::vector<int>{5, 6, 0})) << "non-manifold edges are reported after the paired ones";
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "transform_expr.hpp"
+
+using namespace math3d;
+
+namespace {
+
+constexpr Affine3x4 kView = (Translation{0.0f, 0.0f, -3.0f} * RotationX(deg2rad(30.0f)) *
+                             RotationY(deg2rad(-40.0f)) * Scaling{1.0f, 1.0f, -1.0f}).affine();
+
+// Baked at compile time: the translation survives untouched and the rows stay unit length.
+static_assert(kView(0, 3) == 0.0f && kView(1, 3) == 0.0f && kView(2, 3) == -3.0f);
+static_assert(kView(0, 0) * kView(0, 0) + kView(0, 1) * kView(0, 1) + kView(0, 2) * kView(0, 2) > 0.9999f);
+static_assert(kView(0, 0) * kView(0, 0) + kView(0, 1) * kView(0, 1) + kView(0, 2) * kView(0, 2) < 1.0001f);
+
+constexpr int kAngles = 200;
+
+constexpr float AngleAt(int i) { return -20.0f + 40.0f * i / (kAngles - 1); }
+
+constexpr std::array<detail::SinCos, kAngles> kSeries = [] {
+    std::array<detail::SinCos, kAngles> a{};
+    for (int i = 0; i < kAngles; ++i) a[i] = detail::sinCos(AngleAt(i));
+    return a;
+}();
+
+std::int32_t Ulps(float a, float b) {
+    std::int32_t ia, ib;
+    std::memcpy(&ia, &a, 4);
+    std::memcpy(&ib, &b, 4);
+    if ((ia < 0) != (ib < 0)) return a == b ? 0 : std::abs(ia & 0x7fffffff) + std::abs(ib & 0x7fffffff);
+    return std::abs(ia - ib);
+}
+
+Mat4 MatrixChain(float t) {
+    Mat4 m { translate(0.3f * t, -0.2f, 1.0f + t) };
+    m = matMul(m, rotX(0.7f * t));
+    m = matMul(m, rotY(-1.3f * t));
+    m = matMul(m, rotZ(0.4f + t));
+    m = matMul(m, scaleMat(1.5f, 0.25f + t, -2.0f));
+    return matMul(m, reflect(true, false, true));
+}
+
+}
+
+TEST(TransformExpr, MatchesTheMatrixChainExactly) {
+    for (float t : {0.0f, 0.1f, 0.77f, 2.3f, -5.0f}) {
+        const auto e = Translation{0.3f * t, -0.2f, 1.0f + t} * RotationX(0.7f * t) * RotationY(-1.3f * t) *
+                       RotationZ(0.4f + t) * Scaling{1.5f, 0.25f + t, -2.0f} * reflection(true, false, true);
+        EXPECT_TRUE(e.mat4() == MatrixChain(t)) << t;
+    }
+}
+
+TEST(TransformExpr, SingleFactorsMatchTheBuilders) {
+    EXPECT_TRUE((Translation{1, 2, 3}.affine() == Affine3x4::translate(1, 2, 3)));
+    EXPECT_TRUE((Scaling{2, 3, 4}.affine() == Affine3x4::scale(2, 3, 4)));
+    EXPECT_TRUE(RotationX(0.5f).affine() == Affine3x4::rotX(0.5f));
+    EXPECT_TRUE(RotationY(0.5f).affine() == Affine3x4::rotY(0.5f));
+    EXPECT_TRUE(RotationZ(0.5f).affine() == Affine3x4::rotZ(0.5f));
+    EXPECT_TRUE(reflection(false, true, false).affine() == Affine3x4::reflect(false, true, false));
+}
+
+TEST(TransformExpr, GroupingDoesNotMatter) {
+    const auto a = Translation{1, -2, 0.5f};
+    const auto b = RotationY(0.9f);
+    const auto c = Scaling{2, 1, 0.5f};
+    const Affine3x4 left { ((a * b) * c).affine() };
+    const Affine3x4 right { (a * (b * c)).affine() };
+    for (int i = 0; i < 12; ++i) EXPECT_NEAR(left.m[i], right.m[i], 1e-6f) << i;
+}
+
+TEST(TransformExpr, BakedViewMatchesRuntimeEvaluation) {
+    Mat4 runtime { translate(0.0f, 0.0f, -3.0f) };
+    runtime = matMul(runtime, rotX(deg2rad(30.0f)));
+    runtime = matMul(runtime, rotY(deg2rad(-40.0f)));
+    runtime = matMul(runtime, scaleMat(1.0f, 1.0f, -1.0f));
+    for (int r = 0; r < 3; ++r)
+        for (int c = 0; c < 4; ++c) EXPECT_NEAR(kView(r, c), runtime(r, c), 1e-7f) << r << "," << c;
+}
+
+TEST(TransformExpr, CompileTimeSinCosWithinOneUlp) {
+    for (int i = 0; i < kAngles; ++i) {
+        const double a = AngleAt(i);
+        EXPECT_LE(Ulps(kSeries[i].s, static_cast<float>(std::sin(a))), 1) << a;
+        EXPECT_LE(Ulps(kSeries[i].c, static_cast<float>(std::cos(a))), 1) << a;
+    }
+}
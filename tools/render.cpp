@@ -0,0 +1,102 @@
+// Headless Roberts render: math3d_render [mesh.obj|mesh.ply] [-o out.png|out.ppm|out.svg]
+// [-s WIDTHxHEIGHT] [-j threads] [--wire]. Uses the same view and projection as the
+// interactive app and needs no window or GL context. SVG output is the analytic
+// hidden-line drawing of the mesh and the axes instead of a raster image.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "hidden_lines.hpp"
+#include "math3d.hpp"
+#include "mesh_cache.hpp"
+#include "object.hpp"
+#include "raster.hpp"
+#include "task_scheduler.hpp"
+
+using namespace math3d;
+
+namespace {
+
+bool endsWith(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string mesh, output { "render.png" };
+    RasterOptions opt;
+    unsigned threads { std::thread::hardware_concurrency() };
+    bool wire { false };
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg { argv[i] };
+        const bool hasValue { i + 1 < argc };
+        if (arg == "-o" && hasValue) output = argv[++i];
+        else if (arg == "-s" && hasValue) {
+            if (std::sscanf(argv[++i], "%dx%d", &opt.width, &opt.height) != 2) {
+                std::cerr << "invalid size " << argv[i] << "\n";
+                return 2;
+            }
+        }
+        else if (arg == "-j" && hasValue) threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (arg == "--wire") wire = true;
+        else if (!arg.empty() && arg[0] != '-') mesh = arg;
+        else {
+            std::cerr << "usage: " << argv[0] << " [mesh.obj|mesh.ply] [-o out.png|out.ppm|out.svg] [-s WIDTHxHEIGHT] [-j threads] [--wire]\n";
+            return 2;
+        }
+    }
+
+    try {
+        Object o { builtinCube() };
+        if (!mesh.empty()) {
+            loadMeshCached(mesh, o);
+            fitToBuiltinCube(o);
+        }
+        Mat4 view { translate(0.0f, 0.0f, -3.0f) };
+        view = matMul(view, rotX(deg2rad(30.0f)));
+        view = matMul(view, rotY(deg2rad(-40.0f)));
+        view = matMul(view, scaleMat(1.0f, 1.0f, -1.0f));
+        o.setView(view);
+        o.setProjection(ortho(-1.0f, 1.0f, -1.0f, 1.0f, 0.1f, 100.0f));
+        o.useRoberts = !wire;
+
+        TaskScheduler pool(threads);
+        o.scheduler = &pool;
+        o.update();
+
+        if (endsWith(output, ".svg")) {
+            Object a { builtinAxes() };
+            a.setView(view);
+            a.setProjection(o.projection);
+            a.update();
+            const Object* hlrObjects[] = { &o, &a };
+            HiddenLineRemover hlr;
+            const auto start = std::chrono::steady_clock::now();
+            hlr.compute(hlrObjects, &pool);
+            const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            writeSvg(output, hlr.segments(), opt.width, opt.height);
+            std::cout << output << ": " << hlr.stats().edges << " edges, " << hlr.stats().segments << " visible segments in "
+                      << ms << " ms on " << pool.threadCount() << " threads\n";
+            return 0;
+        }
+
+        SoftwareRasterizer r(opt);
+        const auto start = std::chrono::steady_clock::now();
+        r.draw(o, &pool);
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (endsWith(output, ".ppm")) writePpm(output, r);
+        else writePng(output, r);
+        std::cout << output << ": " << r.stats().triangles << " triangles, " << r.stats().lines << " lines in "
+                  << ms << " ms on " << pool.threadCount() << " threads\n";
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}